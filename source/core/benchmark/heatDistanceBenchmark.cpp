@@ -0,0 +1,264 @@
+// ---------------------------------------------------------------------
+//
+//  heatDistanceBenchmark.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+//
+// Headless benchmark for the heat method distance solver and the
+// implicit flood solvers. It doesn't depend on Maya and gets built
+// with the core library:
+//
+//      cmake -S source/core -B build
+//      cmake --build build
+//
+// Run it with ./build/heatDistanceBenchmark [subdivisions]
+//
+// The test mesh is a subdivided icosahedron projected onto the unit
+// sphere. The computed distances are compared against the great circle
+// distance to the source vertex.
+//
+// The flood solvers diffuse a function which is one on the fixed lower
+// half of the sphere and zero on the free upper half, like an influence
+// which only has weights outside of the flood selection. The right hand
+// side of the free vertices is zero and the solve needs to converge
+// through the boundary terms alone. Measured against the free right
+// hand side only, the residual never meets the tolerance and the solve
+// runs until the residual vanishes. Both solvers need a few iterations
+// for the smooth function, and the benchmark fails if either doesn't
+// converge within 100 iterations.
+//
+// ---------------------------------------------------------------------
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "diffusionSolver.h"
+#include "heatDistance.h"
+#include "meshLaplacian.h"
+#include "multigridSolver.h"
+
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock benchmarkClock;
+
+    double elapsed(benchmarkClock::time_point start)
+    {
+        return std::chrono::duration<double>(benchmarkClock::now() - start).count();
+    }
+
+    unsigned int addPoint(std::vector<double> &points, double x, double y, double z)
+    {
+        double length = sqrt(x * x + y * y + z * z);
+        points.push_back(x / length);
+        points.push_back(y / length);
+        points.push_back(z / length);
+        return (unsigned)points.size() / 3 - 1;
+    }
+
+    unsigned int midPoint(std::vector<double> &points,
+                          std::map<unsigned long long, unsigned int> &cache,
+                          unsigned int a,
+                          unsigned int b)
+    {
+        unsigned long long key = a < b ? ((unsigned long long)a << 32) | b
+                                       : ((unsigned long long)b << 32) | a;
+        std::map<unsigned long long, unsigned int>::iterator it = cache.find(key);
+        if (it != cache.end())
+            return it->second;
+
+        unsigned int index = addPoint(points,
+                                      (points[a * 3] + points[b * 3]) * 0.5,
+                                      (points[a * 3 + 1] + points[b * 3 + 1]) * 0.5,
+                                      (points[a * 3 + 2] + points[b * 3 + 2]) * 0.5);
+        cache[key] = index;
+        return index;
+    }
+
+    void createSphere(unsigned int subdivisions,
+                      std::vector<double> &points,
+                      std::vector<int> &triangles)
+    {
+        unsigned int i, j;
+
+        const double t = (1.0 + sqrt(5.0)) / 2.0;
+        const double base[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                                    {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                                    {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+        const int faces[20][3] = {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+                                  {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+                                  {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+                                  {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+
+        points.clear();
+        for (i = 0; i < 12; i ++)
+            addPoint(points, base[i][0], base[i][1], base[i][2]);
+
+        triangles.assign(&faces[0][0], &faces[0][0] + 60);
+
+        for (i = 0; i < subdivisions; i ++)
+        {
+            std::map<unsigned long long, unsigned int> cache;
+            std::vector<int> next;
+            next.reserve(triangles.size() * 4);
+            for (j = 0; j < triangles.size(); j += 3)
+            {
+                unsigned int a = (unsigned)triangles[j];
+                unsigned int b = (unsigned)triangles[j + 1];
+                unsigned int c = (unsigned)triangles[j + 2];
+                int ab = (int)midPoint(points, cache, a, b);
+                int bc = (int)midPoint(points, cache, b, c);
+                int ca = (int)midPoint(points, cache, c, a);
+                int items[12] = {(int)a, ab, ca, (int)b, bc, ab, (int)c, ca, bc, ab, bc, ca};
+                next.insert(next.end(), items, items + 12);
+            }
+            triangles.swap(next);
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned int i;
+
+    unsigned int subdivisions = 6;
+    if (argc > 1)
+        subdivisions = (unsigned)atoi(argv[1]);
+
+    std::vector<double> points;
+    std::vector<int> triangles;
+    createSphere(subdivisions, points, triangles);
+    unsigned int numVertices = (unsigned)points.size() / 3;
+
+    printf("vertices:        %u\n", numVertices);
+    printf("triangles:       %u\n", (unsigned)triangles.size() / 3);
+
+    benchmarkClock::time_point start = benchmarkClock::now();
+    heatDistance solver;
+    if (!solver.create(numVertices, triangles, points))
+    {
+        printf("factorization failed\n");
+        return 1;
+    }
+    printf("factorize:       %.3f s\n", elapsed(start));
+
+    const unsigned int numRuns = 10;
+    std::vector<double> distances;
+    double maxError = 0.0;
+    double sumError = 0.0;
+
+    start = benchmarkClock::now();
+    for (i = 0; i < numRuns; i ++)
+    {
+        std::vector<unsigned int> sources(1, (i * 7919) % numVertices);
+        solver.getDistances(sources, distances);
+    }
+    printf("distance solve:  %.3f ms\n", elapsed(start) * 1000.0 / numRuns);
+
+    // Compare the last solve with the great circle distance.
+    unsigned int source = ((numRuns - 1) * 7919) % numVertices;
+    const double *s = &points[source * 3];
+    for (i = 0; i < numVertices; i ++)
+    {
+        const double *p = &points[i * 3];
+        double cosine = p[0] * s[0] + p[1] * s[1] + p[2] * s[2];
+        cosine = cosine > 1.0 ? 1.0 : (cosine < -1.0 ? -1.0 : cosine);
+        double error = fabs(distances[i] - acos(cosine));
+        sumError += error;
+        if (error > maxError)
+            maxError = error;
+    }
+    printf("mean error:      %.5f\n", sumError / numVertices);
+    printf("max error:       %.5f\n", maxError);
+
+    // -----------------------------------------------------------------
+    // flood solvers
+    // -----------------------------------------------------------------
+
+    meshLaplacian operators;
+    operators.create(numVertices, triangles, points);
+
+    // The same diffusion time as a flood with a strength of 0.5.
+    double edgeLength = operators.meanEdgeLength();
+    double time = 0.5 * edgeLength * edgeLength;
+
+    std::vector<bool> fixed(numVertices);
+    std::vector<double> initial(numVertices);
+    for (i = 0; i < numVertices; i ++)
+    {
+        fixed[i] = points[i * 3 + 1] < 0.0;
+        initial[i] = fixed[i] ? 1.0 : 0.0;
+    }
+
+    const unsigned int maxIterations = 100;
+    unsigned int iterations;
+    std::vector<double> values = initial;
+
+    start = benchmarkClock::now();
+    diffusionSolver diffusion;
+    diffusion.create(operators, time, fixed);
+    bool converged = diffusion.solve(values, 1e-5, maxIterations, iterations);
+    printf("implicit flood:  %.3f ms, %u iterations\n", elapsed(start) * 1000.0, iterations);
+    if (!converged)
+    {
+        printf("implicit flood failed\n");
+        return 1;
+    }
+
+    values = initial;
+
+    start = benchmarkClock::now();
+    multigridSolver multigrid;
+    multigrid.create(operators);
+    if (!multigrid.setup(operators, time, fixed))
+    {
+        printf("multigrid setup failed\n");
+        return 1;
+    }
+    converged = multigrid.solve(values, 1e-5, maxIterations, iterations);
+    printf("multigrid flood: %.3f ms, %u iterations\n", elapsed(start) * 1000.0, iterations);
+    if (!converged)
+    {
+        printf("multigrid flood failed\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
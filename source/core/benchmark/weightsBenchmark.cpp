@@ -0,0 +1,764 @@
+// ---------------------------------------------------------------------
+//
+//  weightsBenchmark.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+//
+// Headless benchmark for the smoothing, range and transfer kernels
+// which are shared with the tools. It doesn't depend on Maya and gets
+// built with the core library:
+//
+//      cmake -S source/core -B build
+//      cmake --build build
+//
+// Run it with ./build/weightsBenchmark [options]
+//
+//      -meshes grid,cylinder,sphere,shells
+//      -sizes 10000,100000,1000000,4000000
+//      -influences 4,32,500
+//      -dabs 50            The number of brush dabs per case.
+//      -radius 0.05        The brush radius relative to the mesh size.
+//      -memory 2048        The max memory in MB for the weights of a
+//                          case. Larger cases get skipped.
+//      -csv                Write comma separated values instead of one
+//                          JSON object per line.
+//
+// For each mesh type, vertex count and influence count a procedural
+// skinned mesh is generated. The influences form a joint chain along
+// the main axis of the mesh and each vertex is weighted to the four
+// nearest joints. The shells are a grid which is split into separate
+// tiles with coincident vertices along the seams, which are matched
+// while gathering the brush range like with keeping shells together.
+//
+// The timed stages are:
+//
+//      range               Gathering the vertices in the brush range
+//                          by walking the mesh within the straight
+//                          distance, the default of the brush.
+//      geodesicRange       Gathering the vertices in the brush range
+//                          by the distance along the edges.
+//      smooth              Smoothing the weights in the brush range
+//                          with the per-vertex kernel of the brush,
+//                          which writes the result back to the
+//                          weights.
+//      transfer            Transferring weights between influences in
+//                          the brush range with the kernel of the
+//                          brush.
+//      transferSparse      The same transfer which only reads and
+//                          writes the source and destination columns.
+//      undo                Copying the weights of all vertices when a
+//                          stroke starts and building the rows of the
+//                          stroke vertices from the copy, like the tool
+//                          command does for undo.
+//      flood               A single smoothing pass over all vertices.
+//
+// Each stage reports the time, the number of processed vertices, the
+// throughput in vertices per second and the peak resident memory of
+// the process.
+//
+// ---------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include "meshTopology.h"
+#include "weightSmoother.h"
+#include "weightTransfer.h"
+
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock benchmarkClock;
+
+    double elapsed(benchmarkClock::time_point start)
+    {
+        return std::chrono::duration<double>(benchmarkClock::now() - start).count();
+    }
+
+    // The peak resident set size of the process in kilobytes.
+    long peakMemory()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    // -----------------------------------------------------------------
+    // test meshes
+    // -----------------------------------------------------------------
+
+    struct testMesh
+    {
+        unsigned int numVertices;
+        std::vector<int> polyCounts;
+        std::vector<int> polyVertices;
+        std::vector<double> points;
+        std::vector<double> chain;          // The position of each
+                                            // vertex along the joint
+                                            // chain between 0 and 1.
+        std::vector<int> seams;             // The coincident vertex on
+                                            // another shell or -1.
+        double size;
+    };
+
+    void addQuad(testMesh &mesh, int a, int b, int c, int d)
+    {
+        mesh.polyCounts.push_back(4);
+        mesh.polyVertices.push_back(a);
+        mesh.polyVertices.push_back(b);
+        mesh.polyVertices.push_back(c);
+        mesh.polyVertices.push_back(d);
+    }
+
+    void addPoint(testMesh &mesh, double x, double y, double z, double chain)
+    {
+        mesh.points.push_back(x);
+        mesh.points.push_back(y);
+        mesh.points.push_back(z);
+        mesh.chain.push_back(chain);
+    }
+
+    void finishMesh(testMesh &mesh, double size)
+    {
+        mesh.numVertices = (unsigned)mesh.chain.size();
+        mesh.size = size;
+        if (mesh.seams.empty())
+            mesh.seams.assign(mesh.numVertices, -1);
+    }
+
+    // A flat grid in the xz plane with the chain along x.
+    void createGrid(unsigned int size, testMesh &mesh)
+    {
+        unsigned int i, j;
+
+        unsigned int n = std::max(2u, (unsigned)ceil(sqrt((double)size)));
+        for (j = 0; j < n; j ++)
+        {
+            for (i = 0; i < n; i ++)
+            {
+                double x = (double)i / (n - 1);
+                addPoint(mesh, x, 0.0, (double)j / (n - 1), x);
+            }
+        }
+
+        for (j = 0; j < n - 1; j ++)
+        {
+            for (i = 0; i < n - 1; i ++)
+            {
+                int a = (int)(j * n + i);
+                addQuad(mesh, a, a + 1, a + (int)n + 1, a + (int)n);
+            }
+        }
+
+        finishMesh(mesh, 1.0);
+    }
+
+    // An open cylinder along y with the chain from the bottom to the
+    // top, like a limb.
+    void createCylinder(unsigned int size, testMesh &mesh)
+    {
+        unsigned int i, j;
+
+        unsigned int segments = std::max(8u, (unsigned)sqrt(size / 4.0));
+        unsigned int rings = std::max(2u, size / segments);
+        const double radius = 0.1;
+
+        for (j = 0; j < rings; j ++)
+        {
+            double y = (double)j / (rings - 1);
+            for (i = 0; i < segments; i ++)
+            {
+                double angle = 2.0 * M_PI * i / segments;
+                addPoint(mesh, cos(angle) * radius, y, sin(angle) * radius, y);
+            }
+        }
+
+        for (j = 0; j < rings - 1; j ++)
+        {
+            for (i = 0; i < segments; i ++)
+            {
+                int a = (int)(j * segments + i);
+                int b = (int)(j * segments + (i + 1) % segments);
+                addQuad(mesh, a, b, b + (int)segments, a + (int)segments);
+            }
+        }
+
+        finishMesh(mesh, 1.0);
+    }
+
+    // A closed sphere of quads with triangle fans at the poles and the
+    // chain from pole to pole.
+    void createSphere(unsigned int size, testMesh &mesh)
+    {
+        unsigned int i, j;
+
+        unsigned int segments = std::max(8u, (unsigned)sqrt(size * 2.0));
+        unsigned int rings = std::max(3u, size / segments);
+
+        addPoint(mesh, 0.0, -0.5, 0.0, 0.0);
+        for (j = 0; j < rings; j ++)
+        {
+            double phi = M_PI * (j + 1) / (rings + 1);
+            double y = -cos(phi) * 0.5;
+            double r = sin(phi) * 0.5;
+            for (i = 0; i < segments; i ++)
+            {
+                double angle = 2.0 * M_PI * i / segments;
+                addPoint(mesh, cos(angle) * r, y, sin(angle) * r, y + 0.5);
+            }
+        }
+        addPoint(mesh, 0.0, 0.5, 0.0, 1.0);
+
+        int top = (int)(rings * segments + 1);
+        for (i = 0; i < segments; i ++)
+        {
+            int a = (int)(1 + i);
+            int b = (int)(1 + (i + 1) % segments);
+            mesh.polyCounts.push_back(3);
+            mesh.polyVertices.push_back(0);
+            mesh.polyVertices.push_back(b);
+            mesh.polyVertices.push_back(a);
+
+            a = (int)(1 + (rings - 1) * segments + i);
+            b = (int)(1 + (rings - 1) * segments + (i + 1) % segments);
+            mesh.polyCounts.push_back(3);
+            mesh.polyVertices.push_back(top);
+            mesh.polyVertices.push_back(a);
+            mesh.polyVertices.push_back(b);
+        }
+
+        for (j = 0; j < rings - 1; j ++)
+        {
+            for (i = 0; i < segments; i ++)
+            {
+                int a = (int)(1 + j * segments + i);
+                int b = (int)(1 + j * segments + (i + 1) % segments);
+                addQuad(mesh, a, b, b + (int)segments, a + (int)segments);
+            }
+        }
+
+        finishMesh(mesh, 1.0);
+    }
+
+    // A grid which is split into 4 x 4 separate tiles. The vertices
+    // along the tile borders exist once for each tile and get matched
+    // as seams.
+    void createShells(unsigned int size, testMesh &mesh)
+    {
+        unsigned int i, j, k, l;
+
+        const unsigned int tiles = 4;
+        unsigned int n = std::max(2u, (unsigned)ceil(sqrt((double)size / (tiles * tiles))));
+        unsigned int cells = (n - 1) * tiles;
+
+        // The vertex of the first tile at each grid position, to find
+        // the coincident vertices of the following tiles.
+        std::vector<int> first((cells + 1) * (cells + 1), -1);
+
+        for (l = 0; l < tiles; l ++)
+        {
+            for (k = 0; k < tiles; k ++)
+            {
+                int start = (int)mesh.chain.size();
+                for (j = 0; j < n; j ++)
+                {
+                    for (i = 0; i < n; i ++)
+                    {
+                        unsigned int gx = k * (n - 1) + i;
+                        unsigned int gz = l * (n - 1) + j;
+                        double x = (double)gx / cells;
+                        addPoint(mesh, x, 0.0, (double)gz / cells, x);
+
+                        int index = (int)mesh.chain.size() - 1;
+                        int &other = first[gz * (cells + 1) + gx];
+                        if (other == -1)
+                        {
+                            other = index;
+                            mesh.seams.push_back(-1);
+                        }
+                        else
+                        {
+                            mesh.seams.push_back(other);
+                            if (mesh.seams[(unsigned)other] == -1)
+                                mesh.seams[(unsigned)other] = index;
+                        }
+                    }
+                }
+
+                for (j = 0; j < n - 1; j ++)
+                {
+                    for (i = 0; i < n - 1; i ++)
+                    {
+                        int a = start + (int)(j * n + i);
+                        addQuad(mesh, a, a + 1, a + (int)n + 1, a + (int)n);
+                    }
+                }
+            }
+        }
+
+        finishMesh(mesh, 1.0);
+    }
+
+    // Weight each vertex to the four nearest joints of the chain.
+    void createWeights(const testMesh &mesh,
+                       unsigned int influenceCount,
+                       std::vector<double> &weights)
+    {
+        weights.assign((size_t)mesh.numVertices * influenceCount, 0.0);
+
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, mesh.numVertices),
+                          [&](tbb::blocked_range<unsigned int> r)
+        {
+            for (unsigned int i = r.begin(); i < r.end(); i ++)
+            {
+                double *row = &weights[(size_t)i * influenceCount];
+                double position = mesh.chain[i] * (influenceCount - 1);
+                int joint = (int)floor(position);
+
+                double sum = 0.0;
+                for (int j = joint - 1; j <= joint + 2; j ++)
+                {
+                    if (j < 0 || j >= (int)influenceCount)
+                        continue;
+                    double value = 1.0 - fabs(position - j) / 2.0;
+                    if (value > 0.0)
+                    {
+                        row[j] = value;
+                        sum += value;
+                    }
+                }
+                for (unsigned int j = 0; j < influenceCount; j ++)
+                    row[j] /= sum;
+            }
+        });
+    }
+
+    // -----------------------------------------------------------------
+    // output
+    // -----------------------------------------------------------------
+
+    struct stageResult
+    {
+        const char *stage;
+        unsigned int calls;
+        double seconds;
+        double vertices;
+    };
+
+    bool csvOutput = false;
+
+    void printHeader()
+    {
+        if (csvOutput)
+            printf("mesh,vertices,influences,stage,calls,seconds,processed,verticesPerSecond,peakRssKb\n");
+    }
+
+    void printResult(const char *meshName,
+                     const testMesh &mesh,
+                     unsigned int influenceCount,
+                     const stageResult &result)
+    {
+        double rate = result.seconds > 0.0 ? result.vertices / result.seconds : 0.0;
+        if (csvOutput)
+        {
+            printf("%s,%u,%u,%s,%u,%.6f,%.0f,%.0f,%ld\n",
+                   meshName, mesh.numVertices, influenceCount, result.stage,
+                   result.calls, result.seconds, result.vertices, rate, peakMemory());
+        }
+        else
+        {
+            printf("{\"mesh\": \"%s\", \"vertices\": %u, \"influences\": %u, "
+                   "\"stage\": \"%s\", \"calls\": %u, \"seconds\": %.6f, "
+                   "\"processed\": %.0f, \"verticesPerSecond\": %.0f, \"peakRssKb\": %ld}\n",
+                   meshName, mesh.numVertices, influenceCount, result.stage,
+                   result.calls, result.seconds, result.vertices, rate, peakMemory());
+        }
+        fflush(stdout);
+    }
+
+    void printSkipped(const char *meshName, unsigned int size, unsigned int influenceCount)
+    {
+        if (csvOutput)
+            printf("%s,%u,%u,skipped,0,0,0,0,%ld\n", meshName, size, influenceCount, peakMemory());
+        else
+        {
+            printf("{\"mesh\": \"%s\", \"vertices\": %u, \"influences\": %u, "
+                   "\"stage\": \"skipped\", \"peakRssKb\": %ld}\n",
+                   meshName, size, influenceCount, peakMemory());
+        }
+        fflush(stdout);
+    }
+
+    std::vector<std::string> splitList(const char *value)
+    {
+        std::vector<std::string> items;
+        std::string item;
+        for (const char *c = value; ; c ++)
+        {
+            if (*c == ',' || *c == '\0')
+            {
+                if (!item.empty())
+                    items.push_back(item);
+                item.clear();
+                if (*c == '\0')
+                    break;
+            }
+            else
+                item += *c;
+        }
+        return items;
+    }
+
+    // -----------------------------------------------------------------
+    // the benchmark
+    // -----------------------------------------------------------------
+
+    // Smooth the vertices of a dab like the brush. Each vertex reads the
+    // current weights and writes its result back, and the results are
+    // collected for setting the weights of the components.
+    template <bool MaxInfluences>
+    void smoothDab(weightSmoother &smoother,
+                   const meshTopology &topology,
+                   const std::vector<int> &seams,
+                   const std::vector<unsigned int> &indices,
+                   const std::vector<double> &distances,
+                   double radius,
+                   unsigned int influenceCount,
+                   std::vector<double> &weights,
+                   std::vector<double> &smoothed)
+    {
+        unsigned int count = (unsigned)indices.size();
+        smoothed.assign((size_t)count * influenceCount, 0.0);
+
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, count),
+                          [&](tbb::blocked_range<unsigned int> r)
+        {
+            smoothBuffer buffer;
+
+            for (unsigned int k = r.begin(); k < r.end(); k ++)
+            {
+                unsigned int index = indices[k];
+                int opposite = seams[index];
+
+                double scale = falloffValue(2, 1.0 - distances[k] / radius, 0.5);
+
+                smoother.getNeighbors(topology, index, opposite, buffer);
+                smoother.computeVertex<false, false, MaxInfluences, true>(weights, index, opposite, scale, buffer);
+
+                for (unsigned int u = 0; u < buffer.influences.size(); u ++)
+                {
+                    unsigned int influence = buffer.influences[u];
+                    smoothed[(size_t)k * influenceCount + influence] = buffer.values[u];
+                    weights[(size_t)index * influenceCount + influence] = buffer.values[u];
+                }
+
+                smoother.setInfluenceList(index, buffer);
+            }
+        });
+
+        for (unsigned int k = 0; k < count; k ++)
+            smoother.updateInfluenceList(indices[k]);
+    }
+
+    // Transfer the weights of the vertices of a dab like the brush.
+    template <bool Sparse>
+    void transferDab(weightTransfer &transfer,
+                     const std::vector<unsigned int> &indices,
+                     const std::vector<double> &distances,
+                     double radius,
+                     const std::vector<double> &weights,
+                     std::vector<double> &transferred)
+    {
+        unsigned int count = (unsigned)indices.size();
+
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, count),
+                          [&](tbb::blocked_range<unsigned int> r)
+        {
+            std::vector<double> values;
+
+            for (unsigned int k = r.begin(); k < r.end(); k ++)
+            {
+                unsigned int index = indices[k];
+
+                double scale = falloffValue(2, 1.0 - distances[k] / radius, 0.25);
+                scale = transfer.accumulate(index, scale);
+
+                transfer.transferVertex<true, Sparse>(weights, index, scale, false, values);
+
+                std::copy(values.begin(), values.end(),
+                          transferred.begin() + (size_t)k * values.size());
+            }
+        });
+    }
+
+    void runCase(const char *meshName,
+                 const testMesh &mesh,
+                 unsigned int influenceCount,
+                 unsigned int dabs,
+                 double radius)
+    {
+        unsigned int i;
+
+        meshTopology topology;
+        topology.create(mesh.numVertices, mesh.polyCounts, mesh.polyVertices);
+        topology.setPoints(mesh.points);
+
+        std::vector<double> weights;
+        createWeights(mesh, influenceCount, weights);
+
+        weightSmoother smoother;
+        smoother.create(influenceCount, std::vector<bool>(), 4, true);
+        smoother.createInfluenceLists(weights, mesh.numVertices);
+
+        std::vector<unsigned int> sources(1, 0);
+        std::vector<unsigned int> destinations(1, influenceCount > 1 ? 1 : 0);
+        if (sources[0] == destinations[0])
+            sources.clear();
+
+        weightTransfer transfer;
+        transfer.create(influenceCount, sources, destinations,
+                        std::vector<unsigned int>(), std::vector<unsigned int>());
+        transfer.reset(mesh.numVertices);
+
+        const std::vector<int> &seams = mesh.seams;
+        auto oppositeIndex = [&](unsigned int index) { return seams[index]; };
+
+        stageResult range = {"range", 0, 0.0, 0.0};
+        stageResult geodesicRange = {"geodesicRange", 0, 0.0, 0.0};
+        stageResult smooth = {"smooth", 0, 0.0, 0.0};
+        stageResult transferFull = {"transfer", 0, 0.0, 0.0};
+        stageResult transferSparse = {"transferSparse", 0, 0.0, 0.0};
+        stageResult undo = {"undo", 0, 0.0, 0.0};
+
+        double brushRadius = radius * mesh.size;
+
+        std::vector<unsigned int> indices;
+        std::vector<double> distances;
+        std::vector<unsigned int> geodesicIndices;
+        std::vector<double> geodesicDistances;
+        std::vector<double> smoothed;
+        std::vector<double> transferred;
+        std::vector<double> prevWeights;
+        std::vector<double> undoRows;
+
+        for (i = 0; i < dabs; i ++)
+        {
+            unsigned int center = (unsigned)(((unsigned long long)i * 2654435761u) % mesh.numVertices);
+
+            // The brush center is the position of the center vertex.
+            // The center vertex itself is added like the brush adds
+            // the closest vertex.
+            benchmarkClock::time_point start = benchmarkClock::now();
+            topology.getEuclideanRange(center, topology.point(center), brushRadius,
+                                       oppositeIndex, indices, distances);
+            indices.push_back(center);
+            distances.push_back(0.0);
+            range.seconds += elapsed(start);
+            range.vertices += indices.size();
+            range.calls ++;
+
+            start = benchmarkClock::now();
+            topology.getGeodesicRange(center, 0.0, brushRadius, oppositeIndex,
+                                      geodesicIndices, geodesicDistances);
+            geodesicRange.seconds += elapsed(start);
+            geodesicRange.vertices += geodesicIndices.size() + 1;
+            geodesicRange.calls ++;
+
+            start = benchmarkClock::now();
+            if (influenceCount > 4)
+                smoothDab<true>(smoother, topology, seams, indices, distances, brushRadius,
+                                influenceCount, weights, smoothed);
+            else
+                smoothDab<false>(smoother, topology, seams, indices, distances, brushRadius,
+                                 influenceCount, weights, smoothed);
+            smooth.seconds += elapsed(start);
+            smooth.vertices += indices.size();
+            smooth.calls ++;
+
+            // The transfer writes the weights of the range into a
+            // separate array like the brush does for setting the
+            // weights of the components. Each dab is a new stroke.
+            unsigned int count = (unsigned)indices.size();
+
+            start = benchmarkClock::now();
+            transfer.reset(mesh.numVertices);
+            transferred.resize((size_t)count * influenceCount);
+            transferDab<false>(transfer, indices, distances, brushRadius, weights, transferred);
+            transferFull.seconds += elapsed(start);
+            transferFull.vertices += count;
+            transferFull.calls ++;
+
+            // The sparse transfer only holds the changed columns, which
+            // keep their sum and don't need to get normalized.
+            start = benchmarkClock::now();
+            transfer.reset(mesh.numVertices);
+            transferred.resize((size_t)count * transfer.columns().size());
+            transferDab<true>(transfer, indices, distances, brushRadius, weights, transferred);
+            transferSparse.seconds += elapsed(start);
+            transferSparse.vertices += count;
+            transferSparse.calls ++;
+
+            // The tools copy the weights of all vertices when a stroke
+            // starts and the tool command gets the rows of the stroke
+            // vertices from the copy.
+            start = benchmarkClock::now();
+            prevWeights = weights;
+            undoRows.resize((size_t)count * influenceCount);
+            for (unsigned int k = 0; k < count; k ++)
+            {
+                std::copy(prevWeights.begin() + (size_t)indices[k] * influenceCount,
+                          prevWeights.begin() + (size_t)(indices[k] + 1) * influenceCount,
+                          undoRows.begin() + (size_t)k * influenceCount);
+            }
+            undo.seconds += elapsed(start);
+            undo.vertices += count;
+            undo.calls ++;
+        }
+
+        printResult(meshName, mesh, influenceCount, range);
+        printResult(meshName, mesh, influenceCount, geodesicRange);
+        printResult(meshName, mesh, influenceCount, smooth);
+        printResult(meshName, mesh, influenceCount, transferFull);
+        printResult(meshName, mesh, influenceCount, transferSparse);
+        printResult(meshName, mesh, influenceCount, undo);
+
+        // -------------------------------------------------------------
+        // flood
+        // -------------------------------------------------------------
+
+        indices.resize(mesh.numVertices);
+        for (i = 0; i < mesh.numVertices; i ++)
+            indices[i] = i;
+
+        stageResult flood = {"flood", 1, 0.0, (double)mesh.numVertices};
+        benchmarkClock::time_point start = benchmarkClock::now();
+        smoother.smooth(topology, indices, 0.5, 1, weights);
+        flood.seconds = elapsed(start);
+        printResult(meshName, mesh, influenceCount, flood);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned int i, j, k;
+
+    std::vector<std::string> meshes = splitList("grid,cylinder,sphere,shells");
+    std::vector<std::string> sizes = splitList("10000,100000,1000000,4000000");
+    std::vector<std::string> influences = splitList("4,32,500");
+    unsigned int dabs = 50;
+    double radius = 0.05;
+    double memory = 2048.0;
+
+    for (i = 1; i < (unsigned)argc; i ++)
+    {
+        bool hasValue = i + 1 < (unsigned)argc;
+        if (!strcmp(argv[i], "-meshes") && hasValue)
+            meshes = splitList(argv[++ i]);
+        else if (!strcmp(argv[i], "-sizes") && hasValue)
+            sizes = splitList(argv[++ i]);
+        else if (!strcmp(argv[i], "-influences") && hasValue)
+            influences = splitList(argv[++ i]);
+        else if (!strcmp(argv[i], "-dabs") && hasValue)
+            dabs = (unsigned)atoi(argv[++ i]);
+        else if (!strcmp(argv[i], "-radius") && hasValue)
+            radius = atof(argv[++ i]);
+        else if (!strcmp(argv[i], "-memory") && hasValue)
+            memory = atof(argv[++ i]);
+        else if (!strcmp(argv[i], "-csv"))
+            csvOutput = true;
+        else
+        {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printHeader();
+
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        const char *meshName = meshes[i].c_str();
+
+        for (j = 0; j < sizes.size(); j ++)
+        {
+            unsigned int size = (unsigned)atol(sizes[j].c_str());
+
+            testMesh mesh;
+            if (meshes[i] == "grid")
+                createGrid(size, mesh);
+            else if (meshes[i] == "cylinder")
+                createCylinder(size, mesh);
+            else if (meshes[i] == "sphere")
+                createSphere(size, mesh);
+            else if (meshes[i] == "shells")
+                createShells(size, mesh);
+            else
+            {
+                fprintf(stderr, "unknown mesh: %s\n", meshName);
+                return 1;
+            }
+
+            for (k = 0; k < influences.size(); k ++)
+            {
+                unsigned int influenceCount = std::max(1, atoi(influences[k].c_str()));
+
+                // The weights, the undo copy and the flood result each
+                // hold all weights of the mesh.
+                double megabytes = 3.0 * mesh.numVertices * influenceCount * sizeof(double) / 1048576.0;
+                if (megabytes > memory)
+                {
+                    printSkipped(meshName, mesh.numVertices, influenceCount);
+                    continue;
+                }
+
+                runCase(meshName, mesh, influenceCount, dabs, radius);
+            }
+        }
+    }
+
+    return 0;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
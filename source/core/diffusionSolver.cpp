@@ -0,0 +1,244 @@
+// ---------------------------------------------------------------------
+//
+//  diffusionSolver.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "diffusionSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The residual norm at which the solve counts as converged regardless
+// of the tolerance, so that a zero right hand side doesn't fail.
+static const double absoluteTolerance = 1e-15;
+
+
+diffusionSolver::diffusionSolver()
+{
+    numVertices = 0;
+}
+
+
+//
+// Description:
+//      Build the system matrix for the given diffusion time.
+//
+// Input Arguments:
+//      operators           The mesh operators.
+//      time                The diffusion time.
+//      fixed               The flag per vertex if it keeps its value.
+//
+// Return Value:
+//      None
+//
+void diffusionSolver::create(const meshLaplacian &operators,
+                             double time,
+                             const std::vector<bool> &fixed)
+{
+    unsigned int i;
+
+    clear();
+
+    if (operators.isEmpty())
+        return;
+
+    numVertices = operators.laplacian().size();
+
+    system = operators.laplacian();
+    system.scale(time);
+    system.addDiagonal(operators.mass());
+
+    mass = operators.mass();
+
+    this->fixed = fixed;
+    this->fixed.resize(numVertices, true);
+
+    // Vertices without any triangle have neither mass nor neighbours
+    // and can't change.
+    inverseDiagonal = std::vector<double>(numVertices, 0.0);
+    for (i = 0; i < numVertices; i ++)
+    {
+        double value = system.diagonal(i);
+        if (value > 0.0)
+            inverseDiagonal[i] = 1.0 / value;
+        else
+            this->fixed[i] = true;
+    }
+}
+
+
+void diffusionSolver::clear()
+{
+    numVertices = 0;
+    system.clear();
+    mass.clear();
+    fixed.clear();
+    inverseDiagonal.clear();
+}
+
+
+bool diffusionSolver::isEmpty() const
+{
+    return numVertices == 0;
+}
+
+
+//
+// Description:
+//      Diffuse the given values. The values of the fixed vertices act
+//      as boundary conditions and remain unchanged.
+//
+// Input Arguments:
+//      values              The initial values w0 which get replaced by
+//                          the result.
+//      tolerance           The residual norm relative to the norm of
+//                          the right hand side including the boundary
+//                          terms, or of the initial residual if that is
+//                          larger, at which the iteration stops.
+//      maxIterations       The maximum number of iterations.
+//      iterations          The number of performed iterations.
+//
+// Return Value:
+//      bool                True, if the residual reached the tolerance.
+//
+bool diffusionSolver::solve(std::vector<double> &values,
+                            double tolerance,
+                            unsigned int maxIterations,
+                            unsigned int &iterations) const
+{
+    unsigned int i;
+
+    iterations = 0;
+
+    if (numVertices == 0 || values.size() != numVertices)
+        return false;
+
+    std::vector<double> residual(numVertices, 0.0);
+    std::vector<double> direction(numVertices, 0.0);
+    std::vector<double> preconditioned(numVertices, 0.0);
+    std::vector<double> product;
+    std::vector<double> boundary;
+
+    // The initial values are the starting guess. Because the fixed
+    // values are part of the vector the product already contains the
+    // boundary terms of the right hand side.
+    system.multiply(values, product);
+
+    // The product of the fixed values alone gives the boundary terms
+    // which the stopping tolerance needs to include. Otherwise an
+    // influence which only has weights on the fixed vertices never
+    // converges.
+    for (i = 0; i < numVertices; i ++)
+        direction[i] = fixed[i] ? values[i] : 0.0;
+    system.multiply(direction, boundary);
+
+    double rhsNorm = 0.0;
+    double initialNorm = 0.0;
+    double rz = 0.0;
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (fixed[i])
+        {
+            direction[i] = 0.0;
+            continue;
+        }
+
+        double rhs = mass[i] * values[i];
+        rhsNorm += (rhs - boundary[i]) * (rhs - boundary[i]);
+
+        residual[i] = rhs - product[i];
+        initialNorm += residual[i] * residual[i];
+        preconditioned[i] = residual[i] * inverseDiagonal[i];
+        direction[i] = preconditioned[i];
+        rz += residual[i] * preconditioned[i];
+    }
+
+    double limit = std::max(tolerance * tolerance * std::max(rhsNorm, initialNorm),
+                            absoluteTolerance * absoluteTolerance);
+
+    for (iterations = 0; iterations < maxIterations; iterations ++)
+    {
+        double residualNorm = 0.0;
+        for (i = 0; i < numVertices; i ++)
+            residualNorm += residual[i] * residual[i];
+        if (residualNorm <= limit)
+            return true;
+        if (rz <= 0.0)
+            return false;
+
+        // The direction is zero at the fixed vertices, which restricts
+        // the product to the free block of the matrix.
+        system.multiply(direction, product);
+
+        double pAp = 0.0;
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (!fixed[i])
+                pAp += direction[i] * product[i];
+        }
+        if (pAp <= 0.0)
+            return false;
+
+        double alpha = rz / pAp;
+        double rzNext = 0.0;
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (fixed[i])
+                continue;
+
+            values[i] += alpha * direction[i];
+            residual[i] -= alpha * product[i];
+            preconditioned[i] = residual[i] * inverseDiagonal[i];
+            rzNext += residual[i] * preconditioned[i];
+        }
+
+        double beta = rzNext / rz;
+        rz = rzNext;
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (!fixed[i])
+                direction[i] = preconditioned[i] + beta * direction[i];
+        }
+    }
+
+    // The iteration limit has been reached. The last update might
+    // still have met the tolerance.
+    double residualNorm = 0.0;
+    for (i = 0; i < numVertices; i ++)
+        residualNorm += residual[i] * residual[i];
+
+    return residualNorm <= limit;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,85 @@
+// ---------------------------------------------------------------------
+//
+//  diffusionSolver.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__diffusionSolver__
+#define __brSmoothWeights__diffusionSolver__
+
+#include <vector>
+
+#include "meshLaplacian.h"
+#include "sparseMatrix.h"
+
+// ---------------------------------------------------------------------
+// The implicit (backward Euler) diffusion of a per-vertex function.
+//
+// The solver computes (M + tL) w = M w0 for the free vertices while
+// all fixed vertices keep their value w0. The system is solved with a
+// Jacobi preconditioned conjugate gradient. The solve doesn't modify
+// any member data, which allows to diffuse several functions in
+// parallel with the same solver.
+// ---------------------------------------------------------------------
+
+class diffusionSolver
+{
+public:
+
+    diffusionSolver();
+
+    void create(const meshLaplacian &operators,
+                double time,
+                const std::vector<bool> &fixed);
+    void clear();
+    bool isEmpty() const;
+
+    bool solve(std::vector<double> &values,
+               double tolerance,
+               unsigned int maxIterations,
+               unsigned int &iterations) const;
+
+private:
+
+    unsigned int numVertices;
+    sparseMatrix system;                    // The matrix M + tL.
+    std::vector<double> mass;               // The lumped mass per
+                                            // vertex.
+    std::vector<bool> fixed;                // True, if the vertex keeps
+                                            // its value.
+    std::vector<double> inverseDiagonal;    // The Jacobi preconditioner.
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,307 @@
+// ---------------------------------------------------------------------
+//
+//  heatDistance.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "heatDistance.h"
+
+#include <cmath>
+#include <limits>
+
+
+heatDistance::heatDistance()
+{
+    numVertices = 0;
+    numComponents = 0;
+}
+
+
+//
+// Description:
+//      Build the mesh operators and factorize the heat and the Poisson
+//      system.
+//
+// Input Arguments:
+//      numVertices         The number of mesh vertices.
+//      triangles           The vertex indices of all triangles.
+//      points              The xyz positions of all vertices.
+//
+// Return Value:
+//      bool                True, if both factorizations succeeded.
+//
+bool heatDistance::create(unsigned int numVertices,
+                          const std::vector<int> &triangles,
+                          const std::vector<double> &points)
+{
+    unsigned int i, j;
+
+    clear();
+
+    operators.create(numVertices, triangles, points);
+    if (operators.isEmpty())
+        return false;
+
+    this->numVertices = numVertices;
+
+    computeComponents();
+
+    // -----------------------------------------------------------------
+    // heat flow: M + tL
+    // -----------------------------------------------------------------
+
+    // The time step is the squared mean edge length.
+    double h = operators.meanEdgeLength();
+
+    sparseMatrix heatMatrix = operators.laplacian();
+    heatMatrix.scale(h * h);
+    heatMatrix.addDiagonal(operators.mass());
+
+    // Vertices without any valid triangle have no mass. Give them a
+    // unit diagonal to keep the system positive definite.
+    std::vector<double> fill(numVertices, 0.0);
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (heatMatrix.diagonal(i) <= 0.0)
+            fill[i] = 1.0;
+    }
+    heatMatrix.addDiagonal(fill);
+
+    if (!heatSolver.factorize(heatMatrix, points))
+    {
+        clear();
+        return false;
+    }
+
+    // -----------------------------------------------------------------
+    // Poisson: L
+    // -----------------------------------------------------------------
+
+    // The Laplacian is only semi-definite because the distance is only
+    // defined up to a constant on each connected component. The first
+    // vertex of each component gets fixed to remove the null space.
+    sparseMatrix poissonMatrix = operators.laplacian();
+
+    std::vector<bool> fixed(numVertices, false);
+    std::vector<bool> found(numComponents, false);
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (!found[components[i]])
+        {
+            found[components[i]] = true;
+            fixed[i] = true;
+        }
+    }
+
+    for (i = 0; i < numVertices; i ++)
+    {
+        for (j = poissonMatrix.rowStart(i); j < poissonMatrix.rowEnd(i); j ++)
+        {
+            unsigned int column = poissonMatrix.column(j);
+            if (fixed[i] || fixed[column])
+                poissonMatrix.setValue(j, i == column ? 1.0 : 0.0);
+        }
+    }
+
+    if (!poissonSolver.factorize(poissonMatrix, points))
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+void heatDistance::clear()
+{
+    numVertices = 0;
+    numComponents = 0;
+    operators.clear();
+    heatSolver.clear();
+    poissonSolver.clear();
+    components.clear();
+}
+
+
+bool heatDistance::isEmpty() const
+{
+    return heatSolver.isEmpty() || poissonSolver.isEmpty();
+}
+
+
+//
+// Description:
+//      Assign each vertex the index of the connected component it
+//      belongs to. Isolated vertices form their own component.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void heatDistance::computeComponents()
+{
+    unsigned int i, j;
+
+    const unsigned int none = (unsigned)-1;
+
+    const sparseMatrix &laplacian = operators.laplacian();
+
+    components = std::vector<unsigned int>(numVertices, none);
+    numComponents = 0;
+
+    std::vector<unsigned int> stack;
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (components[i] != none)
+            continue;
+
+        components[i] = numComponents;
+        stack.push_back(i);
+        while (!stack.empty())
+        {
+            unsigned int current = stack.back();
+            stack.pop_back();
+            for (j = laplacian.rowStart(current); j < laplacian.rowEnd(current); j ++)
+            {
+                unsigned int next = laplacian.column(j);
+                if (components[next] == none)
+                {
+                    components[next] = numComponents;
+                    stack.push_back(next);
+                }
+            }
+        }
+        numComponents ++;
+    }
+}
+
+
+//
+// Description:
+//      Compute the geodesic distance of all vertices to the closest
+//      source vertex. Vertices which are not connected to any source
+//      get the maximum double value.
+//
+// Input Arguments:
+//      sources             The indices of the source vertices.
+//      distances           The distance per vertex.
+//
+// Return Value:
+//      None
+//
+void heatDistance::getDistances(const std::vector<unsigned int> &sources,
+                                std::vector<double> &distances)
+{
+    unsigned int i;
+
+    const double maxDistance = std::numeric_limits<double>::max();
+
+    distances = std::vector<double>(numVertices, maxDistance);
+
+    if (isEmpty() || sources.empty())
+        return;
+
+    // Integrate the heat flow.
+    std::vector<double> heat(numVertices, 0.0);
+    for (i = 0; i < sources.size(); i ++)
+    {
+        if (sources[i] < numVertices)
+            heat[sources[i]] = 1.0;
+    }
+    heatSolver.solve(heat);
+
+    // Normalize the negative gradient.
+    std::vector<double> field;
+    operators.gradient(heat, field);
+    for (i = 0; i < field.size(); i += 3)
+    {
+        double length = sqrt(field[i] * field[i] +
+                             field[i + 1] * field[i + 1] +
+                             field[i + 2] * field[i + 2]);
+        if (length > 0.0)
+        {
+            field[i] /= -length;
+            field[i + 1] /= -length;
+            field[i + 2] /= -length;
+        }
+    }
+
+    // Recover the distance which best fits the gradient field. Because
+    // the Laplacian is stored positive the sign of the divergence needs
+    // to be flipped.
+    std::vector<double> values;
+    operators.divergence(field, values);
+    for (i = 0; i < numVertices; i ++)
+        values[i] = -values[i];
+
+    // The fixed vertices need a zero right hand side.
+    std::vector<bool> found(numComponents, false);
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (!found[components[i]])
+        {
+            found[components[i]] = true;
+            values[i] = 0.0;
+        }
+    }
+
+    poissonSolver.solve(values);
+
+    // Shift the distances of each component so that the sources are at
+    // zero. Components without a source are unreachable.
+    std::vector<double> offset(numComponents, maxDistance);
+    for (i = 0; i < sources.size(); i ++)
+    {
+        if (sources[i] < numVertices)
+        {
+            unsigned int component = components[sources[i]];
+            if (values[sources[i]] < offset[component])
+                offset[component] = values[sources[i]];
+        }
+    }
+
+    for (i = 0; i < numVertices; i ++)
+    {
+        double componentOffset = offset[components[i]];
+        if (componentOffset == maxDistance)
+            continue;
+
+        double distance = values[i] - componentOffset;
+        distances[i] = distance > 0.0 ? distance : 0.0;
+    }
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
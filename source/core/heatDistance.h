@@ -0,0 +1,90 @@
+// ---------------------------------------------------------------------
+//
+//  heatDistance.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__heatDistance__
+#define __brSmoothWeights__heatDistance__
+
+#include <vector>
+
+#include "meshLaplacian.h"
+#include "sparseMatrix.h"
+
+// ---------------------------------------------------------------------
+// The geodesic distance field of a mesh based on the heat method
+// (Crane et al., "Geodesics in Heat").
+//
+// 1. Integrate the heat flow (M + tL) u = u0 for a short time t from
+//    the source vertices.
+// 2. Normalize the negative gradient X = -grad(u) / |grad(u)|.
+// 3. Solve the Poisson equation L d = -div(X) for the distance d.
+//
+// Both system matrices only depend on the mesh and get factorized once
+// in create(). Computing the distances for any set of sources then only
+// requires two solves with the cached factors.
+// ---------------------------------------------------------------------
+
+class heatDistance
+{
+public:
+
+    heatDistance();
+
+    bool create(unsigned int numVertices,
+                const std::vector<int> &triangles,
+                const std::vector<double> &points);
+    void clear();
+    bool isEmpty() const;
+
+    void getDistances(const std::vector<unsigned int> &sources,
+                      std::vector<double> &distances);
+
+private:
+
+    unsigned int numVertices;
+    meshLaplacian operators;
+    sparseLDLT heatSolver;
+    sparseLDLT poissonSolver;
+
+    std::vector<unsigned int> components;   // The connected component
+                                            // of each vertex.
+    unsigned int numComponents;
+
+    void computeComponents();
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,397 @@
+// ---------------------------------------------------------------------
+//
+//  meshLaplacian.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "meshLaplacian.h"
+
+#include <cmath>
+
+
+namespace
+{
+    inline void subtract(const double *a, const double *b, double *result)
+    {
+        result[0] = a[0] - b[0];
+        result[1] = a[1] - b[1];
+        result[2] = a[2] - b[2];
+    }
+
+    inline void cross(const double *a, const double *b, double *result)
+    {
+        result[0] = a[1] * b[2] - a[2] * b[1];
+        result[1] = a[2] * b[0] - a[0] * b[2];
+        result[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline double dot(const double *a, const double *b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline double length(const double *a)
+    {
+        return sqrt(dot(a, a));
+    }
+}
+
+
+meshLaplacian::meshLaplacian()
+{
+    numVertices = 0;
+    edgeLength = 0.0;
+}
+
+
+//
+// Description:
+//      Build the cotangent Laplacian and the lumped mass matrix from
+//      the given triangles. Degenerate triangles without area are
+//      ignored.
+//
+// Input Arguments:
+//      numVertices         The number of mesh vertices.
+//      triangles           The vertex indices of all triangles.
+//      points              The xyz positions of all vertices.
+//
+// Return Value:
+//      None
+//
+void meshLaplacian::create(unsigned int numVertices,
+                           const std::vector<int> &triangles,
+                           const std::vector<double> &points)
+{
+    unsigned int i, j;
+
+    clear();
+
+    if (points.size() != numVertices * 3)
+        return;
+
+    this->numVertices = numVertices;
+    this->triangles = triangles;
+    this->points = points;
+
+    unsigned int numTriangles = (unsigned)triangles.size() / 3;
+
+    cotangents = std::vector<double>(numTriangles * 3, 0.0);
+    vertexMass = std::vector<double>(numVertices, 0.0);
+
+    std::vector<sparseEntry> entries;
+    entries.reserve(numTriangles * 12);
+
+    double edgeSum = 0.0;
+    unsigned int edgeCount = 0;
+
+    for (i = 0; i < numTriangles; i ++)
+    {
+        unsigned int ids[3] = {(unsigned)triangles[i * 3],
+                               (unsigned)triangles[i * 3 + 1],
+                               (unsigned)triangles[i * 3 + 2]};
+
+        double normal[3];
+        double edgeA[3];
+        double edgeB[3];
+        subtract(&points[ids[1] * 3], &points[ids[0] * 3], edgeA);
+        subtract(&points[ids[2] * 3], &points[ids[0] * 3], edgeB);
+        cross(edgeA, edgeB, normal);
+        double doubleArea = length(normal);
+
+        edgeSum += length(edgeA) + length(edgeB);
+        edgeCount += 2;
+
+        if (doubleArea < 1e-20)
+            continue;
+
+        for (j = 0; j < 3; j ++)
+        {
+            unsigned int corner = ids[j];
+            unsigned int next = ids[(j + 1) % 3];
+            unsigned int prev = ids[(j + 2) % 3];
+
+            double u[3];
+            double v[3];
+            subtract(&points[next * 3], &points[corner * 3], u);
+            subtract(&points[prev * 3], &points[corner * 3], v);
+
+            // |u x v| equals the double area for all corners.
+            double cotangent = dot(u, v) / doubleArea;
+            cotangents[i * 3 + j] = cotangent;
+
+            // The corner angle weights the opposite edge.
+            double weight = 0.5 * cotangent;
+            sparseEntry entries4[4] = {{next, prev, -weight},
+                                       {prev, next, -weight},
+                                       {next, next, weight},
+                                       {prev, prev, weight}};
+            entries.insert(entries.end(), entries4, entries4 + 4);
+
+            vertexMass[corner] += doubleArea / 6.0;
+        }
+    }
+
+    if (edgeCount)
+        edgeLength = edgeSum / edgeCount;
+
+    cotanMatrix.create(numVertices, entries);
+}
+
+
+void meshLaplacian::clear()
+{
+    numVertices = 0;
+    triangles.clear();
+    points.clear();
+    cotangents.clear();
+    cotanMatrix.clear();
+    vertexMass.clear();
+    edgeLength = 0.0;
+}
+
+
+bool meshLaplacian::isEmpty() const
+{
+    return cotanMatrix.isEmpty();
+}
+
+
+const sparseMatrix &meshLaplacian::laplacian() const
+{
+    return cotanMatrix;
+}
+
+
+const std::vector<double> &meshLaplacian::mass() const
+{
+    return vertexMass;
+}
+
+
+const std::vector<double> &meshLaplacian::positions() const
+{
+    return points;
+}
+
+
+double meshLaplacian::meanEdgeLength() const
+{
+    return edgeLength;
+}
+
+
+//
+// Description:
+//      Compute the gradient of the given per-vertex function for each
+//      triangle. The gradient is constant across each triangle.
+//
+// Input Arguments:
+//      values              The function value per vertex.
+//      vectors             The xyz gradient per triangle.
+//
+// Return Value:
+//      None
+//
+void meshLaplacian::gradient(const std::vector<double> &values,
+                             std::vector<double> &vectors) const
+{
+    unsigned int i, j, k;
+
+    unsigned int numTriangles = (unsigned)triangles.size() / 3;
+    vectors = std::vector<double>(numTriangles * 3, 0.0);
+
+    for (i = 0; i < numTriangles; i ++)
+    {
+        unsigned int ids[3] = {(unsigned)triangles[i * 3],
+                               (unsigned)triangles[i * 3 + 1],
+                               (unsigned)triangles[i * 3 + 2]};
+
+        double normal[3];
+        double edgeA[3];
+        double edgeB[3];
+        subtract(&points[ids[1] * 3], &points[ids[0] * 3], edgeA);
+        subtract(&points[ids[2] * 3], &points[ids[0] * 3], edgeB);
+        cross(edgeA, edgeB, normal);
+        double doubleArea = length(normal);
+        if (doubleArea < 1e-20)
+            continue;
+
+        for (k = 0; k < 3; k ++)
+            normal[k] /= doubleArea;
+
+        // grad u = 1 / (2A) * sum(u_i * (N x e_i)), with e_i being the
+        // edge opposite of vertex i in counter-clockwise order.
+        double *result = &vectors[i * 3];
+        for (j = 0; j < 3; j ++)
+        {
+            double edge[3];
+            double side[3];
+            subtract(&points[ids[(j + 2) % 3] * 3], &points[ids[(j + 1) % 3] * 3], edge);
+            cross(normal, edge, side);
+
+            double value = values[ids[j]] / doubleArea;
+            for (k = 0; k < 3; k ++)
+                result[k] += value * side[k];
+        }
+    }
+}
+
+
+//
+// Description:
+//      Compute the integrated divergence of the given per-triangle
+//      vector field for each vertex.
+//
+// Input Arguments:
+//      vectors             The xyz vector per triangle.
+//      values              The divergence per vertex.
+//
+// Return Value:
+//      None
+//
+void meshLaplacian::divergence(const std::vector<double> &vectors,
+                               std::vector<double> &values) const
+{
+    unsigned int i, j;
+
+    unsigned int numTriangles = (unsigned)triangles.size() / 3;
+    values = std::vector<double>(numVertices, 0.0);
+
+    for (i = 0; i < numTriangles; i ++)
+    {
+        const double *field = &vectors[i * 3];
+
+        for (j = 0; j < 3; j ++)
+        {
+            unsigned int corner = (unsigned)triangles[i * 3 + j];
+            unsigned int next = (unsigned)triangles[i * 3 + (j + 1) % 3];
+            unsigned int prev = (unsigned)triangles[i * 3 + (j + 2) % 3];
+
+            double toNext[3];
+            double toPrev[3];
+            subtract(&points[next * 3], &points[corner * 3], toNext);
+            subtract(&points[prev * 3], &points[corner * 3], toPrev);
+
+            // Each edge is weighted by the cotangent of the angle
+            // opposite to it.
+            values[corner] += 0.5 * (cotangents[i * 3 + (j + 2) % 3] * dot(toNext, field) +
+                                     cotangents[i * 3 + (j + 1) % 3] * dot(toPrev, field));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+// smoothing operator
+// ---------------------------------------------------------------------
+
+smoothingOperator::smoothingOperator()
+{
+}
+
+
+//
+// Description:
+//      Build the normalized smoothing weights from the off-diagonal
+//      entries of the cotangent Laplacian. Negative weights, which
+//      occur for edges opposite of obtuse angles, are clamped to zero
+//      to keep the result a convex combination of the neighbours.
+//
+// Input Arguments:
+//      operators           The mesh operators.
+//
+// Return Value:
+//      None
+//
+void smoothingOperator::create(const meshLaplacian &operators)
+{
+    unsigned int i, j;
+
+    clear();
+
+    const sparseMatrix &laplacian = operators.laplacian();
+    unsigned int numVertices = laplacian.size();
+    if (numVertices == 0)
+        return;
+
+    offsets = std::vector<unsigned int>(numVertices + 1, 0);
+    neighbors.reserve(laplacian.rowEnd(numVertices - 1));
+    weights.reserve(laplacian.rowEnd(numVertices - 1));
+
+    for (i = 0; i < numVertices; i ++)
+    {
+        unsigned int start = (unsigned)neighbors.size();
+        double sum = 0.0;
+
+        for (j = laplacian.rowStart(i); j < laplacian.rowEnd(i); j ++)
+        {
+            unsigned int column = laplacian.column(j);
+            if (column == i)
+                continue;
+
+            double value = -laplacian.value(j);
+            if (value < 0.0)
+                value = 0.0;
+
+            neighbors.push_back(column);
+            weights.push_back(value);
+            sum += value;
+        }
+
+        unsigned int count = (unsigned)neighbors.size() - start;
+        for (j = start; j < start + count; j ++)
+        {
+            if (sum > 0.0)
+                weights[j] /= sum;
+            else
+                weights[j] = 1.0 / count;
+        }
+
+        offsets[i + 1] = (unsigned)neighbors.size();
+    }
+}
+
+
+void smoothingOperator::clear()
+{
+    offsets.clear();
+    neighbors.clear();
+    weights.clear();
+}
+
+
+bool smoothingOperator::isEmpty() const
+{
+    return offsets.empty();
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
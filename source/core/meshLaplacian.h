@@ -0,0 +1,151 @@
+// ---------------------------------------------------------------------
+//
+//  meshLaplacian.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__meshLaplacian__
+#define __brSmoothWeights__meshLaplacian__
+
+#include <vector>
+
+#include "sparseMatrix.h"
+
+// ---------------------------------------------------------------------
+// The discrete operators of a triangulated mesh.
+//
+// The cotangent Laplacian L is stored positive semi-definite, with
+// L(i,j) = -0.5 * (cot(alpha) + cot(beta)) for each edge and the
+// negative row sum on the diagonal. The mass matrix M is lumped and
+// holds a third of the area of all adjacent triangles per vertex.
+// ---------------------------------------------------------------------
+
+class meshLaplacian
+{
+public:
+
+    meshLaplacian();
+
+    void create(unsigned int numVertices,
+                const std::vector<int> &triangles,
+                const std::vector<double> &points);
+    void clear();
+    bool isEmpty() const;
+
+    const sparseMatrix &laplacian() const;
+    const std::vector<double> &mass() const;
+    const std::vector<double> &positions() const;
+    double meanEdgeLength() const;
+
+    void gradient(const std::vector<double> &values,
+                  std::vector<double> &vectors) const;
+    void divergence(const std::vector<double> &vectors,
+                    std::vector<double> &values) const;
+
+private:
+
+    unsigned int numVertices;
+    std::vector<int> triangles;             // The vertex indices of
+                                            // all triangles.
+    std::vector<double> points;             // The xyz positions of all
+                                            // vertices.
+    std::vector<double> cotangents;         // The cotangent of each
+                                            // triangle corner.
+    sparseMatrix cotanMatrix;
+    std::vector<double> vertexMass;
+    double edgeLength;
+};
+
+
+// ---------------------------------------------------------------------
+// The per-vertex averaging weights of the smoothing. Each row holds the
+// neighbours of a vertex with their cotangent weights, clamped to be
+// non-negative and normalized to a sum of one. Rows without a valid
+// weight fall back to a uniform average.
+// ---------------------------------------------------------------------
+
+class smoothingOperator
+{
+public:
+
+    smoothingOperator();
+
+    void create(const meshLaplacian &operators);
+    void clear();
+    bool isEmpty() const;
+
+    unsigned int rowStart(unsigned int index) const;
+    unsigned int rowEnd(unsigned int index) const;
+    unsigned int neighbor(unsigned int entry) const;
+    double weight(unsigned int entry) const;
+
+private:
+
+    std::vector<unsigned int> offsets;      // The start of each row.
+    std::vector<unsigned int> neighbors;    // The neighbour index of
+                                            // each entry.
+    std::vector<double> weights;            // The normalized weight of
+                                            // each entry.
+};
+
+
+// ---------------------------------------------------------------------
+// inline methods
+// ---------------------------------------------------------------------
+
+inline unsigned int smoothingOperator::rowStart(unsigned int index) const
+{
+    return offsets[index];
+}
+
+
+inline unsigned int smoothingOperator::rowEnd(unsigned int index) const
+{
+    return offsets[index + 1];
+}
+
+
+inline unsigned int smoothingOperator::neighbor(unsigned int entry) const
+{
+    return neighbors[entry];
+}
+
+
+inline double smoothingOperator::weight(unsigned int entry) const
+{
+    return weights[entry];
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
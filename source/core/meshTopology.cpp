@@ -0,0 +1,362 @@
+// ---------------------------------------------------------------------
+//
+//  meshTopology.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "meshTopology.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+
+meshTopology::meshTopology()
+{
+    numVertices = 0;
+    searchStamp = 0;
+}
+
+
+//
+// Description:
+//      Build the vertex adjacency and the border flags from the polygon
+//      connectivity of the mesh.
+//
+// Input Arguments:
+//      numVertices         The number of mesh vertices.
+//      polyCounts          The number of vertices for each polygon.
+//      polyVertices        The vertex indices of all polygons.
+//
+// Return Value:
+//      None
+//
+void meshTopology::create(unsigned int numVertices,
+                          const std::vector<int> &polyCounts,
+                          const std::vector<int> &polyVertices)
+{
+    unsigned int i, j;
+
+    clear();
+
+    this->numVertices = numVertices;
+
+    // Collect all polygon edges as a sortable pair of vertex indices
+    // with the smaller index first. Shared edges occur twice, border
+    // edges only once.
+    std::vector<unsigned long long> edges;
+    edges.reserve(polyVertices.size());
+
+    unsigned int faceStart = 0;
+    for (i = 0; i < polyCounts.size(); i ++)
+    {
+        unsigned int count = (unsigned)polyCounts[i];
+        for (j = 0; j < count; j ++)
+        {
+            unsigned long long a = (unsigned)polyVertices[faceStart + j];
+            unsigned long long b = (unsigned)polyVertices[faceStart + (j + 1) % count];
+            if (a == b)
+                continue;
+            if (a > b)
+                std::swap(a, b);
+            edges.push_back((a << 32) | b);
+        }
+        faceStart += count;
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    // Count the unique edges per vertex and mark the border vertices.
+    boundary = std::vector<bool>(numVertices, false);
+    std::vector<unsigned int> counts(numVertices, 0);
+    std::vector<unsigned long long> uniqueEdges;
+    uniqueEdges.reserve(edges.size() / 2 + 1);
+
+    for (i = 0; i < edges.size(); )
+    {
+        j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i])
+            j ++;
+
+        unsigned int a = (unsigned)(edges[i] >> 32);
+        unsigned int b = (unsigned)(edges[i] & 0xffffffff);
+        uniqueEdges.push_back(edges[i]);
+        counts[a] ++;
+        counts[b] ++;
+
+        if (j - i == 1)
+        {
+            boundary[a] = true;
+            boundary[b] = true;
+        }
+        i = j;
+    }
+
+    // Build the row offsets and fill the rows.
+    offsets = std::vector<unsigned int>(numVertices + 1, 0);
+    for (i = 0; i < numVertices; i ++)
+        offsets[i + 1] = offsets[i] + counts[i];
+
+    neighbors = std::vector<unsigned int>(offsets[numVertices], 0);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (i = 0; i < uniqueEdges.size(); i ++)
+    {
+        unsigned int a = (unsigned)(uniqueEdges[i] >> 32);
+        unsigned int b = (unsigned)(uniqueEdges[i] & 0xffffffff);
+        neighbors[fill[a] ++] = b;
+        neighbors[fill[b] ++] = a;
+    }
+
+    searchDistances = std::vector<double>(numVertices, 0.0);
+    searchStamps = std::vector<unsigned int>(numVertices, 0);
+    searchStamp = 0;
+}
+
+
+//
+// Description:
+//      Set the vertex adjacency and the border flags which have been
+//      built before, i.e. when reading them from the topology cache.
+//
+// Input Arguments:
+//      numVertices         The number of mesh vertices.
+//      offsets             The start of each vertex row.
+//      neighbors           The connected vertex indices of all rows.
+//      boundary            The border flag of each vertex.
+//
+// Return Value:
+//      None
+//
+void meshTopology::assign(unsigned int numVertices,
+                          const std::vector<unsigned int> &offsets,
+                          const std::vector<unsigned int> &neighbors,
+                          const std::vector<bool> &boundary)
+{
+    clear();
+
+    this->numVertices = numVertices;
+    this->offsets = offsets;
+    this->neighbors = neighbors;
+    this->boundary = boundary;
+
+    searchDistances = std::vector<double>(numVertices, 0.0);
+    searchStamps = std::vector<unsigned int>(numVertices, 0);
+    searchStamp = 0;
+}
+
+
+void meshTopology::clear()
+{
+    numVertices = 0;
+    offsets.clear();
+    neighbors.clear();
+    edgeLengths.clear();
+    boundary.clear();
+    points.clear();
+    searchDistances.clear();
+    searchStamps.clear();
+    searchStamp = 0;
+}
+
+
+bool meshTopology::isEmpty() const
+{
+    return offsets.empty();
+}
+
+
+//
+// Description:
+//      Store the given vertex positions and update the cached edge
+//      lengths.
+//
+// Input Arguments:
+//      values              The xyz positions of all vertices.
+//
+// Return Value:
+//      None
+//
+void meshTopology::setPoints(const std::vector<double> &values)
+{
+    if (isEmpty() || values.size() != numVertices * 3)
+        return;
+
+    points = values;
+    edgeLengths.resize(neighbors.size());
+
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, numVertices),
+                      [&](tbb::blocked_range<unsigned int> r)
+    {
+        for (unsigned int i = r.begin(); i < r.end(); i ++)
+        {
+            const double *p = &points[i * 3];
+            for (unsigned int j = offsets[i]; j < offsets[i + 1]; j ++)
+            {
+                const double *q = &points[neighbors[j] * 3];
+                double x = q[0] - p[0];
+                double y = q[1] - p[1];
+                double z = q[2] - p[2];
+                edgeLengths[j] = sqrt(x * x + y * y + z * z);
+            }
+        }
+    });
+}
+
+
+bool meshTopology::hasPoints() const
+{
+    return !edgeLengths.empty();
+}
+
+
+//
+// Description:
+//      Collect all vertices within the given radius of the brush
+//      center, no matter if they are connected to each other.
+//
+// Input Arguments:
+//      center              The xyz position of the brush center.
+//      radius              The radius of the brush volume.
+//      indices             The array of found vertex indices.
+//
+// Return Value:
+//      None
+//
+void meshTopology::getVerticesInSphere(const double *center,
+                                       double radius,
+                                       std::vector<unsigned int> &indices) const
+{
+    unsigned int i;
+
+    indices.clear();
+
+    if (points.empty())
+        return;
+
+    double limit = radius * radius;
+
+    for (i = 0; i < numVertices; i ++)
+    {
+        const double *p = &points[i * 3];
+        double x = p[0] - center[0];
+        double y = p[1] - center[1];
+        double z = p[2] - center[2];
+
+        if (x * x + y * y + z * z <= limit)
+            indices.push_back(i);
+    }
+}
+
+
+//
+// Description:
+//      Collect the candidate vertices which are within the given radius
+//      of a vertex, together with a linear falloff value based on the
+//      squared distance. This is used by the volume smoothing, where
+//      the candidates are all vertices of the brush volume.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      candidates          The vertices to test.
+//      radius              The range around the vertex.
+//      indices             The array of candidates in range, excluding
+//                          the vertex itself.
+//      values              The array of falloff values between 0 at
+//                          the radius and 1 at the vertex.
+//
+// Return Value:
+//      None
+//
+void meshTopology::getVolumeRange(unsigned int index,
+                                  const std::vector<unsigned int> &candidates,
+                                  double radius,
+                                  std::vector<unsigned int> &indices,
+                                  std::vector<double> &values) const
+{
+    unsigned int i;
+
+    indices.clear();
+    values.clear();
+
+    if (index >= numVertices || points.empty())
+        return;
+
+    double limit = radius * radius;
+    const double *origin = &points[index * 3];
+
+    for (i = 0; i < candidates.size(); i ++)
+    {
+        unsigned int candidate = candidates[i];
+        if (candidate == index)
+            continue;
+
+        const double *p = &points[candidate * 3];
+        double x = p[0] - origin[0];
+        double y = p[1] - origin[1];
+        double z = p[2] - origin[2];
+
+        double delta = x * x + y * y + z * z;
+        if (delta <= limit)
+        {
+            indices.push_back(candidate);
+            values.push_back(1.0 - delta / limit);
+        }
+    }
+}
+
+
+//
+// Description:
+//      Return a new stamp for the distance search buffers. In the rare
+//      case that the stamp counter overflows the buffers get reset.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      unsigned int        The stamp for the next search.
+//
+unsigned int meshTopology::nextSearchStamp()
+{
+    searchStamp ++;
+    if (searchStamp == 0)
+    {
+        std::fill(searchStamps.begin(), searchStamps.end(), 0);
+        searchStamp = 1;
+    }
+    return searchStamp;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,396 @@
+// ---------------------------------------------------------------------
+//
+//  meshTopology.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__meshTopology__
+#define __brSmoothWeights__meshTopology__
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+// ---------------------------------------------------------------------
+// The vertex adjacency of a mesh in compressed row storage (CSR).
+// The neighbours of vertex i are stored in the range
+// neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1]. The length of
+// each edge is cached in the same layout so that walking the mesh
+// doesn't require any iterator or point queries.
+//
+// The class doesn't depend on the Maya API. The contexts fill it with
+// the polygon connectivity and the vertex positions of the mesh.
+// ---------------------------------------------------------------------
+
+class meshTopology
+{
+public:
+
+    meshTopology();
+
+    void create(unsigned int numVertices,
+                const std::vector<int> &polyCounts,
+                const std::vector<int> &polyVertices);
+    void assign(unsigned int numVertices,
+                const std::vector<unsigned int> &offsets,
+                const std::vector<unsigned int> &neighbors,
+                const std::vector<bool> &boundary);
+    void clear();
+    bool isEmpty() const;
+
+    void setPoints(const std::vector<double> &values);
+    bool hasPoints() const;
+
+    unsigned int vertexCount() const;
+    unsigned int neighborCount() const;
+    bool onBoundary(unsigned int index) const;
+
+    unsigned int rowStart(unsigned int index) const;
+    unsigned int rowEnd(unsigned int index) const;
+    unsigned int neighbor(unsigned int entry) const;
+    double edgeLength(unsigned int entry) const;
+    const double *point(unsigned int index) const;
+
+    void getVerticesInSphere(const double *center,
+                             double radius,
+                             std::vector<unsigned int> &indices) const;
+    void getVolumeRange(unsigned int index,
+                        const std::vector<unsigned int> &candidates,
+                        double radius,
+                        std::vector<unsigned int> &indices,
+                        std::vector<double> &values) const;
+
+    template <typename OppositeFn>
+    void getEuclideanRange(unsigned int index,
+                           const double *center,
+                           double radius,
+                           OppositeFn oppositeIndex,
+                           std::vector<unsigned int> &indices,
+                           std::vector<double> &distances);
+    template <typename OppositeFn>
+    void getGeodesicRange(unsigned int index,
+                          double startDistance,
+                          double radius,
+                          OppositeFn oppositeIndex,
+                          std::vector<unsigned int> &indices,
+                          std::vector<double> &distances);
+
+private:
+
+    unsigned int numVertices;
+    std::vector<unsigned int> offsets;      // The start of each vertex
+                                            // row. The array has one
+                                            // more element than there
+                                            // are vertices.
+    std::vector<unsigned int> neighbors;    // The connected vertex
+                                            // indices of all rows.
+    std::vector<double> edgeLengths;        // The edge length for each
+                                            // neighbour entry.
+    std::vector<bool> boundary;             // True, if the vertex is
+                                            // connected to a border
+                                            // edge.
+    std::vector<double> points;             // The xyz positions the
+                                            // edge lengths are based on.
+
+    // The buffers for the distance search. Instead of clearing the
+    // distances for every search, each entry is marked with the search
+    // it belongs to. An entry is only valid if its stamp matches the
+    // current stamp.
+    std::vector<double> searchDistances;
+    std::vector<unsigned int> searchStamps;
+    unsigned int searchStamp;
+
+    unsigned int nextSearchStamp();
+};
+
+
+// ---------------------------------------------------------------------
+// inline methods
+// ---------------------------------------------------------------------
+
+inline unsigned int meshTopology::vertexCount() const
+{
+    return numVertices;
+}
+
+
+inline unsigned int meshTopology::neighborCount() const
+{
+    return (unsigned)neighbors.size();
+}
+
+
+inline bool meshTopology::onBoundary(unsigned int index) const
+{
+    return boundary[index];
+}
+
+
+inline unsigned int meshTopology::rowStart(unsigned int index) const
+{
+    return offsets[index];
+}
+
+
+inline unsigned int meshTopology::rowEnd(unsigned int index) const
+{
+    return offsets[index + 1];
+}
+
+
+inline unsigned int meshTopology::neighbor(unsigned int entry) const
+{
+    return neighbors[entry];
+}
+
+
+inline double meshTopology::edgeLength(unsigned int entry) const
+{
+    return edgeLengths[entry];
+}
+
+
+inline const double *meshTopology::point(unsigned int index) const
+{
+    return &points[index * 3];
+}
+
+
+//
+// Description:
+//      Collect all vertices which can be reached from the given vertex
+//      by walking from neighbour to neighbour while the straight
+//      distance to the brush center is within the given radius. The
+//      walk proceeds ring by ring from the start vertex, the same way
+//      the brush has always collected its vertices, but only uses the
+//      cached adjacency and positions.
+//
+// Input Arguments:
+//      index               The start vertex index.
+//      center              The xyz position of the brush center.
+//      radius              The maximum distance.
+//      oppositeIndex       The function which returns the opposite
+//                          vertex of a border vertex on a neighbouring
+//                          shell or -1. It's only called for border
+//                          vertices. The opposite vertex and its
+//                          neighbours are walked like the neighbours
+//                          of the border vertex.
+//      indices             The array of found vertex indices, excluding
+//                          the start vertex.
+//      distances           The array of distances of the found vertices
+//                          to the brush center.
+//
+// Return Value:
+//      None
+//
+template <typename OppositeFn>
+void meshTopology::getEuclideanRange(unsigned int index,
+                                     const double *center,
+                                     double radius,
+                                     OppositeFn oppositeIndex,
+                                     std::vector<unsigned int> &indices,
+                                     std::vector<double> &distances)
+{
+    unsigned int i;
+
+    indices.clear();
+    distances.clear();
+
+    if (index >= numVertices || points.empty())
+        return;
+
+    unsigned int stamp = nextSearchStamp();
+    searchStamps[index] = stamp;
+
+    // Add a vertex if it hasn't been found yet and is inside the
+    // radius.
+    auto visit = [&](unsigned int vertex)
+    {
+        if (searchStamps[vertex] == stamp)
+            return;
+
+        const double *p = &points[vertex * 3];
+        double x = p[0] - center[0];
+        double y = p[1] - center[1];
+        double z = p[2] - center[2];
+        double distance = sqrt(x * x + y * y + z * z);
+        if (distance > radius)
+            return;
+
+        searchStamps[vertex] = stamp;
+        indices.push_back(vertex);
+        distances.push_back(distance);
+    };
+
+    auto walk = [&](unsigned int vertex)
+    {
+        for (i = offsets[vertex]; i < offsets[vertex + 1]; i ++)
+            visit(neighbors[i]);
+
+        if (!boundary[vertex])
+            return;
+
+        int opposite = oppositeIndex(vertex);
+        if (opposite < 0 || (unsigned)opposite >= numVertices)
+            return;
+
+        unsigned int oppositeId = (unsigned)opposite;
+        visit(oppositeId);
+        for (i = offsets[oppositeId]; i < offsets[oppositeId + 1]; i ++)
+            visit(neighbors[i]);
+    };
+
+    // The found vertices are walked in the order they have been found,
+    // which processes the rings around the start vertex one after the
+    // other.
+    walk(index);
+    for (size_t k = 0; k < indices.size(); k ++)
+        walk(indices[k]);
+}
+
+
+//
+// Description:
+//      Collect all vertices which can be reached from the given vertex
+//      by walking along the mesh edges without exceeding the given
+//      radius. This is a Dijkstra search over the cached edge lengths
+//      which stops as soon as the next closest vertex is outside the
+//      radius. Only vertices which are actually connected through the
+//      surface are found, which prevents the brush from reaching across
+//      gaps of thin features.
+//
+// Input Arguments:
+//      index               The start vertex index.
+//      startDistance       The distance of the start vertex to the
+//                          brush center.
+//      radius              The maximum distance.
+//      oppositeIndex       The function which returns the opposite
+//                          vertex of a border vertex on a neighbouring
+//                          shell or -1. It's only called for border
+//                          vertices. The opposite vertex is reached at
+//                          the same distance.
+//      indices             The array of found vertex indices, excluding
+//                          the start vertex.
+//      distances           The array of surface distances of the found
+//                          vertices to the brush center.
+//
+// Return Value:
+//      None
+//
+template <typename OppositeFn>
+void meshTopology::getGeodesicRange(unsigned int index,
+                                    double startDistance,
+                                    double radius,
+                                    OppositeFn oppositeIndex,
+                                    std::vector<unsigned int> &indices,
+                                    std::vector<double> &distances)
+{
+    typedef std::pair<double, unsigned int> queueItem;
+
+    indices.clear();
+    distances.clear();
+
+    if (index >= numVertices || edgeLengths.empty())
+        return;
+
+    unsigned int stamp = nextSearchStamp();
+
+    std::priority_queue<queueItem,
+                        std::vector<queueItem>,
+                        std::greater<queueItem> > queue;
+
+    searchStamps[index] = stamp;
+    searchDistances[index] = startDistance;
+    queue.push(queueItem(startDistance, index));
+
+    while (!queue.empty())
+    {
+        queueItem item = queue.top();
+        queue.pop();
+
+        double distance = item.first;
+        unsigned int current = item.second;
+
+        // Skip outdated queue entries. The vertex has already been
+        // reached with a shorter distance.
+        if (distance > searchDistances[current])
+            continue;
+
+        if (current != index)
+        {
+            indices.push_back(current);
+            distances.push_back(distance);
+        }
+
+        // Jump to the opposite vertex of a neighbouring shell without
+        // any additional distance.
+        if (boundary[current])
+        {
+            int opposite = oppositeIndex(current);
+            if (opposite > -1 && (unsigned)opposite < numVertices)
+            {
+                unsigned int oppositeId = (unsigned)opposite;
+                if (searchStamps[oppositeId] != stamp ||
+                    distance < searchDistances[oppositeId])
+                {
+                    searchStamps[oppositeId] = stamp;
+                    searchDistances[oppositeId] = distance;
+                    queue.push(queueItem(distance, oppositeId));
+                }
+            }
+        }
+
+        for (unsigned int i = offsets[current]; i < offsets[current + 1]; i ++)
+        {
+            unsigned int next = neighbors[i];
+            double nextDistance = distance + edgeLengths[i];
+
+            // Bound the search by the brush radius.
+            if (nextDistance > radius)
+                continue;
+
+            if (searchStamps[next] != stamp || nextDistance < searchDistances[next])
+            {
+                searchStamps[next] = stamp;
+                searchDistances[next] = nextDistance;
+                queue.push(queueItem(nextDistance, next));
+            }
+        }
+    }
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,186 @@
+// ---------------------------------------------------------------------
+//
+//  mirrorMap.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "mirrorMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+// The smallest cell size of the spatial hash. This keeps the cell
+// coordinates in range for very small tolerance values.
+static const double kMinCellSize = 1e-6;
+
+
+mirrorMap::mirrorMap()
+{
+    mirrorAxis = 0;
+}
+
+
+//
+// Description:
+//      Find the mirrored point for each of the given points.
+//
+// Input Arguments:
+//      points              The xyz positions of all points.
+//      axis                The axis perpendicular to the mirror plane.
+//      tolerance           The max distance between the mirrored
+//                          position and the matching point.
+//
+// Return Value:
+//      None
+//
+void mirrorMap::create(const std::vector<double> &points,
+                       unsigned int axis,
+                       double tolerance)
+{
+    unsigned int i;
+
+    clear();
+
+    mirrorAxis = axis;
+
+    unsigned int count = (unsigned int)(points.size() / 3);
+    indices = std::vector<int>(count, -1);
+
+    double cellSize = std::max(tolerance, kMinCellSize);
+    double maxDistance = tolerance * tolerance;
+
+    // Sort the points by the key of the cell they are located in.
+    // The points of a cell are then found with a binary search.
+    std::vector<std::pair<unsigned long long, unsigned int> > cells(count);
+    for (i = 0; i < count; i ++)
+    {
+        cells[i].first = cellKey((long long)std::floor(points[i * 3] / cellSize),
+                                 (long long)std::floor(points[i * 3 + 1] / cellSize),
+                                 (long long)std::floor(points[i * 3 + 2] / cellSize));
+        cells[i].second = i;
+    }
+    std::sort(cells.begin(), cells.end());
+
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, count),
+                      [&](tbb::blocked_range<unsigned int> r)
+    {
+        for (unsigned int p = r.begin(); p < r.end(); p ++)
+        {
+            double mirrored[3] = {points[p * 3], points[p * 3 + 1], points[p * 3 + 2]};
+            mirrored[mirrorAxis] *= -1;
+
+            long long cell[3];
+            for (unsigned int c = 0; c < 3; c ++)
+                cell[c] = (long long)std::floor(mirrored[c] / cellSize);
+
+            // The matching point can be located in any of the cells
+            // around the mirrored position because the cell size
+            // equals the tolerance.
+            int closest = -1;
+            double closestDistance = maxDistance;
+
+            for (long long x = cell[0] - 1; x <= cell[0] + 1; x ++)
+            {
+                for (long long y = cell[1] - 1; y <= cell[1] + 1; y ++)
+                {
+                    for (long long z = cell[2] - 1; z <= cell[2] + 1; z ++)
+                    {
+                        std::pair<unsigned long long, unsigned int> start(cellKey(x, y, z), 0);
+                        std::vector<std::pair<unsigned long long, unsigned int> >::const_iterator it;
+                        it = std::lower_bound(cells.begin(), cells.end(), start);
+
+                        for (; it != cells.end() && it->first == start.first; ++ it)
+                        {
+                            unsigned int other = it->second;
+                            double dx = points[other * 3] - mirrored[0];
+                            double dy = points[other * 3 + 1] - mirrored[1];
+                            double dz = points[other * 3 + 2] - mirrored[2];
+                            double distance = dx * dx + dy * dy + dz * dz;
+
+                            // Prefer the lower index for equal distances
+                            // so that the result doesn't depend on the
+                            // order of the cells.
+                            if (distance < closestDistance ||
+                                (distance == closestDistance &&
+                                 (closest == -1 || (int)other < closest)))
+                            {
+                                closest = (int)other;
+                                closestDistance = distance;
+                            }
+                        }
+                    }
+                }
+            }
+
+            indices[p] = closest;
+        }
+    });
+}
+
+
+void mirrorMap::clear()
+{
+    indices.clear();
+}
+
+
+bool mirrorMap::isEmpty() const
+{
+    return indices.empty();
+}
+
+
+//
+// Description:
+//      Return the hash key of the given cell. Different cells can share
+//      the same key, which only adds points to the search that are
+//      rejected by their distance.
+//
+// Input Arguments:
+//      x, y, z             The cell coordinates.
+//
+// Return Value:
+//      unsigned long long  The key of the cell.
+//
+unsigned long long mirrorMap::cellKey(long long x, long long y, long long z)
+{
+    unsigned long long key = (unsigned long long)x * 73856093ULL;
+    key ^= (unsigned long long)y * 19349663ULL;
+    key ^= (unsigned long long)z * 83492791ULL;
+    return key;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
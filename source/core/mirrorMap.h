@@ -0,0 +1,104 @@
+// ---------------------------------------------------------------------
+//
+//  mirrorMap.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__mirrorMap__
+#define __brSmoothWeights__mirrorMap__
+
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------
+// The mapping of each point to the point on the opposite side of a
+// mirror plane. The plane goes through the origin and is defined by the
+// axis which is perpendicular to it: 0 for the yz plane, 1 for the xz
+// plane and 2 for the xy plane.
+//
+// The points are sorted into a spatial hash with the tolerance as the
+// cell size, so that finding the mirrored point only needs to test the
+// points of the cells around the mirrored position. Points without a
+// counterpart within the tolerance are mapped to -1. Points on the
+// plane are mapped to themselves.
+//
+// The class is used for the mesh vertices as well as for the
+// influence positions.
+// ---------------------------------------------------------------------
+
+class mirrorMap
+{
+public:
+
+    mirrorMap();
+
+    void create(const std::vector<double> &points,
+                unsigned int axis,
+                double tolerance);
+    void clear();
+    bool isEmpty() const;
+
+    unsigned int size() const;
+    unsigned int axis() const;
+    int mirrorIndex(unsigned int index) const;
+
+private:
+
+    static unsigned long long cellKey(long long x, long long y, long long z);
+
+    unsigned int mirrorAxis;
+    std::vector<int> indices;   // The mirrored point index of each
+                                // point or -1.
+};
+
+
+inline unsigned int mirrorMap::size() const
+{
+    return (unsigned int)indices.size();
+}
+
+
+inline unsigned int mirrorMap::axis() const
+{
+    return mirrorAxis;
+}
+
+
+inline int mirrorMap::mirrorIndex(unsigned int index) const
+{
+    return indices[index];
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
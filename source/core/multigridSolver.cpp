@@ -0,0 +1,564 @@
+// ---------------------------------------------------------------------
+//
+//  multigridSolver.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "multigridSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The residual norm at which the solve counts as converged regardless
+// of the tolerance, so that a zero right hand side doesn't fail.
+static const double absoluteTolerance = 1e-15;
+
+// The size at which the coarsening stops and the level gets solved
+// directly.
+static const unsigned int COARSE_SIZE = 256;
+static const unsigned int MAX_LEVELS = 20;
+
+// The damping of the Jacobi relaxation.
+static const double RELAXATION = 0.66;
+
+
+multigridSolver::multigridSolver()
+{
+}
+
+
+//
+// Description:
+//      Build the vertex clusters of all levels from the connectivity
+//      of the Laplacian.
+//
+// Input Arguments:
+//      operators           The mesh operators.
+//
+// Return Value:
+//      None
+//
+void multigridSolver::create(const meshLaplacian &operators)
+{
+    unsigned int i, j, p;
+
+    clear();
+
+    if (operators.isEmpty())
+        return;
+
+    sparseMatrix graph = operators.laplacian();
+
+    level current;
+    current.size = graph.size();
+    current.points = operators.positions();
+
+    while (true)
+    {
+        unsigned int numVertices = current.size;
+
+        if (numVertices <= COARSE_SIZE || levels.size() + 1 >= MAX_LEVELS)
+            break;
+
+        // Pass 1: Each vertex whose neighbours are all unassigned
+        // becomes the seed of a new cluster together with its
+        // neighbours.
+        const unsigned int unassigned = (unsigned int)-1;
+        std::vector<unsigned int> clusters(numVertices, unassigned);
+        unsigned int numClusters = 0;
+
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (clusters[i] != unassigned)
+                continue;
+
+            bool isFree = true;
+            for (p = graph.rowStart(i); p < graph.rowEnd(i); p ++)
+            {
+                if (clusters[graph.column(p)] != unassigned)
+                {
+                    isFree = false;
+                    break;
+                }
+            }
+            if (!isFree)
+                continue;
+
+            for (p = graph.rowStart(i); p < graph.rowEnd(i); p ++)
+                clusters[graph.column(p)] = numClusters;
+            clusters[i] = numClusters;
+            numClusters ++;
+        }
+
+        // Pass 2: The remaining vertices join the cluster of a
+        // neighbour which has been assigned during the first pass.
+        std::vector<unsigned int> seeded = clusters;
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (clusters[i] != unassigned)
+                continue;
+
+            for (p = graph.rowStart(i); p < graph.rowEnd(i); p ++)
+            {
+                j = graph.column(p);
+                if (seeded[j] != unassigned)
+                {
+                    clusters[i] = seeded[j];
+                    break;
+                }
+            }
+        }
+
+        // Pass 3: Vertices without any clustered neighbour, such as
+        // isolated vertices, form their own cluster.
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (clusters[i] == unassigned)
+                clusters[i] = numClusters ++;
+        }
+
+        // Stop if the level doesn't reduce the vertex count any
+        // further.
+        if (numClusters * 6 > numVertices * 5)
+            break;
+
+        // The coarse connectivity and the cluster centers.
+        std::vector<sparseEntry> entries;
+        entries.reserve(graph.rowEnd(numVertices - 1));
+        for (i = 0; i < numVertices; i ++)
+        {
+            for (p = graph.rowStart(i); p < graph.rowEnd(i); p ++)
+            {
+                sparseEntry entry = {clusters[i],
+                                     clusters[graph.column(p)],
+                                     1.0};
+                entries.push_back(entry);
+            }
+        }
+
+        level coarse;
+        coarse.size = numClusters;
+        coarse.points = std::vector<double>(numClusters * 3, 0.0);
+        std::vector<unsigned int> count(numClusters, 0);
+        for (i = 0; i < numVertices; i ++)
+        {
+            unsigned int c = clusters[i];
+            coarse.points[c * 3] += current.points[i * 3];
+            coarse.points[c * 3 + 1] += current.points[i * 3 + 1];
+            coarse.points[c * 3 + 2] += current.points[i * 3 + 2];
+            count[c] ++;
+        }
+        for (i = 0; i < numClusters; i ++)
+        {
+            coarse.points[i * 3] /= count[i];
+            coarse.points[i * 3 + 1] /= count[i];
+            coarse.points[i * 3 + 2] /= count[i];
+        }
+
+        current.clusters.swap(clusters);
+        current.points.clear();
+        levels.push_back(current);
+
+        graph.create(numClusters, entries);
+        current = coarse;
+    }
+
+    levels.push_back(current);
+}
+
+
+void multigridSolver::clear()
+{
+    levels.clear();
+    mass.clear();
+    coarseSolver.clear();
+}
+
+
+bool multigridSolver::isEmpty() const
+{
+    return levels.empty();
+}
+
+
+//
+// Description:
+//      Build the system matrices of all levels and factorize the
+//      coarsest level for the given diffusion time.
+//
+// Input Arguments:
+//      operators           The mesh operators.
+//      time                The diffusion time.
+//      fixed               The flag per vertex if it keeps its value.
+//
+// Return Value:
+//      bool                True, if the setup was successful.
+//
+bool multigridSolver::setup(const meshLaplacian &operators,
+                            double time,
+                            const std::vector<bool> &fixed)
+{
+    unsigned int i, l, p;
+
+    coarseSolver.clear();
+
+    if (levels.empty() || operators.isEmpty()
+        || operators.laplacian().size() != levels[0].size)
+        return false;
+
+    mass = operators.mass();
+
+    level &finest = levels[0];
+    finest.system = operators.laplacian();
+    finest.system.scale(time);
+    finest.system.addDiagonal(operators.mass());
+
+    finest.active = std::vector<bool>(finest.size, false);
+    for (i = 0; i < finest.size; i ++)
+    {
+        if (i < fixed.size() && !fixed[i])
+            finest.active[i] = finest.system.diagonal(i) > 0.0;
+    }
+
+    for (l = 0; l < levels.size(); l ++)
+    {
+        level &current = levels[l];
+
+        current.inverseDiagonal = std::vector<double>(current.size, 0.0);
+        for (i = 0; i < current.size; i ++)
+        {
+            double value = current.system.diagonal(i);
+            if (current.active[i] && value > 0.0)
+                current.inverseDiagonal[i] = 1.0 / value;
+            else
+                current.active[i] = false;
+        }
+
+        if (l + 1 == levels.size())
+            break;
+
+        // The coarse operator is the sum of the fine operator over the
+        // clusters, restricted to the free vertices.
+        level &coarse = levels[l + 1];
+        coarse.active = std::vector<bool>(coarse.size, false);
+
+        std::vector<sparseEntry> entries;
+        for (i = 0; i < current.size; i ++)
+        {
+            if (!current.active[i])
+                continue;
+
+            unsigned int c = current.clusters[i];
+            coarse.active[c] = true;
+
+            for (p = current.system.rowStart(i);
+                 p < current.system.rowEnd(i); p ++)
+            {
+                unsigned int j = current.system.column(p);
+                if (!current.active[j])
+                    continue;
+
+                sparseEntry entry = {c,
+                                     current.clusters[j],
+                                     current.system.value(p)};
+                entries.push_back(entry);
+            }
+        }
+        coarse.system.create(coarse.size, entries);
+    }
+
+    // Clusters without any free vertex only get a unit diagonal to
+    // keep the coarsest matrix factorizable.
+    level &coarsest = levels.back();
+    sparseMatrix matrix = coarsest.system;
+    std::vector<double> unit(coarsest.size, 0.0);
+    for (i = 0; i < coarsest.size; i ++)
+    {
+        if (!coarsest.active[i])
+            unit[i] = 1.0;
+    }
+    matrix.addDiagonal(unit);
+
+    return coarseSolver.factorize(matrix, coarsest.points);
+}
+
+
+//
+// Description:
+//      Diffuse the given values. The values of the fixed vertices act
+//      as boundary conditions and remain unchanged.
+//
+// Input Arguments:
+//      values              The initial values w0 which get replaced by
+//                          the result.
+//      tolerance           The residual norm relative to the norm of
+//                          the right hand side including the boundary
+//                          terms, or of the initial residual if that is
+//                          larger, at which the iteration stops.
+//      maxIterations       The maximum number of iterations.
+//      iterations          The number of performed iterations.
+//
+// Return Value:
+//      bool                True, if the residual reached the tolerance.
+//
+bool multigridSolver::solve(std::vector<double> &values,
+                            double tolerance,
+                            unsigned int maxIterations,
+                            unsigned int &iterations) const
+{
+    unsigned int i;
+
+    iterations = 0;
+
+    if (coarseSolver.isEmpty() || values.size() != levels[0].size)
+        return false;
+
+    const level &finest = levels[0];
+    unsigned int numVertices = finest.size;
+
+    std::vector<double> residual(numVertices, 0.0);
+    std::vector<double> direction(numVertices, 0.0);
+    std::vector<double> preconditioned;
+    std::vector<double> product;
+    std::vector<double> boundary;
+
+    // The initial values are the starting guess. Because the fixed
+    // values are part of the vector the product already contains the
+    // boundary terms of the right hand side.
+    finest.system.multiply(values, product);
+
+    // The product of the fixed values alone gives the boundary terms
+    // which the stopping tolerance needs to include. Otherwise an
+    // influence which only has weights on the fixed vertices never
+    // converges.
+    for (i = 0; i < numVertices; i ++)
+        direction[i] = finest.active[i] ? 0.0 : values[i];
+    finest.system.multiply(direction, boundary);
+
+    double rhsNorm = 0.0;
+    double initialNorm = 0.0;
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (!finest.active[i])
+            continue;
+
+        double rhs = mass[i] * values[i];
+        rhsNorm += (rhs - boundary[i]) * (rhs - boundary[i]);
+
+        residual[i] = rhs - product[i];
+        initialNorm += residual[i] * residual[i];
+    }
+
+    cycle(0, residual, preconditioned);
+
+    double rz = 0.0;
+    for (i = 0; i < numVertices; i ++)
+    {
+        direction[i] = preconditioned[i];
+        rz += residual[i] * preconditioned[i];
+    }
+
+    double limit = std::max(tolerance * tolerance * std::max(rhsNorm, initialNorm),
+                            absoluteTolerance * absoluteTolerance);
+
+    for (iterations = 0; iterations < maxIterations; iterations ++)
+    {
+        double residualNorm = 0.0;
+        for (i = 0; i < numVertices; i ++)
+            residualNorm += residual[i] * residual[i];
+        if (residualNorm <= limit)
+            return true;
+        if (rz <= 0.0)
+            return false;
+
+        // The direction is zero at the fixed vertices, which restricts
+        // the product to the free block of the matrix.
+        finest.system.multiply(direction, product);
+
+        double pAp = 0.0;
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (finest.active[i])
+                pAp += direction[i] * product[i];
+        }
+        if (pAp <= 0.0)
+            return false;
+
+        double alpha = rz / pAp;
+        for (i = 0; i < numVertices; i ++)
+        {
+            if (!finest.active[i])
+                continue;
+
+            values[i] += alpha * direction[i];
+            residual[i] -= alpha * product[i];
+        }
+
+        cycle(0, residual, preconditioned);
+
+        double rzNext = 0.0;
+        for (i = 0; i < numVertices; i ++)
+            rzNext += residual[i] * preconditioned[i];
+
+        double beta = rzNext / rz;
+        rz = rzNext;
+        for (i = 0; i < numVertices; i ++)
+            direction[i] = preconditioned[i] + beta * direction[i];
+    }
+
+    // The iteration limit has been reached. The last update might
+    // still have met the tolerance.
+    double residualNorm = 0.0;
+    for (i = 0; i < numVertices; i ++)
+        residualNorm += residual[i] * residual[i];
+
+    return residualNorm <= limit;
+}
+
+
+unsigned int multigridSolver::levelCount() const
+{
+    return (unsigned int)levels.size();
+}
+
+
+unsigned int multigridSolver::levelSize(unsigned int level) const
+{
+    if (level >= levels.size())
+        return 0;
+    return levels[level].size;
+}
+
+
+// ---------------------------------------------------------------------
+// cycle
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Approximate the solution of the level system for the given
+//      right hand side with a symmetric V-cycle. The result is zero
+//      for all fixed vertices.
+//
+// Input Arguments:
+//      index               The index of the level.
+//      rhs                 The right hand side of the level.
+//      result              The approximated solution.
+//
+// Return Value:
+//      None
+//
+void multigridSolver::cycle(unsigned int index,
+                            const std::vector<double> &rhs,
+                            std::vector<double> &result) const
+{
+    unsigned int i;
+
+    const level &current = levels[index];
+
+    if (index + 1 == levels.size())
+    {
+        result = rhs;
+        std::vector<double> work;
+        coarseSolver.solve(result, work);
+        for (i = 0; i < current.size; i ++)
+        {
+            if (!current.active[i])
+                result[i] = 0.0;
+        }
+        return;
+    }
+
+    result = std::vector<double>(current.size, 0.0);
+
+    relax(current, rhs, result);
+    relax(current, rhs, result);
+
+    // Restrict the residual to the clusters.
+    const level &coarse = levels[index + 1];
+    std::vector<double> product;
+    current.system.multiply(result, product);
+
+    std::vector<double> coarseRhs(coarse.size, 0.0);
+    for (i = 0; i < current.size; i ++)
+    {
+        if (current.active[i])
+            coarseRhs[current.clusters[i]] += rhs[i] - product[i];
+    }
+
+    std::vector<double> correction;
+    cycle(index + 1, coarseRhs, correction);
+
+    // Prolongate the correction.
+    for (i = 0; i < current.size; i ++)
+    {
+        if (current.active[i])
+            result[i] += correction[current.clusters[i]];
+    }
+
+    relax(current, rhs, result);
+    relax(current, rhs, result);
+}
+
+
+//
+// Description:
+//      Perform one damped Jacobi pass for the free vertices of the
+//      level.
+//
+// Input Arguments:
+//      current             The level.
+//      rhs                 The right hand side of the level.
+//      result              The current solution which gets updated.
+//
+// Return Value:
+//      None
+//
+void multigridSolver::relax(const level &current,
+                            const std::vector<double> &rhs,
+                            std::vector<double> &result) const
+{
+    unsigned int i;
+
+    std::vector<double> product;
+    current.system.multiply(result, product);
+
+    for (i = 0; i < current.size; i ++)
+    {
+        if (current.active[i])
+            result[i] += RELAXATION * current.inverseDiagonal[i]
+                         * (rhs[i] - product[i]);
+    }
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,118 @@
+// ---------------------------------------------------------------------
+//
+//  multigridSolver.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__multigridSolver__
+#define __brSmoothWeights__multigridSolver__
+
+#include <vector>
+
+#include "meshLaplacian.h"
+#include "sparseMatrix.h"
+
+// ---------------------------------------------------------------------
+// The implicit diffusion (M + tL) w = M w0 solved with a multigrid
+// preconditioned conjugate gradient.
+//
+// The hierarchy is built once per mesh by clustering each vertex with
+// its direct neighbours, which reduces the vertex count by roughly a
+// factor of five per level. For each flood the operators of the
+// coarse levels are the sums of the finer operators over the clusters
+// and the coarsest level is factorized directly. Each iteration
+// smooths the residual from the finest to the coarsest level and
+// prolongates the corrections back to the mesh. Low-frequency errors,
+// which take many passes on the mesh, are removed on the coarse
+// levels, so the number of iterations barely grows with the mesh
+// density.
+//
+// As with the diffusionSolver the fixed vertices keep their values
+// and the solve can run in parallel for several functions. The
+// operators passed to setup() need to be the ones the hierarchy has
+// been created with.
+// ---------------------------------------------------------------------
+
+class multigridSolver
+{
+public:
+
+    multigridSolver();
+
+    void create(const meshLaplacian &operators);
+    void clear();
+    bool isEmpty() const;
+
+    bool setup(const meshLaplacian &operators,
+               double time,
+               const std::vector<bool> &fixed);
+
+    bool solve(std::vector<double> &values,
+               double tolerance,
+               unsigned int maxIterations,
+               unsigned int &iterations) const;
+
+    unsigned int levelCount() const;
+    unsigned int levelSize(unsigned int level) const;
+
+private:
+
+    struct level
+    {
+        unsigned int size;
+        std::vector<unsigned int> clusters; // The coarse vertex of each
+                                            // vertex of the level.
+        sparseMatrix system;                // The system matrix of the
+                                            // level.
+        std::vector<double> inverseDiagonal;
+        std::vector<bool> active;           // False for the fixed
+                                            // vertices.
+        std::vector<double> points;         // The xyz cluster centers.
+    };
+
+    std::vector<level> levels;
+    std::vector<double> mass;               // The lumped mass per
+                                            // vertex.
+    sparseLDLT coarseSolver;
+
+    void cycle(unsigned int index,
+               const std::vector<double> &rhs,
+               std::vector<double> &result) const;
+    void relax(const level &current,
+               const std::vector<double> &rhs,
+               std::vector<double> &result) const;
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
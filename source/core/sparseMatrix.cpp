@@ -0,0 +1,568 @@
+// ---------------------------------------------------------------------
+//
+//  sparseMatrix.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "sparseMatrix.h"
+
+#include <algorithm>
+
+
+// ---------------------------------------------------------------------
+// sparse matrix
+// ---------------------------------------------------------------------
+
+sparseMatrix::sparseMatrix()
+{
+    numRows = 0;
+}
+
+
+//
+// Description:
+//      Build the matrix from the given list of entries. Entries which
+//      share the same row and column are summed. The caller is
+//      responsible for providing a symmetric set of entries. A diagonal
+//      entry is created for every row, even if it's not part of the
+//      list.
+//
+// Input Arguments:
+//      size                The number of rows and columns.
+//      entries             The list of entries. The list gets sorted.
+//
+// Return Value:
+//      None
+//
+void sparseMatrix::create(unsigned int size, std::vector<sparseEntry> &entries)
+{
+    unsigned int i;
+
+    clear();
+
+    numRows = size;
+
+    // Make sure that each row has a diagonal entry.
+    for (i = 0; i < size; i ++)
+    {
+        sparseEntry entry = {i, i, 0.0};
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const sparseEntry &a, const sparseEntry &b)
+              {
+                  if (a.row != b.row)
+                      return a.row < b.row;
+                  return a.column < b.column;
+              });
+
+    offsets = std::vector<unsigned int>(size + 1, 0);
+    diagonals = std::vector<unsigned int>(size, 0);
+    columns.reserve(entries.size());
+    values.reserve(entries.size());
+
+    for (i = 0; i < entries.size(); i ++)
+    {
+        const sparseEntry &entry = entries[i];
+        if (i > 0 &&
+            entry.row == entries[i - 1].row &&
+            entry.column == entries[i - 1].column)
+        {
+            values.back() += entry.value;
+            continue;
+        }
+
+        if (entry.row == entry.column)
+            diagonals[entry.row] = (unsigned)columns.size();
+
+        columns.push_back(entry.column);
+        values.push_back(entry.value);
+        offsets[entry.row + 1] = (unsigned)columns.size();
+    }
+
+    // Rows without entries inherit the end of the previous row.
+    for (i = 0; i < size; i ++)
+    {
+        if (offsets[i + 1] < offsets[i])
+            offsets[i + 1] = offsets[i];
+    }
+}
+
+
+void sparseMatrix::clear()
+{
+    numRows = 0;
+    offsets.clear();
+    columns.clear();
+    values.clear();
+    diagonals.clear();
+}
+
+
+bool sparseMatrix::isEmpty() const
+{
+    return numRows == 0;
+}
+
+
+void sparseMatrix::scale(double factor)
+{
+    for (unsigned int i = 0; i < values.size(); i ++)
+        values[i] *= factor;
+}
+
+
+void sparseMatrix::addDiagonal(const std::vector<double> &values)
+{
+    for (unsigned int i = 0; i < numRows && i < values.size(); i ++)
+        this->values[diagonals[i]] += values[i];
+}
+
+
+//
+// Description:
+//      Compute the product y = A * x.
+//
+// Input Arguments:
+//      x                   The vector to multiply.
+//      y                   The result vector.
+//
+// Return Value:
+//      None
+//
+void sparseMatrix::multiply(const std::vector<double> &x,
+                            std::vector<double> &y) const
+{
+    y.resize(numRows);
+
+    for (unsigned int i = 0; i < numRows; i ++)
+    {
+        double sum = 0.0;
+        for (unsigned int j = offsets[i]; j < offsets[i + 1]; j ++)
+            sum += values[j] * x[columns[j]];
+        y[i] = sum;
+    }
+}
+
+
+// ---------------------------------------------------------------------
+// nested dissection ordering
+// ---------------------------------------------------------------------
+
+namespace
+{
+    // Leaf blocks smaller than this don't get split any further.
+    const unsigned int kDissectionLeafSize = 64;
+
+    struct dissectionData
+    {
+        const sparseMatrix *matrix;
+        const std::vector<double> *points;
+        std::vector<unsigned int> labels;
+        unsigned int nextLabel;
+        std::vector<unsigned int> *order;
+    };
+
+    void dissect(dissectionData &data, std::vector<unsigned int> &rows)
+    {
+        unsigned int i, j;
+
+        if (rows.size() <= kDissectionLeafSize)
+        {
+            data.order->insert(data.order->end(), rows.begin(), rows.end());
+            return;
+        }
+
+        const std::vector<double> &points = *data.points;
+
+        // Find the longest axis of the bounding box.
+        double minValue[3] = {points[rows[0] * 3],
+                              points[rows[0] * 3 + 1],
+                              points[rows[0] * 3 + 2]};
+        double maxValue[3] = {minValue[0], minValue[1], minValue[2]};
+        for (i = 1; i < rows.size(); i ++)
+        {
+            for (j = 0; j < 3; j ++)
+            {
+                double value = points[rows[i] * 3 + j];
+                minValue[j] = std::min(minValue[j], value);
+                maxValue[j] = std::max(maxValue[j], value);
+            }
+        }
+
+        unsigned int axis = 0;
+        for (j = 1; j < 3; j ++)
+        {
+            if (maxValue[j] - minValue[j] > maxValue[axis] - minValue[axis])
+                axis = j;
+        }
+
+        // Split the rows at the median.
+        size_t half = rows.size() / 2;
+        std::nth_element(rows.begin(), rows.begin() + (long)half, rows.end(),
+                         [&](unsigned int a, unsigned int b)
+                         { return points[a * 3 + axis] < points[b * 3 + axis]; });
+
+        unsigned int leftLabel = data.nextLabel ++;
+        unsigned int rightLabel = data.nextLabel ++;
+        for (i = 0; i < rows.size(); i ++)
+            data.labels[rows[i]] = i < half ? leftLabel : rightLabel;
+
+        // The separator are all rows of the left half which are
+        // connected to the right half.
+        std::vector<unsigned int> left;
+        std::vector<unsigned int> right(rows.begin() + (long)half, rows.end());
+        std::vector<unsigned int> separator;
+        left.reserve(half);
+
+        const sparseMatrix &matrix = *data.matrix;
+        for (i = 0; i < half; i ++)
+        {
+            unsigned int row = rows[i];
+            bool isSeparator = false;
+            for (j = matrix.rowStart(row); j < matrix.rowEnd(row); j ++)
+            {
+                if (data.labels[matrix.column(j)] == rightLabel)
+                {
+                    isSeparator = true;
+                    break;
+                }
+            }
+
+            if (isSeparator)
+                separator.push_back(row);
+            else
+                left.push_back(row);
+        }
+
+        // Release the memory of the current level before going deeper.
+        std::vector<unsigned int>().swap(rows);
+
+        dissect(data, left);
+        dissect(data, right);
+        data.order->insert(data.order->end(), separator.begin(), separator.end());
+    }
+}
+
+
+// ---------------------------------------------------------------------
+// sparse LDL^T factorization
+// ---------------------------------------------------------------------
+
+sparseLDLT::sparseLDLT()
+{
+    numRows = 0;
+}
+
+
+void sparseLDLT::clear()
+{
+    numRows = 0;
+    order.clear();
+    orderInv.clear();
+    factorStart.clear();
+    factorRows.clear();
+    factorValues.clear();
+    diagonal.clear();
+    buffer.clear();
+}
+
+
+bool sparseLDLT::isEmpty() const
+{
+    return numRows == 0;
+}
+
+
+unsigned int sparseLDLT::factorSize() const
+{
+    return (unsigned)factorValues.size();
+}
+
+
+//
+// Description:
+//      Compute the fill reducing elimination order. Without points the
+//      original order of the rows is used.
+//
+// Input Arguments:
+//      matrix              The matrix to factorize.
+//      points              The xyz positions of the rows.
+//
+// Return Value:
+//      None
+//
+void sparseLDLT::computeOrder(const sparseMatrix &matrix,
+                              const std::vector<double> &points)
+{
+    unsigned int i;
+
+    order.clear();
+    order.reserve(numRows);
+
+    if (points.size() == numRows * 3)
+    {
+        dissectionData data;
+        data.matrix = &matrix;
+        data.points = &points;
+        data.labels = std::vector<unsigned int>(numRows, 0);
+        data.nextLabel = 1;
+        data.order = &order;
+
+        std::vector<unsigned int> rows(numRows);
+        for (i = 0; i < numRows; i ++)
+            rows[i] = i;
+
+        dissect(data, rows);
+    }
+    else
+    {
+        for (i = 0; i < numRows; i ++)
+            order.push_back(i);
+    }
+
+    orderInv = std::vector<unsigned int>(numRows, 0);
+    for (i = 0; i < numRows; i ++)
+        orderInv[order[i]] = i;
+}
+
+
+//
+// Description:
+//      Compute the factorization P A P^T = L D L^T of the given
+//      symmetric positive definite matrix. The symbolic phase builds
+//      the elimination tree to get the number of entries per column of
+//      L, the numeric phase computes the rows of L with a sparse
+//      triangular solve each.
+//
+// Input Arguments:
+//      matrix              The matrix to factorize.
+//      points              The xyz positions of the rows which are used
+//                          for the ordering. Can be empty.
+//
+// Return Value:
+//      bool                True, if the factorization succeeded, false
+//                          if the matrix is not positive definite.
+//
+bool sparseLDLT::factorize(const sparseMatrix &matrix,
+                           const std::vector<double> &points)
+{
+    unsigned int i, k, p;
+
+    clear();
+
+    numRows = matrix.size();
+    if (numRows == 0)
+        return false;
+
+    computeOrder(matrix, points);
+
+    const unsigned int none = (unsigned)-1;
+
+    // -----------------------------------------------------------------
+    // symbolic factorization
+    // -----------------------------------------------------------------
+
+    std::vector<unsigned int> parent(numRows, none);
+    std::vector<unsigned int> flag(numRows, none);
+    std::vector<unsigned int> count(numRows, 0);
+
+    for (k = 0; k < numRows; k ++)
+    {
+        flag[k] = k;
+        unsigned int row = order[k];
+        for (p = matrix.rowStart(row); p < matrix.rowEnd(row); p ++)
+        {
+            i = orderInv[matrix.column(p)];
+            if (i >= k)
+                continue;
+
+            // Follow the path up the elimination tree until reaching a
+            // node which has already been visited for this row.
+            for (; flag[i] != k; i = parent[i])
+            {
+                if (parent[i] == none)
+                    parent[i] = k;
+                count[i] ++;
+                flag[i] = k;
+            }
+        }
+    }
+
+    factorStart = std::vector<unsigned int>(numRows + 1, 0);
+    for (k = 0; k < numRows; k ++)
+        factorStart[k + 1] = factorStart[k] + count[k];
+
+    factorRows = std::vector<unsigned int>(factorStart[numRows], 0);
+    factorValues = std::vector<double>(factorStart[numRows], 0.0);
+    diagonal = std::vector<double>(numRows, 0.0);
+
+    // -----------------------------------------------------------------
+    // numeric factorization
+    // -----------------------------------------------------------------
+
+    std::vector<double> y(numRows, 0.0);
+    std::vector<unsigned int> pattern(numRows, 0);
+    std::fill(count.begin(), count.end(), 0);
+
+    for (k = 0; k < numRows; k ++)
+    {
+        y[k] = 0.0;
+        unsigned int top = numRows;
+        flag[k] = k;
+
+        // Scatter the row k of the permuted matrix and collect the
+        // non-zero pattern of row k of L in topological order.
+        unsigned int row = order[k];
+        for (p = matrix.rowStart(row); p < matrix.rowEnd(row); p ++)
+        {
+            i = orderInv[matrix.column(p)];
+            if (i > k)
+                continue;
+
+            y[i] += matrix.value(p);
+
+            unsigned int length = 0;
+            for (; flag[i] != k; i = parent[i])
+            {
+                pattern[length ++] = i;
+                flag[i] = k;
+            }
+            while (length > 0)
+                pattern[-- top] = pattern[-- length];
+        }
+
+        diagonal[k] = y[k];
+        y[k] = 0.0;
+
+        for (; top < numRows; top ++)
+        {
+            i = pattern[top];
+            double yi = y[i];
+            y[i] = 0.0;
+
+            unsigned int end = factorStart[i] + count[i];
+            for (p = factorStart[i]; p < end; p ++)
+                y[factorRows[p]] -= factorValues[p] * yi;
+
+            double lki = yi / diagonal[i];
+            diagonal[k] -= lki * yi;
+            factorRows[end] = k;
+            factorValues[end] = lki;
+            count[i] ++;
+        }
+
+        if (diagonal[k] <= 0.0)
+        {
+            clear();
+            return false;
+        }
+    }
+
+    buffer = std::vector<double>(numRows, 0.0);
+
+    return true;
+}
+
+
+//
+// Description:
+//      Solve A x = b in place using the computed factorization.
+//
+// Input Arguments:
+//      values              The right hand side b which gets replaced
+//                          by the solution x.
+//
+// Return Value:
+//      None
+//
+void sparseLDLT::solve(std::vector<double> &values) const
+{
+    solve(values, buffer);
+}
+
+
+//
+// Description:
+//      Solve A x = b in place with a buffer owned by the caller, which
+//      allows to solve from several threads at the same time.
+//
+// Input Arguments:
+//      values              The right hand side b which gets replaced
+//                          by the solution x.
+//      work                The temporary storage for the permuted
+//                          values.
+//
+// Return Value:
+//      None
+//
+void sparseLDLT::solve(std::vector<double> &values,
+                       std::vector<double> &work) const
+{
+    unsigned int j, p;
+
+    if (numRows == 0 || values.size() != numRows)
+        return;
+
+    work.resize(numRows);
+
+    for (j = 0; j < numRows; j ++)
+        work[j] = values[order[j]];
+
+    // L y = b
+    for (j = 0; j < numRows; j ++)
+    {
+        double value = work[j];
+        for (p = factorStart[j]; p < factorStart[j + 1]; p ++)
+            work[factorRows[p]] -= factorValues[p] * value;
+    }
+
+    // D z = y
+    for (j = 0; j < numRows; j ++)
+        work[j] /= diagonal[j];
+
+    // L^T x = z
+    for (j = numRows; j > 0; j --)
+    {
+        double value = work[j - 1];
+        for (p = factorStart[j - 1]; p < factorStart[j]; p ++)
+            value -= factorValues[p] * work[factorRows[p]];
+        work[j - 1] = value;
+    }
+
+    for (j = 0; j < numRows; j ++)
+        values[order[j]] = work[j];
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,187 @@
+// ---------------------------------------------------------------------
+//
+//  sparseMatrix.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__sparseMatrix__
+#define __brSmoothWeights__sparseMatrix__
+
+#include <vector>
+
+// ---------------------------------------------------------------------
+// A symmetric square matrix in compressed row storage (CSR). Both
+// triangles and the diagonal are stored so that each row holds all
+// entries of the respective vertex. The column indices of each row are
+// sorted.
+// ---------------------------------------------------------------------
+
+struct sparseEntry
+{
+    unsigned int row;
+    unsigned int column;
+    double value;
+};
+
+
+class sparseMatrix
+{
+public:
+
+    sparseMatrix();
+
+    void create(unsigned int size, std::vector<sparseEntry> &entries);
+    void clear();
+    bool isEmpty() const;
+
+    unsigned int size() const;
+    unsigned int rowStart(unsigned int row) const;
+    unsigned int rowEnd(unsigned int row) const;
+    unsigned int column(unsigned int entry) const;
+    double value(unsigned int entry) const;
+    void setValue(unsigned int entry, double value);
+
+    double diagonal(unsigned int row) const;
+    void scale(double factor);
+    void addDiagonal(const std::vector<double> &values);
+
+    void multiply(const std::vector<double> &x, std::vector<double> &y) const;
+
+private:
+
+    unsigned int numRows;
+    std::vector<unsigned int> offsets;      // The start of each row.
+    std::vector<unsigned int> columns;      // The column of each entry.
+    std::vector<double> values;             // The value of each entry.
+    std::vector<unsigned int> diagonals;    // The entry of the diagonal
+                                            // for each row.
+};
+
+
+// ---------------------------------------------------------------------
+// The sparse LDL^T factorization of a symmetric positive definite
+// matrix. The factorization is computed once and can then be used to
+// solve for any number of right hand sides by a forward and a backward
+// substitution.
+//
+// To limit the fill-in of the factor the rows are reordered by a
+// geometric nested dissection. The vertex set is recursively split
+// along the longest axis of its bounding box and the vertices at the
+// cut are eliminated last.
+// ---------------------------------------------------------------------
+
+class sparseLDLT
+{
+public:
+
+    sparseLDLT();
+
+    bool factorize(const sparseMatrix &matrix,
+                   const std::vector<double> &points);
+    void clear();
+    bool isEmpty() const;
+
+    void solve(std::vector<double> &values) const;
+    void solve(std::vector<double> &values,
+               std::vector<double> &work) const;
+
+    unsigned int factorSize() const;
+
+private:
+
+    unsigned int numRows;
+    std::vector<unsigned int> order;        // The elimination order.
+    std::vector<unsigned int> orderInv;     // The position of each row
+                                            // in the elimination order.
+    std::vector<unsigned int> factorStart;  // The start of each column
+                                            // of L.
+    std::vector<unsigned int> factorRows;   // The row index of each
+                                            // entry of L.
+    std::vector<double> factorValues;       // The values of L.
+    std::vector<double> diagonal;           // The diagonal matrix D.
+
+    mutable std::vector<double> buffer;
+
+    void computeOrder(const sparseMatrix &matrix,
+                      const std::vector<double> &points);
+};
+
+
+// ---------------------------------------------------------------------
+// inline methods
+// ---------------------------------------------------------------------
+
+inline unsigned int sparseMatrix::size() const
+{
+    return numRows;
+}
+
+
+inline unsigned int sparseMatrix::rowStart(unsigned int row) const
+{
+    return offsets[row];
+}
+
+
+inline unsigned int sparseMatrix::rowEnd(unsigned int row) const
+{
+    return offsets[row + 1];
+}
+
+
+inline unsigned int sparseMatrix::column(unsigned int entry) const
+{
+    return columns[entry];
+}
+
+
+inline double sparseMatrix::value(unsigned int entry) const
+{
+    return values[entry];
+}
+
+
+inline void sparseMatrix::setValue(unsigned int entry, double value)
+{
+    values[entry] = value;
+}
+
+
+inline double sparseMatrix::diagonal(unsigned int row) const
+{
+    return values[diagonals[row]];
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
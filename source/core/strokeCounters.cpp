@@ -0,0 +1,126 @@
+// ---------------------------------------------------------------------
+//
+//  strokeCounters.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "strokeCounters.h"
+
+strokeCounters::strokeCounters()
+{
+    clear();
+}
+
+
+//
+// Description:
+//      Reset all counters. This must not be called while any thread is
+//      adding to the counters.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void strokeCounters::clear()
+{
+    for (unsigned int i = 0; i < kSlots; i ++)
+    {
+        for (unsigned int j = 0; j < kCounterCount; j ++)
+            slots[i].values[j].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+//
+// Description:
+//      Return the sum of the given counter over all threads.
+//
+// Input Arguments:
+//      index               The counter.
+//
+// Return Value:
+//      unsigned long long  The counter value.
+//
+unsigned long long strokeCounters::value(counter index) const
+{
+    unsigned long long result = 0;
+    for (unsigned int i = 0; i < kSlots; i ++)
+        result += slots[i].values[index].load(std::memory_order_relaxed);
+    return result;
+}
+
+
+//
+// Description:
+//      Return one line per counter with its name and value.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      std::vector         The report lines.
+//
+std::vector<std::string> strokeCounters::report() const
+{
+    std::vector<std::string> lines;
+
+    for (unsigned int i = 0; i < kCounterCount; i ++)
+    {
+        counter index = (counter)i;
+        lines.push_back(std::string(counterName(index)) + " " +
+                        std::to_string(value(index)));
+    }
+
+    return lines;
+}
+
+
+const char* strokeCounters::counterName(counter index)
+{
+    switch (index)
+    {
+        case kRangeVertices:    return "rangeVertices";
+        case kNeighbors:        return "neighbors";
+        case kIterators:        return "iterators";
+        case kSetWeightsCalls:  return "setWeightsCalls";
+        case kSetWeightsRows:   return "setWeightsRows";
+        case kArrays:           return "arrays";
+        case kSeamLookups:      return "seamLookups";
+        case kSeamScans:        return "seamScans";
+        default:                return "unknown";
+    }
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,127 @@
+// ---------------------------------------------------------------------
+//
+//  strokeCounters.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__strokeCounters__
+#define __brSmoothWeights__strokeCounters__
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------
+// Counters for the work done on the hot paths of a brush stroke, such
+// as the number of visited vertices, evaluated neighbours or Maya API
+// objects created per stroke. Compared to the vertex and influence
+// count of the mesh they show when a brush does super-linear work.
+//
+// The counters can be incremented from any thread. Each thread adds to
+// its own cache line, so that the counting in the parallel loops
+// doesn't cause contention. The counters are compiled in by default.
+// Defining BRSMOOTHWEIGHTS_NO_COUNTERS removes the counting.
+// ---------------------------------------------------------------------
+
+class strokeCounters
+{
+public:
+
+    enum counter
+    {
+        kRangeVertices,
+        kNeighbors,
+        kIterators,
+        kSetWeightsCalls,
+        kSetWeightsRows,
+        kArrays,
+        kSeamLookups,
+        kSeamScans,
+        kCounterCount
+    };
+
+    strokeCounters();
+
+    void clear();
+    void add(counter index, unsigned long long value = 1);
+
+    unsigned long long value(counter index) const;
+    std::vector<std::string> report() const;
+
+    static const char* counterName(counter index);
+
+private:
+
+    static const unsigned int kSlots = 64;
+
+    // The counters of the threads which share the slot. The padding
+    // to two cache lines keeps the counters of neighbouring slots on
+    // separate cache lines without requiring an aligned allocation of
+    // the owning context.
+    struct slot
+    {
+        std::atomic<unsigned long long> values[kCounterCount];
+        char padding[128 - kCounterCount * sizeof(unsigned long long)];
+    };
+
+    slot slots[kSlots];
+
+    static unsigned int threadSlot();
+};
+
+
+// ---------------------------------------------------------------------
+// inline methods
+// ---------------------------------------------------------------------
+
+inline void strokeCounters::add(counter index, unsigned long long value)
+{
+#ifndef BRSMOOTHWEIGHTS_NO_COUNTERS
+    slots[threadSlot()].values[index].fetch_add(value, std::memory_order_relaxed);
+#else
+    (void)index;
+    (void)value;
+#endif
+}
+
+
+inline unsigned int strokeCounters::threadSlot()
+{
+    static std::atomic<unsigned int> next(0);
+    thread_local unsigned int index = next ++ % kSlots;
+    return index;
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,262 @@
+// ---------------------------------------------------------------------
+//
+//  strokeStats.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "strokeStats.h"
+
+#include <cstdio>
+
+// ---------------------------------------------------------------------
+// strokeStats
+// ---------------------------------------------------------------------
+
+strokeStats::strokeStats() :
+    trace(nullptr)
+{
+    clear();
+}
+
+
+//
+// Description:
+//      Reset the statistics of all strokes and of the last stroke.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void strokeStats::clear()
+{
+    for (unsigned int i = 0; i < kStageCount; i ++)
+    {
+        running[i] = {0, 0.0, 0.0};
+        stroke[i] = {0, 0.0, 0.0};
+    }
+    strokes = 0;
+}
+
+
+//
+// Description:
+//      Start the statistics of a new stroke. The timings of the
+//      previous stroke are discarded but remain part of the running
+//      statistics.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void strokeStats::beginStroke()
+{
+    for (unsigned int i = 0; i < kStageCount; i ++)
+        stroke[i] = {0, 0.0, 0.0};
+    strokes ++;
+}
+
+
+//
+// Description:
+//      Add the duration of a single call to the given stage.
+//
+// Input Arguments:
+//      index               The stage.
+//      seconds             The duration of the call.
+//
+// Return Value:
+//      None
+//
+void strokeStats::add(stage index, double seconds)
+{
+    timing *timings[2] = {&running[index], &stroke[index]};
+    for (unsigned int i = 0; i < 2; i ++)
+    {
+        timings[i]->calls ++;
+        timings[i]->total += seconds;
+        if (seconds > timings[i]->max)
+            timings[i]->max = seconds;
+    }
+}
+
+
+//
+// Description:
+//      Add a single call to the given stage and record it as a span if
+//      the trace is enabled.
+//
+// Input Arguments:
+//      index               The stage.
+//      start               The begin time of the call.
+//      end                 The end time of the call.
+//
+// Return Value:
+//      None
+//
+void strokeStats::add(stage index,
+                      std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end)
+{
+    add(index, std::chrono::duration<double>(end - start).count());
+
+    if (trace)
+        trace->add(stageName(index), "stage", start, end);
+}
+
+
+//
+// Description:
+//      Set the trace which records the timed calls. Passing a null
+//      pointer stops recording.
+//
+// Input Arguments:
+//      value               The trace.
+//
+// Return Value:
+//      None
+//
+void strokeStats::setTrace(strokeTrace *value)
+{
+    trace = value;
+}
+
+
+unsigned int strokeStats::strokeCount() const
+{
+    return strokes;
+}
+
+
+//
+// Description:
+//      Return one line per stage with the running and the last stroke
+//      statistics. All durations are in milliseconds.
+//
+//      <stage> calls <n> total <ms> mean <ms> max <ms> |
+//      stroke calls <n> total <ms> max <ms>
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      std::vector         The report lines, starting with the number of
+//                          strokes.
+//
+std::vector<std::string> strokeStats::report() const
+{
+    std::vector<std::string> lines;
+
+    char line[256];
+    snprintf(line, sizeof(line), "strokes %u", strokes);
+    lines.push_back(line);
+
+    for (unsigned int i = 0; i < kStageCount; i ++)
+    {
+        const timing &all = running[i];
+        const timing &last = stroke[i];
+
+        double mean = all.calls ? all.total / all.calls : 0.0;
+
+        snprintf(line, sizeof(line),
+                 "%s calls %u total %.3f mean %.3f max %.3f | "
+                 "stroke calls %u total %.3f max %.3f",
+                 stageName((stage)i),
+                 all.calls, all.total * 1000.0, mean * 1000.0, all.max * 1000.0,
+                 last.calls, last.total * 1000.0, last.max * 1000.0);
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+
+const char* strokeStats::stageName(stage index)
+{
+    switch (index)
+    {
+        case kPress:        return "press";
+        case kClosestIndex: return "closestIndex";
+        case kRange:        return "range";
+        case kSeams:        return "seams";
+        case kCompute:      return "compute";
+        case kSetWeights:   return "setWeights";
+        case kRefresh:      return "refresh";
+        default:            return "unknown";
+    }
+}
+
+
+// ---------------------------------------------------------------------
+// scopedTimer
+// ---------------------------------------------------------------------
+
+scopedTimer::scopedTimer(strokeStats &stats, strokeStats::stage index) :
+    stats(stats),
+    index(index),
+    start(std::chrono::steady_clock::now()),
+    running(true)
+{
+}
+
+
+scopedTimer::~scopedTimer()
+{
+    stop();
+}
+
+
+//
+// Description:
+//      Add the elapsed time to the stage. Further calls and the
+//      destruction have no effect.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void scopedTimer::stop()
+{
+    if (!running)
+        return;
+
+    stats.add(index, start, std::chrono::steady_clock::now());
+    running = false;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
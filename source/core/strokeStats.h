@@ -0,0 +1,132 @@
+// ---------------------------------------------------------------------
+//
+//  strokeStats.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__strokeStats__
+#define __brSmoothWeights__strokeStats__
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "strokeTrace.h"
+
+// ---------------------------------------------------------------------
+// The timing statistics of the brush stages. Each stage collects the
+// number of calls, the total and the max duration, once for all strokes
+// since the tool has been activated and once for the last stroke only.
+//
+// The stages are timed with a scopedTimer on the main thread. The
+// compute stage covers the complete multi-threaded loop. The press
+// stage includes the closest index query of the press event. If a trace
+// is set, each timed call is also recorded as a trace span.
+// ---------------------------------------------------------------------
+
+class strokeStats
+{
+public:
+
+    enum stage
+    {
+        kPress,
+        kClosestIndex,
+        kRange,
+        kSeams,
+        kCompute,
+        kSetWeights,
+        kRefresh,
+        kStageCount
+    };
+
+    strokeStats();
+
+    void clear();
+    void beginStroke();
+    void add(stage index, double seconds);
+    void add(stage index,
+             std::chrono::steady_clock::time_point start,
+             std::chrono::steady_clock::time_point end);
+
+    void setTrace(strokeTrace *value);
+
+    unsigned int strokeCount() const;
+    std::vector<std::string> report() const;
+
+    static const char* stageName(stage index);
+
+private:
+
+    struct timing
+    {
+        unsigned int calls;
+        double total;                       // The summed duration in
+                                            // seconds.
+        double max;                         // The longest single call
+                                            // in seconds.
+    };
+
+    timing running[kStageCount];            // All strokes since the
+                                            // last clear().
+    timing stroke[kStageCount];             // The last stroke.
+    unsigned int strokes;
+    strokeTrace *trace;
+};
+
+
+// ---------------------------------------------------------------------
+// Measures the time from the construction to the destruction, or to
+// the call of stop(), and adds it to the given stage.
+// ---------------------------------------------------------------------
+
+class scopedTimer
+{
+public:
+
+    scopedTimer(strokeStats &stats, strokeStats::stage index);
+    ~scopedTimer();
+
+    void stop();
+
+private:
+
+    strokeStats &stats;
+    strokeStats::stage index;
+    std::chrono::steady_clock::time_point start;
+    bool running;
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
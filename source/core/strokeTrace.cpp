@@ -0,0 +1,230 @@
+// ---------------------------------------------------------------------
+//
+//  strokeTrace.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "strokeTrace.h"
+
+#include <cstdio>
+
+// The max number of recorded events. This limits the memory of a trace
+// which has been left enabled to about 40 MB.
+static const unsigned int kMaxEvents = 1000000;
+
+// ---------------------------------------------------------------------
+// strokeTrace
+// ---------------------------------------------------------------------
+
+strokeTrace::strokeTrace() :
+    enabled(false),
+    origin(clock::now()),
+    dropped(0)
+{
+}
+
+
+//
+// Description:
+//      Start or stop recording. Enabling the trace discards all
+//      previously recorded events.
+//
+// Input Arguments:
+//      value               True, if events should get recorded.
+//
+// Return Value:
+//      None
+//
+void strokeTrace::setEnabled(bool value)
+{
+    if (value && !enabled)
+        clear();
+    enabled = value;
+}
+
+
+bool strokeTrace::isEnabled() const
+{
+    return enabled;
+}
+
+
+//
+// Description:
+//      Discard all events and reset the time origin.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void strokeTrace::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+    dropped = 0;
+    origin = clock::now();
+}
+
+
+//
+// Description:
+//      Add a span to the trace. The span is assigned to the calling
+//      thread.
+//
+// Input Arguments:
+//      name                The name of the span.
+//      category            The category of the span.
+//      start               The begin time.
+//      end                 The end time.
+//
+// Return Value:
+//      None
+//
+void strokeTrace::add(const char *name,
+                      const char *category,
+                      clock::time_point start,
+                      clock::time_point end)
+{
+    if (!enabled)
+        return;
+
+    unsigned int thread = threadId();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (events.size() >= kMaxEvents)
+    {
+        dropped ++;
+        return;
+    }
+
+    event item;
+    item.name = name;
+    item.category = category;
+    item.start = std::chrono::duration<double, std::micro>(start - origin).count();
+    item.duration = std::chrono::duration<double, std::micro>(end - start).count();
+    item.thread = thread;
+    events.push_back(item);
+}
+
+
+unsigned int strokeTrace::eventCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (unsigned int)events.size();
+}
+
+
+//
+// Description:
+//      Write all events as complete events ("ph": "X") in the Chrome
+//      trace_event JSON format. The threads are numbered in the order
+//      they recorded their first event.
+//
+// Input Arguments:
+//      path                The file path of the JSON file.
+//
+// Return Value:
+//      bool                True, if the file has been written.
+//
+bool strokeTrace::write(const std::string &path) const
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\",\n");
+    fprintf(file, " \"otherData\": {\"droppedEvents\": %u},\n", dropped);
+    fprintf(file, " \"traceEvents\": [\n");
+
+    for (size_t i = 0; i < events.size(); i ++)
+    {
+        const event &item = events[i];
+        fprintf(file,
+                "  {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+                "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u}%s\n",
+                item.name, item.category, item.start, item.duration,
+                item.thread, i + 1 < events.size() ? "," : "");
+    }
+
+    fprintf(file, " ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+
+//
+// Description:
+//      Return a small number identifying the calling thread. The number
+//      is assigned when the thread calls the method for the first time.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      unsigned int        The thread number.
+//
+unsigned int strokeTrace::threadId()
+{
+    static std::atomic<unsigned int> next(0);
+    thread_local unsigned int id = next ++;
+    return id;
+}
+
+
+// ---------------------------------------------------------------------
+// traceSpan
+// ---------------------------------------------------------------------
+
+traceSpan::traceSpan(strokeTrace &trace, const char *name, const char *category) :
+    trace(trace),
+    name(name),
+    category(category),
+    active(trace.isEnabled())
+{
+    if (active)
+        start = strokeTrace::clock::now();
+}
+
+
+traceSpan::~traceSpan()
+{
+    if (active)
+        trace.add(name, category, start, strokeTrace::clock::now());
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
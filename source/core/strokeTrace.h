@@ -0,0 +1,126 @@
+// ---------------------------------------------------------------------
+//
+//  strokeTrace.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__strokeTrace__
+#define __brSmoothWeights__strokeTrace__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------
+// An opt-in recorder for the timeline of brush strokes. Each event is
+// a span with a begin and end time on the thread it has been recorded
+// on. The events can be written as a Chrome trace_event JSON file which
+// can be opened in Perfetto or chrome://tracing.
+//
+// Events can be added from any thread. Nothing gets recorded while the
+// trace is disabled, which only costs a flag test per span. The event
+// names and categories are not copied and need to be string literals.
+// ---------------------------------------------------------------------
+
+class strokeTrace
+{
+public:
+
+    typedef std::chrono::steady_clock clock;
+
+    strokeTrace();
+
+    void setEnabled(bool value);
+    bool isEnabled() const;
+
+    void clear();
+    void add(const char *name,
+             const char *category,
+             clock::time_point start,
+             clock::time_point end);
+
+    unsigned int eventCount() const;
+    bool write(const std::string &path) const;
+
+private:
+
+    struct event
+    {
+        const char *name;
+        const char *category;
+        double start;                       // The begin time in
+                                            // microseconds since the
+                                            // origin.
+        double duration;                    // In microseconds.
+        unsigned int thread;
+    };
+
+    std::atomic<bool> enabled;
+    clock::time_point origin;               // The time of the last
+                                            // clear().
+    std::vector<event> events;
+    unsigned int dropped;                   // The number of events
+                                            // exceeding the max event
+                                            // count.
+    mutable std::mutex mutex;
+
+    static unsigned int threadId();
+};
+
+
+// ---------------------------------------------------------------------
+// Records a span from the construction to the destruction if the trace
+// is enabled at the time of the construction.
+// ---------------------------------------------------------------------
+
+class traceSpan
+{
+public:
+
+    traceSpan(strokeTrace &trace, const char *name, const char *category);
+    ~traceSpan();
+
+private:
+
+    strokeTrace &trace;
+    const char *name;
+    const char *category;
+    bool active;
+    strokeTrace::clock::time_point start;
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
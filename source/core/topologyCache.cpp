@@ -0,0 +1,253 @@
+// ---------------------------------------------------------------------
+//
+//  topologyCache.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "topologyCache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "weightCache.h"
+
+// The identifier at the start of the file. The version gets raised
+// when the layout changes so that older files are ignored.
+static const char kMagic[8] = {'b', 'r', 'T', 'o', 'p', 'o', 'l', 'o'};
+static const unsigned int kVersion = 1;
+
+// The layout of the header at the start of the file.
+struct topologyHeader
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int vertexCount;
+    unsigned int neighborCount;
+    unsigned int pairCount;
+    unsigned long long hash;
+    double tolerance;
+};
+
+// ---------------------------------------------------------------------
+// topologyCache
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Return the hash of the polygon connectivity of the mesh.
+//
+// Input Arguments:
+//      numVertices         The number of mesh vertices.
+//      polyCounts          The number of vertices for each polygon.
+//      polyVertices        The vertex indices of all polygons.
+//
+// Return Value:
+//      unsigned long long  The connectivity hash.
+//
+unsigned long long topologyCache::connectivityHash(unsigned int numVertices,
+                                                   const std::vector<int> &polyCounts,
+                                                   const std::vector<int> &polyVertices)
+{
+    unsigned long long hash = weightCache::hashBytes(&numVertices, sizeof(numVertices), 0);
+    hash = weightCache::hashBytes(polyCounts.data(), polyCounts.size() * sizeof(int), hash);
+    hash = weightCache::hashBytes(polyVertices.data(), polyVertices.size() * sizeof(int), hash);
+    return hash;
+}
+
+
+//
+// Description:
+//      Write the adjacency, the border flags and the opposite vertex
+//      pairs to a new cache file. The file is written to a temporary
+//      file first, which replaces the existing file when complete.
+//
+// Input Arguments:
+//      path                The path of the cache file.
+//      hash                The connectivity hash of the mesh.
+//      topology            The vertex adjacency of the mesh.
+//      tolerance           The tolerance the pairs have been found
+//                          with.
+//      pairs               The pairs of the computed border vertex and
+//                          its opposite vertex.
+//
+// Return Value:
+//      bool                True, if the file has been written.
+//
+bool topologyCache::write(const std::string &path,
+                          unsigned long long hash,
+                          const meshTopology &topology,
+                          double tolerance,
+                          const std::vector<int> &pairs)
+{
+    unsigned int i;
+
+    unsigned int numVertices = topology.vertexCount();
+    if (topology.isEmpty())
+        return false;
+
+    topologyHeader head;
+    memset(&head, 0, sizeof(topologyHeader));
+    memcpy(head.magic, kMagic, sizeof(kMagic));
+    head.version = kVersion;
+    head.vertexCount = numVertices;
+    head.neighborCount = topology.neighborCount();
+    head.pairCount = (unsigned)pairs.size() / 2;
+    head.hash = hash;
+    head.tolerance = tolerance;
+
+    std::vector<unsigned int> offsets(numVertices + 1);
+    std::vector<unsigned int> neighbors(head.neighborCount);
+    std::vector<unsigned char> boundary(numVertices);
+    for (i = 0; i < numVertices; i ++)
+    {
+        offsets[i] = topology.rowStart(i);
+        boundary[i] = topology.onBoundary(i) ? 1 : 0;
+    }
+    offsets[numVertices] = head.neighborCount;
+    for (i = 0; i < head.neighborCount; i ++)
+        neighbors[i] = topology.neighbor(i);
+
+    std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (file == NULL)
+        return false;
+
+    bool result = true;
+    result &= fwrite(&head, sizeof(topologyHeader), 1, file) == 1;
+    result &= fwrite(offsets.data(), sizeof(unsigned int), offsets.size(), file) == offsets.size();
+    result &= fwrite(neighbors.data(), sizeof(unsigned int), neighbors.size(), file) == neighbors.size();
+    result &= fwrite(boundary.data(), 1, boundary.size(), file) == boundary.size();
+    result &= fwrite(pairs.data(), sizeof(int), head.pairCount * 2, file) == head.pairCount * 2;
+    result &= fclose(file) == 0;
+
+    if (!result)
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // Windows doesn't replace an existing file when renaming.
+    remove(path.c_str());
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+
+//
+// Description:
+//      Read the adjacency, the border flags and the opposite vertex
+//      pairs from the given cache file. The data is only used if the
+//      file belongs to the given connectivity hash and all indices are
+//      in range.
+//
+// Input Arguments:
+//      path                The path of the cache file.
+//      hash                The connectivity hash of the mesh.
+//      numVertices         The number of mesh vertices.
+//      topology            The vertex adjacency to fill.
+//      tolerance           The tolerance the pairs have been found
+//                          with.
+//      pairs               The pairs of the computed border vertex and
+//                          its opposite vertex.
+//
+// Return Value:
+//      bool                True, if the cache is valid.
+//
+bool topologyCache::read(const std::string &path,
+                         unsigned long long hash,
+                         unsigned int numVertices,
+                         meshTopology &topology,
+                         double &tolerance,
+                         std::vector<int> &pairs)
+{
+    unsigned int i;
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+
+    topologyHeader head;
+    if (fread(&head, sizeof(topologyHeader), 1, file) != 1 ||
+        memcmp(head.magic, kMagic, sizeof(kMagic)) != 0 ||
+        head.version != kVersion ||
+        head.hash != hash ||
+        head.vertexCount != numVertices)
+    {
+        fclose(file);
+        return false;
+    }
+
+    std::vector<unsigned int> offsets(numVertices + 1);
+    std::vector<unsigned int> neighbors(head.neighborCount);
+    std::vector<unsigned char> boundary(numVertices);
+    std::vector<int> values(head.pairCount * 2);
+
+    bool result = true;
+    result &= fread(offsets.data(), sizeof(unsigned int), offsets.size(), file) == offsets.size();
+    result &= fread(neighbors.data(), sizeof(unsigned int), neighbors.size(), file) == neighbors.size();
+    result &= fread(boundary.data(), 1, boundary.size(), file) == boundary.size();
+    result &= fread(values.data(), sizeof(int), values.size(), file) == values.size();
+    // The file has to end after the last pair.
+    result &= fgetc(file) == EOF;
+    fclose(file);
+
+    if (!result || offsets[0] != 0 || offsets[numVertices] != head.neighborCount)
+        return false;
+
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (offsets[i + 1] < offsets[i])
+            return false;
+    }
+    for (i = 0; i < head.neighborCount; i ++)
+    {
+        if (neighbors[i] >= numVertices)
+            return false;
+    }
+    for (i = 0; i < values.size(); i ++)
+    {
+        if (values[i] < 0 || (unsigned)values[i] >= numVertices)
+            return false;
+    }
+
+    std::vector<bool> flags(numVertices);
+    for (i = 0; i < numVertices; i ++)
+        flags[i] = boundary[i] != 0;
+
+    topology.assign(numVertices, offsets, neighbors, flags);
+    tolerance = head.tolerance;
+    pairs.swap(values);
+
+    return true;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,80 @@
+// ---------------------------------------------------------------------
+//
+//  topologyCache.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__topologyCache__
+#define __brSmoothWeights__topologyCache__
+
+#include <string>
+#include <vector>
+
+#include "meshTopology.h"
+
+// ---------------------------------------------------------------------
+// The binary file which stores the data of a mesh which only depends on
+// the polygon connectivity: the vertex adjacency, the border flags and
+// the pairs of opposite border vertices which keep the shells together.
+//
+// The file is identified by the hash of the connectivity instead of the
+// mesh name. Therefore the data can be shared by all meshes with the
+// same topology, such as the variants of a crowd character. The
+// opposite vertices are found within the tolerance of the tool, which
+// is stored with the pairs.
+// ---------------------------------------------------------------------
+
+class topologyCache
+{
+public:
+
+    static unsigned long long connectivityHash(unsigned int numVertices,
+                                               const std::vector<int> &polyCounts,
+                                               const std::vector<int> &polyVertices);
+
+    static bool write(const std::string &path,
+                      unsigned long long hash,
+                      const meshTopology &topology,
+                      double tolerance,
+                      const std::vector<int> &pairs);
+    static bool read(const std::string &path,
+                     unsigned long long hash,
+                     unsigned int numVertices,
+                     meshTopology &topology,
+                     double &tolerance,
+                     std::vector<int> &pairs);
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,543 @@
+// ---------------------------------------------------------------------
+//
+//  weightCache.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "weightCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// The identifier at the start of the file. The version gets raised
+// when the layout changes so that older files are ignored.
+static const char kMagic[8] = {'b', 'r', 'W', 'e', 'i', 'g', 'h', 't'};
+static const unsigned int kVersion = 1;
+
+// The FNV-1a offset basis for starting a new hash.
+static const unsigned long long kHashBasis = 14695981039346656037ULL;
+static const unsigned long long kHashPrime = 1099511628211ULL;
+
+// ---------------------------------------------------------------------
+// weightCache
+// ---------------------------------------------------------------------
+
+weightCache::weightCache() :
+    data(NULL),
+    size(0),
+#ifdef _WIN32
+    fileHandle(NULL),
+    mapHandle(NULL),
+#endif
+    fileHeader(NULL),
+    names(NULL),
+    offsets(NULL),
+    indices(NULL),
+    values(NULL)
+{
+}
+
+
+weightCache::~weightCache()
+{
+    close();
+}
+
+
+//
+// Description:
+//      Write the given weights of all vertices to a new cache file. The
+//      file is written to a temporary file first, which replaces the
+//      existing file when complete. This makes sure that an interrupted
+//      write doesn't leave a broken cache.
+//
+// Input Arguments:
+//      path                The path of the cache file.
+//      name                The name of the skin cluster.
+//      key                 The key of the scene state.
+//      influences          The names of the influences in the order of
+//                          the weights.
+//      weights             The weights of all vertices, with one value
+//                          for each influence per vertex.
+//      vertexCount         The number of vertices.
+//
+// Return Value:
+//      bool                True, if the file has been written.
+//
+bool weightCache::write(const std::string &path,
+                        const std::string &name,
+                        unsigned long long key,
+                        const std::vector<std::string> &influences,
+                        const double *weights,
+                        unsigned int vertexCount)
+{
+    unsigned int i, j;
+
+    unsigned int influenceCount = (unsigned)influences.size();
+
+    // Collect the non-zero weights of each vertex.
+    std::vector<unsigned long long> rowOffsets(vertexCount + 1);
+    std::vector<unsigned int> rowIndices;
+    std::vector<double> rowValues;
+    rowIndices.reserve(vertexCount * 4);
+    rowValues.reserve(vertexCount * 4);
+
+    for (i = 0; i < vertexCount; i ++)
+    {
+        rowOffsets[i] = rowValues.size();
+        for (j = 0; j < influenceCount; j ++)
+        {
+            double value = weights[i * influenceCount + j];
+            if (value != 0.0)
+            {
+                rowIndices.push_back(j);
+                rowValues.push_back(value);
+            }
+        }
+    }
+    rowOffsets[vertexCount] = rowValues.size();
+
+    std::string nameTable;
+    for (i = 0; i < influenceCount; i ++)
+    {
+        nameTable += influences[i];
+        nameTable.push_back('\0');
+    }
+
+    header head;
+    memset(&head, 0, sizeof(header));
+    memcpy(head.magic, kMagic, sizeof(kMagic));
+    head.version = kVersion;
+    head.vertexCount = vertexCount;
+    head.influenceCount = influenceCount;
+    head.nameSize = (unsigned)name.size();
+    head.namesSize = nameTable.size();
+    head.entryCount = rowValues.size();
+    head.key = key;
+
+    unsigned long long hash = kHashBasis;
+    hash = hashBytes(rowOffsets.data(), rowOffsets.size() * sizeof(unsigned long long), hash);
+    hash = hashBytes(rowIndices.data(), rowIndices.size() * sizeof(unsigned int), hash);
+    hash = hashBytes(rowValues.data(), rowValues.size() * sizeof(double), hash);
+    head.weightsHash = hash;
+
+    std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (file == NULL)
+        return false;
+
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    bool result = true;
+    result &= fwrite(&head, sizeof(header), 1, file) == 1;
+    result &= fwrite(name.data(), 1, name.size(), file) == name.size();
+    result &= fwrite(zeros, 1, padded(name.size()) - name.size(), file) == padded(name.size()) - name.size();
+    result &= fwrite(nameTable.data(), 1, nameTable.size(), file) == nameTable.size();
+    result &= fwrite(zeros, 1, padded(nameTable.size()) - nameTable.size(), file) == padded(nameTable.size()) - nameTable.size();
+    result &= fwrite(rowOffsets.data(), sizeof(unsigned long long), rowOffsets.size(), file) == rowOffsets.size();
+    result &= fwrite(rowIndices.data(), sizeof(unsigned int), rowIndices.size(), file) == rowIndices.size();
+    size_t indexSize = rowIndices.size() * sizeof(unsigned int);
+    result &= fwrite(zeros, 1, padded(indexSize) - indexSize, file) == padded(indexSize) - indexSize;
+    result &= fwrite(rowValues.data(), sizeof(double), rowValues.size(), file) == rowValues.size();
+    result &= fclose(file) == 0;
+
+    if (!result)
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // Windows doesn't replace an existing file when renaming.
+    remove(path.c_str());
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+
+//
+// Description:
+//      Map the given cache file into memory and validate the layout.
+//      The data of the file is accessed directly from the mapped
+//      memory until the cache gets closed.
+//
+// Input Arguments:
+//      path                The path of the cache file.
+//
+// Return Value:
+//      bool                True, if the file is a valid cache.
+//
+bool weightCache::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(header))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mapHandle = mapping;
+    data = (const char*)view;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size < (off_t)sizeof(header))
+    {
+        ::close(file);
+        return false;
+    }
+
+    void *view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping stays valid after closing the file.
+    ::close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    data = (const char*)view;
+    size = (size_t)info.st_size;
+#endif
+
+    fileHeader = (const header*)data;
+    if (memcmp(fileHeader->magic, kMagic, sizeof(kMagic)) != 0 ||
+        fileHeader->version != kVersion)
+    {
+        close();
+        return false;
+    }
+
+    // Make sure that the size of the file matches the sections which
+    // are defined in the header.
+    size_t nameOffset = sizeof(header);
+    size_t namesOffset = nameOffset + padded(fileHeader->nameSize);
+    size_t offsetsOffset = namesOffset + padded((size_t)fileHeader->namesSize);
+    size_t indicesOffset = offsetsOffset + ((size_t)fileHeader->vertexCount + 1) * sizeof(unsigned long long);
+    size_t valuesOffset = indicesOffset + padded((size_t)fileHeader->entryCount * sizeof(unsigned int));
+    size_t endOffset = valuesOffset + (size_t)fileHeader->entryCount * sizeof(double);
+    if (endOffset != size)
+    {
+        close();
+        return false;
+    }
+
+    names = data + namesOffset;
+    offsets = (const unsigned long long*)(data + offsetsOffset);
+    indices = (const unsigned int*)(data + indicesOffset);
+    values = (const double*)(data + valuesOffset);
+
+    return true;
+}
+
+
+//
+// Description:
+//      Release the mapped file.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void weightCache::close()
+{
+    if (data == NULL)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mapHandle);
+    CloseHandle((HANDLE)fileHandle);
+    fileHandle = NULL;
+    mapHandle = NULL;
+#else
+    munmap((void*)data, size);
+#endif
+
+    data = NULL;
+    size = 0;
+    fileHeader = NULL;
+    names = NULL;
+    offsets = NULL;
+    indices = NULL;
+    values = NULL;
+}
+
+
+bool weightCache::isOpen() const
+{
+    return data != NULL;
+}
+
+
+unsigned long long weightCache::key() const
+{
+    return fileHeader->key;
+}
+
+
+std::string weightCache::name() const
+{
+    return std::string(data + sizeof(header), fileHeader->nameSize);
+}
+
+
+unsigned int weightCache::vertexCount() const
+{
+    return fileHeader->vertexCount;
+}
+
+
+unsigned int weightCache::influenceCount() const
+{
+    return fileHeader->influenceCount;
+}
+
+
+//
+// Description:
+//      Return the name of the influence with the given index by
+//      walking the table of null-terminated names.
+//
+// Input Arguments:
+//      index               The index of the influence.
+//
+// Return Value:
+//      string              The name of the influence or an empty
+//                          string if the index is out of range.
+//
+std::string weightCache::influenceName(unsigned int index) const
+{
+    const char *current = names;
+    const char *end = names + fileHeader->namesSize;
+
+    for (unsigned int i = 0; current < end; i ++)
+    {
+        size_t length = strnlen(current, (size_t)(end - current));
+        if (i == index)
+            return std::string(current, length);
+        current += length + 1;
+    }
+
+    return std::string();
+}
+
+
+unsigned long long weightCache::entryCount() const
+{
+    return fileHeader->entryCount;
+}
+
+
+unsigned long long weightCache::rowStart(unsigned int vertex) const
+{
+    return offsets[vertex];
+}
+
+
+unsigned long long weightCache::rowEnd(unsigned int vertex) const
+{
+    return offsets[vertex + 1];
+}
+
+
+unsigned int weightCache::influence(unsigned long long entry) const
+{
+    return indices[entry];
+}
+
+
+double weightCache::weight(unsigned long long entry) const
+{
+    return values[entry];
+}
+
+
+//
+// Description:
+//      Write the stored weights to the given array, which holds the
+//      values of all influences for each vertex. The hash of the stored
+//      data gets compared on the fly so that a damaged file is
+//      rejected.
+//
+// Input Arguments:
+//      weights             The array for all weights, which needs to
+//                          have the size of the vertex count times the
+//                          influence count.
+//
+// Return Value:
+//      bool                True, if the weights are valid.
+//
+bool weightCache::expand(double *weights) const
+{
+    unsigned int i;
+
+    unsigned int vertices = fileHeader->vertexCount;
+    unsigned int influences = fileHeader->influenceCount;
+    unsigned long long entries = fileHeader->entryCount;
+
+    if (offsets[0] != 0 || offsets[vertices] != entries)
+        return false;
+
+    memset(weights, 0, (size_t)vertices * influences * sizeof(double));
+
+    for (i = 0; i < vertices; i ++)
+    {
+        unsigned long long start = offsets[i];
+        unsigned long long end = offsets[i + 1];
+        if (end < start || end > entries)
+            return false;
+
+        double *row = weights + (size_t)i * influences;
+        for (unsigned long long j = start; j < end; j ++)
+        {
+            if (indices[j] >= influences)
+                return false;
+            row[indices[j]] = values[j];
+        }
+    }
+
+    unsigned long long hash = kHashBasis;
+    hash = hashBytes(offsets, ((size_t)vertices + 1) * sizeof(unsigned long long), hash);
+    hash = hashBytes(indices, (size_t)entries * sizeof(unsigned int), hash);
+    hash = hashBytes(values, (size_t)entries * sizeof(double), hash);
+
+    return hash == fileHeader->weightsHash;
+}
+
+
+//
+// Description:
+//      Continue the FNV-1a hash of the given data.
+//
+// Input Arguments:
+//      data                The data to hash.
+//      size                The size of the data in bytes.
+//      hash                The current hash value or 0 for starting
+//                          a new hash.
+//
+// Return Value:
+//      unsigned long long  The new hash value.
+//
+unsigned long long weightCache::hashBytes(const void *data,
+                                          size_t size,
+                                          unsigned long long hash)
+{
+    if (hash == 0)
+        hash = kHashBasis;
+
+    const unsigned char *bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i ++)
+    {
+        hash ^= bytes[i];
+        hash *= kHashPrime;
+    }
+    return hash;
+}
+
+
+//
+// Description:
+//      Add the path, size and modification time of the given file to
+//      the hash. This identifies the saved state of a file without
+//      reading it.
+//
+// Input Arguments:
+//      path                The path of the file.
+//      hash                The current hash value or 0 for starting
+//                          a new hash.
+//
+// Return Value:
+//      unsigned long long  The new hash value or 0, if the file doesn't
+//                          exist.
+//
+unsigned long long weightCache::fileStamp(const std::string &path,
+                                          unsigned long long hash)
+{
+    struct stat info;
+    if (path.empty() || stat(path.c_str(), &info) != 0)
+        return 0;
+
+    if (hash == 0)
+        hash = kHashBasis;
+
+    long long fileSize = (long long)info.st_size;
+    long long fileTime = (long long)info.st_mtime;
+    hash = hashBytes(path.data(), path.size(), hash);
+    hash = hashBytes(&fileSize, sizeof(fileSize), hash);
+    hash = hashBytes(&fileTime, sizeof(fileTime), hash);
+
+    return hash;
+}
+
+
+size_t weightCache::padded(size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,135 @@
+// ---------------------------------------------------------------------
+//
+//  weightCache.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__weightCache__
+#define __brSmoothWeights__weightCache__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------
+// The binary file which stores the skin weights of a mesh so that they
+// don't need to be read from the skin cluster again when the scene
+// gets reopened.
+//
+// The weights are stored sparse, i.e. only the non-zero weights of each
+// vertex are written together with their influence index. The file
+// consists of a fixed header followed by the skin cluster name, the
+// influence names, the row offsets per vertex, the influence indices
+// and the weight values. All sections are aligned to eight bytes so
+// that the mapped file can be accessed directly without copying.
+//
+// The key identifies the state of the scene the weights belong to and
+// is provided by the caller. The hash of the weights is stored for
+// checking the integrity of the file when the weights get expanded.
+// ---------------------------------------------------------------------
+
+class weightCache
+{
+public:
+
+    weightCache();
+    ~weightCache();
+
+    static bool write(const std::string &path,
+                      const std::string &name,
+                      unsigned long long key,
+                      const std::vector<std::string> &influences,
+                      const double *weights,
+                      unsigned int vertexCount);
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const;
+
+    unsigned long long key() const;
+    std::string name() const;
+    unsigned int vertexCount() const;
+    unsigned int influenceCount() const;
+    std::string influenceName(unsigned int index) const;
+    unsigned long long entryCount() const;
+
+    unsigned long long rowStart(unsigned int vertex) const;
+    unsigned long long rowEnd(unsigned int vertex) const;
+    unsigned int influence(unsigned long long entry) const;
+    double weight(unsigned long long entry) const;
+
+    bool expand(double *weights) const;
+
+    static unsigned long long hashBytes(const void *data,
+                                       size_t size,
+                                       unsigned long long hash);
+    static unsigned long long fileStamp(const std::string &path,
+                                        unsigned long long hash);
+
+private:
+
+    // The layout of the header at the start of the file.
+    struct header
+    {
+        char magic[8];
+        unsigned int version;
+        unsigned int vertexCount;
+        unsigned int influenceCount;
+        unsigned int nameSize;          // The size of the skin cluster
+                                        // name without padding.
+        unsigned long long namesSize;   // The size of the influence
+                                        // names without padding.
+        unsigned long long entryCount;  // The number of stored weights.
+        unsigned long long weightsHash;
+        unsigned long long key;
+    };
+
+    static size_t padded(size_t size);
+
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mapHandle;
+#endif
+
+    const header *fileHeader;
+    const char *names;
+    const unsigned long long *offsets;
+    const unsigned int *indices;
+    const double *values;
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
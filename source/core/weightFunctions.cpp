@@ -0,0 +1,312 @@
+// ---------------------------------------------------------------------
+//
+//  weightFunctions.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "weightFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+
+//
+// Description:
+//      Calculate the brush weight value based on the given linear
+//      falloff value.
+//
+// Input Arguments:
+//      curve               The brush curve: 0 none, 1 linear, 2 smooth
+//                          and 3 narrow.
+//      value               The linear falloff value.
+//      strength            The brush strength value.
+//
+// Return Value:
+//      double              The brush curve-based falloff value.
+//
+double falloffValue(int curve, double value, double strength)
+{
+    if (curve == 0)
+        return 1.0 * strength;
+    // linear
+    else if (curve == 1)
+        return value * strength;
+    // smoothstep
+    else if (curve == 2)
+        return (value * value * (3 - 2 * value)) * strength;
+    // narrow - quadratic
+    else if (curve == 3)
+        return (1 - pow((1 - value) / 1, 0.4)) * strength;
+    else
+        return value;
+}
+
+
+//
+// Description:
+//      Discard the smallest unlocked weights so that the vertex doesn't
+//      have more than the max number of influences. Locked influences
+//      keep their weights but count towards the max influences. This
+//      includes the locked influences which are not part of the given
+//      list.
+//
+// Input Arguments:
+//      values              The weights of the listed influences.
+//      influences          The influence index of each weight.
+//      count               The number of weights.
+//      locks               The lock state of all influences.
+//      lockedCount         The number of all locked influences.
+//      maxInfluences       The max number of influences per vertex.
+//      order               The buffer for sorting the weights.
+//
+// Return Value:
+//      None
+//
+void limitInfluences(double *values,
+                     const unsigned int *influences,
+                     unsigned int count,
+                     const std::vector<bool> &locks,
+                     unsigned int lockedCount,
+                     unsigned int maxInfluences,
+                     std::vector<unsigned int> &order)
+{
+    unsigned int i;
+
+    bool hasLocks = !locks.empty();
+
+    // Sort with a stable order so that equal weights are discarded in
+    // the order of the influence indices.
+    order.resize(count);
+    for (i = 0; i < count; i ++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](unsigned int a, unsigned int b)
+                     { return values[a] < values[b]; });
+
+    unsigned int listLocked = 0;
+    if (hasLocks)
+    {
+        for (i = 0; i < count; i ++)
+        {
+            if (locks[influences[i]])
+                listLocked ++;
+        }
+    }
+
+    // The influences which are not listed are zero and would be first
+    // in the sorted list of all influences. The locked ones among them
+    // still raise the limit.
+    int limit = (int)count - (int)maxInfluences + (int)(lockedCount - listLocked);
+
+    for (i = 0; i < count; i ++)
+    {
+        unsigned int element = order[i];
+        bool locked = hasLocks && locks[influences[element]];
+
+        if ((int)i < limit && !locked)
+            values[element] = 0.0;
+        else if (locked)
+            limit += 1;
+    }
+}
+
+
+//
+// Description:
+//      Normalize the weights of a vertex. Without locks all weights get
+//      scaled to a sum of one. With locks only the unlocked weights get
+//      scaled to fill the remaining weight range.
+//
+// Input Arguments:
+//      values              The weights of the listed influences.
+//      influences          The influence index of each weight.
+//      count               The number of weights.
+//      locks               The lock state of all influences.
+//
+// Return Value:
+//      None
+//
+void normalizeWeights(double *values,
+                      const unsigned int *influences,
+                      unsigned int count,
+                      const std::vector<bool> &locks)
+{
+    unsigned int i;
+
+    double sumLocked = 0.0;
+    double sumUnlocked = 0.0;
+    bool hasLocks = false;
+
+    for (i = 0; i < count; i ++)
+    {
+        if (!locks.empty() && locks[influences[i]])
+        {
+            sumLocked += values[i];
+            hasLocks = true;
+        }
+        else
+            sumUnlocked += values[i];
+    }
+
+    double sum = sumLocked + sumUnlocked;
+    double remainingWeight = 1.0 - sumLocked;
+
+    for (i = 0; i < count; i ++)
+    {
+        if (!hasLocks)
+        {
+            if (sum > 0.0)
+                values[i] /= sum;
+        }
+        else if (!locks[influences[i]])
+        {
+            if (remainingWeight > 0.0 && sumUnlocked > 0.0)
+                values[i] *= remainingWeight / sumUnlocked;
+            else
+                values[i] = 0.0;
+        }
+    }
+}
+
+
+//
+// Description:
+//      Move the given fraction of the source influence weight to the
+//      destination influence.
+//
+// Input Arguments:
+//      values              The weights of all influences of the vertex.
+//      count               The number of influences.
+//      source              The index of the source influence.
+//      destination         The index of the destination influence.
+//      scale               The fraction of the source weight to
+//                          transfer.
+//      normalize           True, if the weights get normalized.
+//
+// Return Value:
+//      None
+//
+void transferWeight(double *values,
+                    unsigned int count,
+                    unsigned int source,
+                    unsigned int destination,
+                    double scale,
+                    bool normalize)
+{
+    transferWeights(values, count, &source, 1, &destination, 1, scale, normalize);
+}
+
+
+//
+// Description:
+//      Move the given fraction of the weights of all source influences
+//      to the destination influences in a single pass. The moved weight
+//      is shared by the destinations in proportion to their current
+//      weights, or evenly if none of them has a weight. The weights get
+//      normalized once after all sources have been moved.
+//      The influences in the source and destination lists are expected
+//      to be unique.
+//
+// Input Arguments:
+//      values              The weights of all influences of the vertex.
+//      count               The number of influences.
+//      sources             The indices of the source influences.
+//      sourceCount         The number of source influences.
+//      destinations        The indices of the destination influences.
+//      destinationCount    The number of destination influences.
+//      scale               The fraction of the source weights to
+//                          transfer.
+//      normalize           True, if the weights get normalized.
+//
+// Return Value:
+//      None
+//
+void transferWeights(double *values,
+                     unsigned int count,
+                     const unsigned int *sources,
+                     unsigned int sourceCount,
+                     const unsigned int *destinations,
+                     unsigned int destinationCount,
+                     double scale,
+                     bool normalize)
+{
+    unsigned int i;
+
+    if (!sourceCount || !destinationCount)
+        return;
+
+    double moved = 0.0;
+    for (i = 0; i < sourceCount; i ++)
+    {
+        double value = values[sources[i]];
+        if (value > 0.0)
+        {
+            moved += value * scale;
+            values[sources[i]] = value * (1 - scale);
+        }
+    }
+
+    if (moved <= 0.0)
+        return;
+
+    if (destinationCount == 1)
+        values[destinations[0]] += moved;
+    else
+    {
+        double sum = 0.0;
+        for (i = 0; i < destinationCount; i ++)
+            sum += values[destinations[i]];
+
+        for (i = 0; i < destinationCount; i ++)
+        {
+            if (sum > 0.0)
+                values[destinations[i]] += moved * values[destinations[i]] / sum;
+            else
+                values[destinations[i]] += moved / destinationCount;
+        }
+    }
+
+    if (!normalize)
+        return;
+
+    double sum = 0.0;
+    for (i = 0; i < count; i ++)
+        sum += values[i];
+
+    if (sum > 0.0)
+    {
+        for (i = 0; i < count; i ++)
+            values[i] /= sum;
+    }
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
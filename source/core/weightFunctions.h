@@ -0,0 +1,86 @@
+// ---------------------------------------------------------------------
+//
+//  weightFunctions.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__weightFunctions__
+#define __brSmoothWeights__weightFunctions__
+
+#include <vector>
+
+// ---------------------------------------------------------------------
+// The per-vertex operations on skin weights which are shared by the
+// brush tools, the flood modes and the batch command.
+//
+// The weights of a vertex are passed as a list of values together with
+// the influence index of each value. This can be the list of all
+// influences or a compacted list which only contains the influences
+// with a weight, since the weights of all other influences are zero.
+// An empty lock list means that no influence is locked.
+// ---------------------------------------------------------------------
+
+double falloffValue(int curve, double value, double strength);
+
+void limitInfluences(double *values,
+                     const unsigned int *influences,
+                     unsigned int count,
+                     const std::vector<bool> &locks,
+                     unsigned int lockedCount,
+                     unsigned int maxInfluences,
+                     std::vector<unsigned int> &order);
+
+void normalizeWeights(double *values,
+                      const unsigned int *influences,
+                      unsigned int count,
+                      const std::vector<bool> &locks);
+
+void transferWeight(double *values,
+                    unsigned int count,
+                    unsigned int source,
+                    unsigned int destination,
+                    double scale,
+                    bool normalize);
+
+void transferWeights(double *values,
+                     unsigned int count,
+                     const unsigned int *sources,
+                     unsigned int sourceCount,
+                     const unsigned int *destinations,
+                     unsigned int destinationCount,
+                     double scale,
+                     bool normalize);
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
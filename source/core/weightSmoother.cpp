@@ -0,0 +1,353 @@
+// ---------------------------------------------------------------------
+//
+//  weightSmoother.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "weightSmoother.h"
+
+
+weightSmoother::weightSmoother()
+{
+    influenceCount = 0;
+    lockedCount = 0;
+    maxInfluences = 0;
+    normalize = true;
+}
+
+
+//
+// Description:
+//      Define the influence settings of the skin cluster.
+//
+// Input Arguments:
+//      influenceCount      The number of influences.
+//      locks               The lock state per influence.
+//      maxInfluences       The maximum number of influences per vertex
+//                          or 0, if the number is not limited.
+//      normalize           True, if the weights get normalized.
+//
+// Return Value:
+//      None
+//
+void weightSmoother::create(unsigned int influenceCount,
+                            const std::vector<bool> &locks,
+                            unsigned int maxInfluences,
+                            bool normalize)
+{
+    unsigned int i;
+
+    this->influenceCount = influenceCount;
+    this->locks = locks;
+    this->locks.resize(influenceCount, false);
+    this->maxInfluences = maxInfluences;
+    this->normalize = normalize;
+
+    lockedCount = 0;
+    for (i = 0; i < influenceCount; i ++)
+    {
+        if (this->locks[i])
+            lockedCount ++;
+    }
+}
+
+
+//
+// Description:
+//      Store the influences with a non-zero weight of the smoothed
+//      vertex. The list replaces the current list of the vertex with
+//      updateInfluenceList() after the pass, because other vertices of
+//      the pass might still read the current list. Different vertices
+//      can be stored from multiple threads.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      buffer              The smoothing result of the vertex.
+//
+// Return Value:
+//      None
+//
+void weightSmoother::setInfluenceList(unsigned int index, const smoothBuffer &buffer)
+{
+    unsigned int i;
+
+    influenceList &list = pendingLists[index];
+    list.clear();
+
+    for (i = 0; i < buffer.influences.size(); i ++)
+    {
+        if (buffer.values[i] != 0.0)
+            list.push_back(buffer.influences[i]);
+    }
+
+    pending[index] = 1;
+}
+
+
+//
+// Description:
+//      Replace the influence list of the vertex with the list which has
+//      been stored during the pass, if any.
+//
+// Input Arguments:
+//      index               The vertex index.
+//
+// Return Value:
+//      None
+//
+void weightSmoother::updateInfluenceList(unsigned int index)
+{
+    if (!pending[index])
+        return;
+
+    influenceLists[index].swap(pendingLists[index]);
+    pending[index] = 0;
+}
+
+
+//
+// Description:
+//      Collect the neighbours of the given vertex and of its opposite
+//      shell vertex for averaging with equal shares.
+//
+// Input Arguments:
+//      topology            The vertex adjacency of the mesh.
+//      index               The vertex index.
+//      oppositeIndex       The opposite shell vertex or -1.
+//      buffer              The buffer which receives the neighbours.
+//
+// Return Value:
+//      None
+//
+void weightSmoother::getNeighbors(const meshTopology &topology,
+                                  unsigned int index,
+                                  int oppositeIndex,
+                                  smoothBuffer &buffer) const
+{
+    unsigned int i;
+
+    buffer.neighbors.clear();
+    buffer.shares.clear();
+
+    for (i = topology.rowStart(index); i < topology.rowEnd(index); i ++)
+        buffer.neighbors.push_back(topology.neighbor(i));
+
+    if (oppositeIndex > -1)
+    {
+        unsigned int opposite = (unsigned)oppositeIndex;
+        for (i = topology.rowStart(opposite); i < topology.rowEnd(opposite); i ++)
+            buffer.neighbors.push_back(topology.neighbor(i));
+    }
+}
+
+
+//
+// Description:
+//      Collect the neighbours of the given vertex and of its opposite
+//      shell vertex together with their cotangent weights. With an
+//      opposite vertex each side contributes half of the average.
+//
+// Input Arguments:
+//      smoothing           The averaging weights of the mesh.
+//      index               The vertex index.
+//      oppositeIndex       The opposite shell vertex or -1.
+//      buffer              The buffer which receives the neighbours
+//                          and their shares.
+//
+// Return Value:
+//      None
+//
+void weightSmoother::getWeightedNeighbors(const smoothingOperator &smoothing,
+                                          unsigned int index,
+                                          int oppositeIndex,
+                                          smoothBuffer &buffer) const
+{
+    unsigned int i;
+
+    buffer.neighbors.clear();
+    buffer.shares.clear();
+
+    double share = 1.0;
+    if (oppositeIndex > -1)
+        share = 0.5;
+
+    for (i = smoothing.rowStart(index); i < smoothing.rowEnd(index); i ++)
+    {
+        buffer.neighbors.push_back(smoothing.neighbor(i));
+        buffer.shares.push_back(smoothing.weight(i) * share);
+    }
+
+    if (oppositeIndex > -1)
+    {
+        unsigned int opposite = (unsigned)oppositeIndex;
+        for (i = smoothing.rowStart(opposite); i < smoothing.rowEnd(opposite); i ++)
+        {
+            buffer.neighbors.push_back(smoothing.neighbor(i));
+            buffer.shares.push_back(smoothing.weight(i) * share);
+        }
+    }
+}
+
+
+//
+// Description:
+//      Smooth the weights of the given vertices.
+//
+// Input Arguments:
+//      topology            The vertex adjacency of the mesh.
+//      indices             The vertices to smooth.
+//      strength            The blend factor between the current weights
+//                          and the average of the neighbours.
+//      iterations          The number of smoothing passes.
+//      weights             The weights of all vertices.
+//
+// Return Value:
+//      None
+//
+void weightSmoother::smooth(const meshTopology &topology,
+                            const std::vector<unsigned int> &indices,
+                            double strength,
+                            unsigned int iterations,
+                            std::vector<double> &weights)
+{
+    unsigned int i, m;
+
+    unsigned int numVertices = topology.vertexCount();
+    unsigned int count = (unsigned)indices.size();
+
+    if (!influenceCount || !count || weights.size() != numVertices * influenceCount)
+        return;
+
+    // The pass for the current settings, with the bits of the table
+    // index matching the order of the template arguments.
+    typedef void (weightSmoother::*passFunction)(const meshTopology &,
+                                                 const std::vector<unsigned int> &,
+                                                 double,
+                                                 const std::vector<double> &,
+                                                 std::vector<double> &);
+
+    static const passFunction passes[8] = {
+        &weightSmoother::smoothPass<false, false, false>,
+        &weightSmoother::smoothPass<true, false, false>,
+        &weightSmoother::smoothPass<false, true, false>,
+        &weightSmoother::smoothPass<true, true, false>,
+        &weightSmoother::smoothPass<false, false, true>,
+        &weightSmoother::smoothPass<true, false, true>,
+        &weightSmoother::smoothPass<false, true, true>,
+        &weightSmoother::smoothPass<true, true, true>
+    };
+
+    unsigned int mode = 0;
+    if (lockedCount)
+        mode |= 1;
+    if (maxInfluences && influenceCount > maxInfluences)
+        mode |= 2;
+    if (normalize)
+        mode |= 4;
+
+    std::vector<double> result(count * influenceCount, 0.0);
+
+    createInfluenceLists(weights, numVertices);
+
+    for (m = 0; m < iterations; m ++)
+    {
+        (this->*passes[mode])(topology, indices, strength, weights, result);
+
+        for (i = 0; i < count; i ++)
+        {
+            if (indices[i] >= numVertices)
+                continue;
+
+            std::copy(result.begin() + i * influenceCount,
+                      result.begin() + (i + 1) * influenceCount,
+                      weights.begin() + indices[i] * influenceCount);
+
+            updateInfluenceList(indices[i]);
+        }
+    }
+}
+
+
+//
+// Description:
+//      Compute a single smoothing pass of the given vertices. All
+//      vertices read the weights of the previous pass, which makes the
+//      result independent of the processing order and allows to compute
+//      the vertices in parallel.
+//
+// Input Arguments:
+//      topology            The vertex adjacency of the mesh.
+//      indices             The vertices to smooth.
+//      strength            The smoothing strength.
+//      weights             The weights of all vertices.
+//      result              The smoothed weights of the given vertices.
+//
+// Return Value:
+//      None
+//
+template <bool HasLocks, bool MaxInfluences, bool Normalize>
+void weightSmoother::smoothPass(const meshTopology &topology,
+                                const std::vector<unsigned int> &indices,
+                                double strength,
+                                const std::vector<double> &weights,
+                                std::vector<double> &result)
+{
+    unsigned int numVertices = topology.vertexCount();
+    unsigned int count = (unsigned)indices.size();
+
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, count),
+                      [&](tbb::blocked_range<unsigned int> r)
+    {
+        smoothBuffer buffer;
+
+        for (unsigned int k = r.begin(); k < r.end(); k ++)
+        {
+            unsigned int index = indices[k];
+            if (index >= numVertices)
+                continue;
+
+            getNeighbors(topology, index, -1, buffer);
+            computeVertex<false, HasLocks, MaxInfluences, Normalize>(weights, index, -1, strength, buffer);
+
+            // Only the influences of the union can differ from zero.
+            double *row = &result[k * influenceCount];
+            std::fill(row, row + influenceCount, 0.0);
+            for (unsigned int l = 0; l < buffer.influences.size(); l ++)
+                row[buffer.influences[l]] = buffer.values[l];
+
+            setInfluenceList(index, buffer);
+        }
+    });
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -0,0 +1,338 @@
+// ---------------------------------------------------------------------
+//
+//  weightSmoother.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__weightSmoother__
+#define __brSmoothWeights__weightSmoother__
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include "meshLaplacian.h"
+#include "meshTopology.h"
+#include "weightFunctions.h"
+
+// ---------------------------------------------------------------------
+// The working memory of the smoothing kernel. Each thread keeps one
+// buffer for all vertices it processes, so that the kernel doesn't
+// allocate memory per vertex. The caller fills the neighbours of the
+// vertex, the kernel returns the smoothed weights of the influences.
+// ---------------------------------------------------------------------
+
+struct smoothBuffer
+{
+    std::vector<unsigned int> neighbors;    // The vertices which get
+                                            // averaged.
+    std::vector<double> shares;             // The share of each
+                                            // neighbour or empty for
+                                            // equal shares.
+    std::vector<double> scales;             // The falloff of each
+                                            // neighbour in volume
+                                            // mode.
+
+    std::vector<unsigned int> influences;   // The influences which
+                                            // can have a weight.
+    std::vector<unsigned int> merged;
+    std::vector<double> values;             // The smoothed weight of
+                                            // each influence.
+    std::vector<unsigned int> order;
+};
+
+
+// ---------------------------------------------------------------------
+// The smoothing of skin weights without any dependency on the Maya
+// API. It's shared by the brush and the flood of the smooth tool and
+// the batch command.
+//
+// The weights are stored per vertex with all influences of a vertex
+// next to each other, which is the layout of MFnSkinCluster. A vertex
+// gets the weights of its neighbours blended with its own weights,
+// followed by maintaining the max influences and the normalization.
+// Only the influences with a weight on the vertex, its opposite shell
+// vertex or any neighbour get processed, because all other weights are
+// zero and stay zero. These are merged from the sorted lists of the
+// influences with a non-zero weight of each vertex, which get created
+// once for the weights and updated after each pass for the vertices
+// which have been written.
+//
+// The weights can be any array type with an index operator, which
+// allows to pass the double or single precision weights of the tools
+// without copying them.
+// ---------------------------------------------------------------------
+
+class weightSmoother
+{
+public:
+
+    weightSmoother();
+
+    void create(unsigned int influenceCount,
+                const std::vector<bool> &locks,
+                unsigned int maxInfluences,
+                bool normalize);
+
+    void getNeighbors(const meshTopology &topology,
+                      unsigned int index,
+                      int oppositeIndex,
+                      smoothBuffer &buffer) const;
+    void getWeightedNeighbors(const smoothingOperator &smoothing,
+                              unsigned int index,
+                              int oppositeIndex,
+                              smoothBuffer &buffer) const;
+
+    template <typename WeightArray>
+    void createInfluenceLists(const WeightArray &weights, unsigned int numVertices);
+    void setInfluenceList(unsigned int index, const smoothBuffer &buffer);
+    void updateInfluenceList(unsigned int index);
+
+    template <bool VolumeMode, bool HasLocks, bool MaxInfluences, bool Normalize, typename WeightArray>
+    void computeVertex(const WeightArray &weights,
+                       unsigned int index,
+                       int oppositeIndex,
+                       double scale,
+                       smoothBuffer &buffer) const;
+
+    void smooth(const meshTopology &topology,
+                const std::vector<unsigned int> &indices,
+                double strength,
+                unsigned int iterations,
+                std::vector<double> &weights);
+
+private:
+
+    unsigned int influenceCount;
+    std::vector<bool> locks;                // True, if the influence
+                                            // keeps its weights.
+    unsigned int lockedCount;
+    unsigned int maxInfluences;             // 0, if the number of
+                                            // influences is not
+                                            // limited.
+    bool normalize;
+
+    typedef std::vector<unsigned int> influenceList;
+
+    std::vector<influenceList> influenceLists;  // The sorted influences
+                                                // with a non-zero weight
+                                                // of each vertex.
+    std::vector<influenceList> pendingLists;    // The new lists of the
+                                                // written vertices until
+                                                // the pass is finished.
+    std::vector<unsigned char> pending;
+
+    template <bool HasLocks, bool MaxInfluences, bool Normalize>
+    void smoothPass(const meshTopology &topology,
+                    const std::vector<unsigned int> &indices,
+                    double strength,
+                    const std::vector<double> &weights,
+                    std::vector<double> &result);
+};
+
+
+// ---------------------------------------------------------------------
+// template methods
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Collect the influences with a non-zero weight of all vertices.
+//      The lists of previous weights get reused, so that only the first
+//      call for a mesh allocates memory.
+//
+// Input Arguments:
+//      weights             The weights of all vertices.
+//      numVertices         The number of vertices.
+//
+// Return Value:
+//      None
+//
+template <typename WeightArray>
+void weightSmoother::createInfluenceLists(const WeightArray &weights, unsigned int numVertices)
+{
+    influenceLists.resize(numVertices);
+    pendingLists.resize(numVertices);
+    pending.assign(numVertices, 0);
+
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, numVertices),
+                      [&](tbb::blocked_range<unsigned int> r)
+    {
+        for (unsigned int i = r.begin(); i < r.end(); i ++)
+        {
+            std::vector<unsigned int> &list = influenceLists[i];
+            list.clear();
+
+            unsigned int offset = influenceCount * i;
+            for (unsigned int j = 0; j < influenceCount; j ++)
+            {
+                if (weights[offset + j] != 0.0)
+                    list.push_back(j);
+            }
+        }
+    });
+}
+
+
+//
+// Description:
+//      Compute the smoothed weights of a single vertex from the
+//      neighbours in the buffer. The result is the list of influences
+//      in the buffer together with their values. The influence lists
+//      need to be created for the weights.
+//
+// Input Arguments:
+//      weights             The weights of all vertices.
+//      index               The vertex index.
+//      oppositeIndex       The opposite shell vertex or -1.
+//      scale               The blend factor between the current weights
+//                          and the neighbour weights.
+//      buffer              The neighbours of the vertex and the
+//                          working memory.
+//
+// Template Arguments:
+//      VolumeMode          True, if each neighbour has its own falloff.
+//      HasLocks            True, if the locks need to be respected.
+//      MaxInfluences       True, if the max influences need to be
+//                          maintained.
+//      Normalize           True, if the weights get normalized.
+//
+// Return Value:
+//      None
+//
+template <bool VolumeMode, bool HasLocks, bool MaxInfluences, bool Normalize, typename WeightArray>
+void weightSmoother::computeVertex(const WeightArray &weights,
+                                   unsigned int index,
+                                   int oppositeIndex,
+                                   double scale,
+                                   smoothBuffer &buffer) const
+{
+    unsigned int i, j, u;
+
+    // Without locks an empty lock list is passed, which also covers
+    // ignoring the locks.
+    static const std::vector<bool> noLocks;
+    const std::vector<bool> &vertexLocks = HasLocks ? locks : noLocks;
+
+    const std::vector<unsigned int> &neighbors = buffer.neighbors;
+    unsigned int neighborCount = (unsigned)neighbors.size();
+    bool weighted = !VolumeMode && !buffer.shares.empty();
+
+    // -----------------------------------------------------------------
+    // influence union
+    // -----------------------------------------------------------------
+
+    // The lists are sorted, which keeps the order of the influence
+    // indices to get the same order for sorting equal weights as with
+    // all influences.
+    std::vector<unsigned int> &influences = buffer.influences;
+    std::vector<unsigned int> &merged = buffer.merged;
+    influences.assign(influenceLists[index].begin(), influenceLists[index].end());
+
+    auto addInfluences = [&](unsigned int vertex)
+    {
+        const std::vector<unsigned int> &list = influenceLists[vertex];
+        if (list.empty())
+            return;
+
+        merged.clear();
+        std::set_union(influences.begin(), influences.end(),
+                       list.begin(), list.end(),
+                       std::back_inserter(merged));
+        influences.swap(merged);
+    };
+
+    if (oppositeIndex > -1)
+        addInfluences((unsigned)oppositeIndex);
+    for (j = 0; j < neighborCount; j ++)
+        addInfluences(neighbors[j]);
+
+    unsigned int unionCount = (unsigned)influences.size();
+
+    // -----------------------------------------------------------------
+    // smooth by averaging the neighbour weights
+    // -----------------------------------------------------------------
+
+    std::vector<double> &values = buffer.values;
+    values.resize(unionCount);
+
+    for (u = 0; u < unionCount; u ++)
+    {
+        i = influences[u];
+
+        double current = weights[influenceCount * index + i];
+
+        // Without any neighbours, which can happen if the volume range
+        // is too small, the vertex keeps its weights.
+        if (!neighborCount || (HasLocks && locks[i]))
+        {
+            values[u] = current;
+            continue;
+        }
+
+        double weight = 0.0;
+        for (j = 0; j < neighborCount; j ++)
+        {
+            double share = weighted ? buffer.shares[j] : 1.0 / neighborCount;
+            double neighborScale = VolumeMode ? buffer.scales[j] : scale;
+
+            weight += (weights[influenceCount * neighbors[j] + i] * share * neighborScale) +
+                      (current * share * (1 - scale));
+        }
+
+        values[u] = weight;
+    }
+
+    if (!neighborCount)
+        return;
+
+    // -----------------------------------------------------------------
+    // maintain max influences & normalize
+    // -----------------------------------------------------------------
+
+    if (MaxInfluences)
+    {
+        limitInfluences(values.data(), influences.data(), unionCount,
+                        vertexLocks, lockedCount, maxInfluences, buffer.order);
+    }
+
+    if (Normalize)
+        normalizeWeights(values.data(), influences.data(), unionCount, vertexLocks);
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
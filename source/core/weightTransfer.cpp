@@ -0,0 +1,182 @@
+// ---------------------------------------------------------------------
+//
+//  weightTransfer.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "weightTransfer.h"
+
+#include <algorithm>
+
+
+weightTransfer::weightTransfer()
+{
+    influenceCount = 0;
+    generation = 0;
+}
+
+
+//
+// Description:
+//      Define the influences of the transfer and collect the columns of
+//      the sparse weights.
+//
+// Input Arguments:
+//      influenceCount      The number of influences.
+//      sources             The source influences.
+//      destinations        The destination influences.
+//      mirrorSources       The source influences of mirrored vertices.
+//      mirrorDestinations  The destination influences of mirrored
+//                          vertices.
+//
+// Return Value:
+//      None
+//
+void weightTransfer::create(unsigned int influenceCount,
+                            const std::vector<unsigned int> &sources,
+                            const std::vector<unsigned int> &destinations,
+                            const std::vector<unsigned int> &mirrorSources,
+                            const std::vector<unsigned int> &mirrorDestinations)
+{
+    this->influenceCount = influenceCount;
+    this->sources = sources;
+    this->destinations = destinations;
+    this->mirrorSources = mirrorSources;
+    this->mirrorDestinations = mirrorDestinations;
+
+    columnList.clear();
+
+    std::vector<int> columnIndices(influenceCount, -1);
+
+    auto getColumns = [&](const std::vector<unsigned int> &influences,
+                          std::vector<unsigned int> &result)
+    {
+        result.resize(influences.size());
+        for (unsigned int i = 0; i < influences.size(); i ++)
+        {
+            unsigned int influence = influences[i];
+            if (columnIndices[influence] == -1)
+            {
+                columnIndices[influence] = (int)columnList.size();
+                columnList.push_back(influence);
+            }
+            result[i] = (unsigned)columnIndices[influence];
+        }
+    };
+
+    getColumns(sources, columnSources);
+    getColumns(destinations, columnDestinations);
+    getColumns(mirrorSources, mirrorColumnSources);
+    getColumns(mirrorDestinations, mirrorColumnDestinations);
+}
+
+
+//
+// Description:
+//      Return the influences which get written by the sparse transfer.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      std::vector         The influence index of each column.
+//
+const std::vector<unsigned int> &weightTransfer::columns() const
+{
+    return columnList;
+}
+
+
+//
+// Description:
+//      Reset the transfer multipliers at the start of a stroke or when
+//      the mesh changes. A multiplier is only valid if its vertex is
+//      stamped with the current generation, so that starting a new
+//      generation clears all multipliers without writing to the arrays.
+//      The arrays only get allocated when the number of vertices
+//      changes.
+//
+// Input Arguments:
+//      numVertices         The number of vertices of the mesh.
+//
+// Return Value:
+//      None
+//
+void weightTransfer::reset(unsigned int numVertices)
+{
+    if (values.size() != numVertices)
+    {
+        values = std::vector<double>(numVertices, 0.0);
+        stamps = std::vector<unsigned int>(numVertices, 0);
+        generation = 0;
+    }
+
+    generation ++;
+    if (generation == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+}
+
+
+//
+// Description:
+//      Add the given value to the transfer multiplier of the vertex.
+//      The multiplier starts at zero for vertices which haven't been
+//      transferred during the stroke and is limited to 1 so that the
+//      normalization doesn't break. Each vertex must only be
+//      accumulated by one thread at a time.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      value               The transfer value of the current dab.
+//
+// Return Value:
+//      double              The accumulated transfer multiplier.
+//
+double weightTransfer::accumulate(unsigned int index, double value)
+{
+    if (stamps[index] == generation)
+        value += values[index];
+
+    if (value > 1.0)
+        value = 1.0;
+
+    values[index] = value;
+    stamps[index] = generation;
+
+    return value;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
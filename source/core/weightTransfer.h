@@ -0,0 +1,185 @@
+// ---------------------------------------------------------------------
+//
+//  weightTransfer.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__weightTransfer__
+#define __brSmoothWeights__weightTransfer__
+
+#include <vector>
+
+#include "weightFunctions.h"
+
+// ---------------------------------------------------------------------
+// The transfer of skin weights between influences without any
+// dependency on the Maya API.
+//
+// The weights are stored per vertex with all influences of a vertex
+// next to each other, which is the layout of MFnSkinCluster. The
+// weight of the source influences moves to the destination influences
+// by the transfer multiplier of the vertex, which accumulates during
+// a stroke. Mirrored vertices transfer between the mirrored
+// influences.
+//
+// The sparse transfer only reads and writes the columns of the
+// transfer influences. Moving the weight between them keeps the sum of
+// each row which makes the normalization unnecessary.
+// ---------------------------------------------------------------------
+
+class weightTransfer
+{
+public:
+
+    weightTransfer();
+
+    void create(unsigned int influenceCount,
+                const std::vector<unsigned int> &sources,
+                const std::vector<unsigned int> &destinations,
+                const std::vector<unsigned int> &mirrorSources,
+                const std::vector<unsigned int> &mirrorDestinations);
+
+    const std::vector<unsigned int> &columns() const;
+
+    void reset(unsigned int numVertices);
+    double accumulate(unsigned int index, double value);
+
+    template <bool Normalize, bool Sparse, typename WeightArray>
+    void transferVertex(const WeightArray &weights,
+                        unsigned int index,
+                        double scale,
+                        bool mirrored,
+                        std::vector<double> &values) const;
+
+private:
+
+    unsigned int influenceCount;
+    std::vector<unsigned int> sources;              // The unlocked source
+    std::vector<unsigned int> destinations;         // and destination
+                                                    // influences.
+    std::vector<unsigned int> mirrorSources;        // The mirrored source
+    std::vector<unsigned int> mirrorDestinations;   // and destination
+                                                    // influences.
+
+    std::vector<unsigned int> columnList;   // The influences which get
+                                            // written by the sparse
+                                            // transfer.
+    std::vector<unsigned int> columnSources;            // The columns
+    std::vector<unsigned int> columnDestinations;       // of the transfer
+    std::vector<unsigned int> mirrorColumnSources;      // influences in
+    std::vector<unsigned int> mirrorColumnDestinations; // the sparse
+                                                        // weights.
+
+    std::vector<double> values;             // The accumulated transfer
+                                            // multiplier of each vertex.
+    std::vector<unsigned int> stamps;       // The generation with which
+                                            // the multiplier has been
+                                            // set.
+    unsigned int generation;
+};
+
+
+// ---------------------------------------------------------------------
+// template methods
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Transfer the weights of a single vertex. The result contains the
+//      weights of the transfer columns when sparse or of all influences
+//      otherwise.
+//
+// Input Arguments:
+//      weights             The weights of all vertices.
+//      index               The vertex index.
+//      scale               The transfer multiplier of the vertex.
+//      mirrored            True, if the vertex transfers between the
+//                          mirrored influences.
+//      values              The transferred weights of the vertex.
+//
+// Template Arguments:
+//      Normalize           True, if the weights get normalized.
+//      Sparse              True, if only the columns of the transfer
+//                          influences get processed.
+//
+// Return Value:
+//      None
+//
+template <bool Normalize, bool Sparse, typename WeightArray>
+void weightTransfer::transferVertex(const WeightArray &weights,
+                                    unsigned int index,
+                                    double scale,
+                                    bool mirrored,
+                                    std::vector<double> &values) const
+{
+    unsigned int i;
+
+    unsigned int offset = influenceCount * index;
+
+    if (Sparse)
+    {
+        const std::vector<unsigned int> &columnFrom = mirrored ? mirrorColumnSources : columnSources;
+        const std::vector<unsigned int> &columnTo = mirrored ? mirrorColumnDestinations : columnDestinations;
+
+        unsigned int columnCount = (unsigned)columnList.size();
+        values.resize(columnCount);
+        for (i = 0; i < columnCount; i ++)
+            values[i] = weights[offset + columnList[i]];
+
+        transferWeights(values.data(), columnCount,
+                        columnFrom.data(), (unsigned)columnFrom.size(),
+                        columnTo.data(), (unsigned)columnTo.size(),
+                        scale, false);
+        return;
+    }
+
+    const std::vector<unsigned int> &from = mirrored ? mirrorSources : sources;
+    const std::vector<unsigned int> &to = mirrored ? mirrorDestinations : destinations;
+
+    // Start from the current weights of the vertex so that the other
+    // influences keep their weights.
+    values.resize(influenceCount);
+    for (i = 0; i < influenceCount; i ++)
+        values[i] = weights[offset + i];
+
+    // All sources get moved with a single normalization. Without any
+    // unlocked source or destination the weights stay unchanged.
+    transferWeights(values.data(), influenceCount,
+                    from.data(), (unsigned)from.size(),
+                    to.data(), (unsigned)to.size(),
+                    scale, Normalize);
+}
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
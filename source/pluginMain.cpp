@@ -14,6 +14,7 @@ static const std::string kVERSION = "1.2.0";
 
 #include <maya/MFnPlugin.h>
 
+#include "smoothWeightsCmd.h"
 #include "smoothWeightsTool.h"
 #include "transferWeightsTool.h"
 
@@ -33,6 +34,12 @@ MStatus initializePlugin(MObject obj)
     if (status != MStatus::kSuccess)
         status.perror("Register brSmoothWeightsContext failed.");
 
+    status = plugin.registerCommand("brSmoothWeights",
+                                    smoothWeightsCmd::creator,
+                                    smoothWeightsCmd::newSyntax);
+    if (status != MStatus::kSuccess)
+        status.perror("Register brSmoothWeights failed.");
+
     status = plugin.registerContextCommand("brTransferWeightsContext",
                                            transferWeightsContextCmd::creator,
                                            "brTransferWeightsCmd",
@@ -53,6 +60,10 @@ MStatus uninitializePlugin(MObject obj)
     if (status != MStatus::kSuccess)
         status.perror("Deregister brSmoothWeightsContext failed.");
 
+    status = plugin.deregisterCommand("brSmoothWeights");
+    if (status != MStatus::kSuccess)
+        status.perror("Deregister brSmoothWeights failed.");
+
     status = plugin.deregisterContextCommand("brTransferWeightsContext",
                                              "brTransferWeightsCmd");
     if (status != MStatus::kSuccess)
@@ -0,0 +1,658 @@
+// ---------------------------------------------------------------------
+//
+//  smoothWeightsCmd.cpp
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#include "smoothWeightsCmd.h"
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnMesh.h>
+#include <maya/MFnSingleIndexedComponent.h>
+#include <maya/MFnSkinCluster.h>
+#include <maya/MItDependencyGraph.h>
+#include <maya/MPlug.h>
+
+#include <tbb/task_group.h>
+
+#include "core/meshTopology.h"
+#include "core/weightSmoother.h"
+
+// ---------------------------------------------------------------------
+// the command
+// ---------------------------------------------------------------------
+
+smoothWeightsCmd::smoothWeightsCmd()
+{
+    ignoreLockVal = false;
+    iterationsVal = 1;
+    strengthVal = 0.5;
+}
+
+
+smoothWeightsCmd::~smoothWeightsCmd()
+{}
+
+
+void* smoothWeightsCmd::creator()
+{
+    return new smoothWeightsCmd;
+}
+
+
+bool smoothWeightsCmd::isUndoable() const
+{
+    return true;
+}
+
+
+// ---------------------------------------------------------------------
+// command flags
+// ---------------------------------------------------------------------
+
+#define kComponentsFlag                 "-c"
+#define kComponentsFlagLong             "-components"
+#define kIgnoreLockFlag                 "-il"
+#define kIgnoreLockFlagLong             "-ignoreLock"
+#define kInfluencesFlag                 "-inf"
+#define kInfluencesFlagLong             "-influences"
+#define kIterationsFlag                 "-i"
+#define kIterationsFlagLong             "-iterations"
+#define kMeshFlag                       "-m"
+#define kMeshFlagLong                   "-mesh"
+#define kStrengthFlag                   "-st"
+#define kStrengthFlagLong               "-strength"
+
+
+MSyntax smoothWeightsCmd::newSyntax()
+{
+    MSyntax syntax;
+
+    syntax.addFlag(kComponentsFlag, kComponentsFlagLong, MSyntax::kString);
+    syntax.addFlag(kIgnoreLockFlag, kIgnoreLockFlagLong, MSyntax::kBoolean);
+    syntax.addFlag(kInfluencesFlag, kInfluencesFlagLong, MSyntax::kString);
+    syntax.addFlag(kIterationsFlag, kIterationsFlagLong, MSyntax::kLong);
+    syntax.addFlag(kMeshFlag, kMeshFlagLong, MSyntax::kString);
+    syntax.addFlag(kStrengthFlag, kStrengthFlagLong, MSyntax::kDouble);
+
+    syntax.makeFlagMultiUse(kComponentsFlag);
+    syntax.makeFlagMultiUse(kInfluencesFlag);
+    syntax.makeFlagMultiUse(kMeshFlag);
+
+    return syntax;
+}
+
+
+MStatus smoothWeightsCmd::parseArgs(const MArgList& args)
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    MArgDatabase argData(syntax(), args);
+
+    MArgList argList;
+    MString value;
+
+    unsigned int count = argData.numberOfFlagUses(kComponentsFlag);
+    for (i = 0; i < count; i ++)
+    {
+        status = argData.getFlagArgumentList(kComponentsFlag, i, argList);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        value = argList.asString(0, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        componentsVal.append(value);
+    }
+    if (argData.isFlagSet(kIgnoreLockFlag))
+    {
+        status = argData.getFlagArgument(kIgnoreLockFlag, 0, ignoreLockVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+    count = argData.numberOfFlagUses(kInfluencesFlag);
+    for (i = 0; i < count; i ++)
+    {
+        status = argData.getFlagArgumentList(kInfluencesFlag, i, argList);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        value = argList.asString(0, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        influencesVal.append(value);
+    }
+    if (argData.isFlagSet(kIterationsFlag))
+    {
+        status = argData.getFlagArgument(kIterationsFlag, 0, iterationsVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+    count = argData.numberOfFlagUses(kMeshFlag);
+    for (i = 0; i < count; i ++)
+    {
+        status = argData.getFlagArgumentList(kMeshFlag, i, argList);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        value = argList.asString(0, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        meshVal.append(value);
+    }
+    if (argData.isFlagSet(kStrengthFlag))
+    {
+        status = argData.getFlagArgument(kStrengthFlag, 0, strengthVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+
+    if (iterationsVal < 1)
+        iterationsVal = 1;
+    if (strengthVal < 0.0)
+        strengthVal = 0.0;
+    else if (strengthVal > 1.0)
+        strengthVal = 1.0;
+
+    return status;
+}
+
+
+// ---------------------------------------------------------------------
+// main methods for the command
+// ---------------------------------------------------------------------
+
+MStatus smoothWeightsCmd::doIt(const MArgList &args)
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    status = parseArgs(args);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    status = getMeshes();
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    // Get the weights of all meshes before changing any skin cluster,
+    // so that a failing mesh leaves the scene unchanged.
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        status = getMeshWeights(meshes[i]);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+
+    // Smooth each mesh in its own task. The smoothing of a mesh is
+    // parallelized over the vertices as well, so that a single dense
+    // mesh still uses all cores while a list of smaller meshes takes
+    // about as long as the largest one. Only the plain arrays of the
+    // mesh data are accessed in the tasks, getting and setting the
+    // weights stays on the main thread.
+    tbb::task_group group;
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        meshData &data = meshes[i];
+        group.run([this, &data]() { smoothMesh(data); });
+    }
+    group.wait();
+
+    int vertexCount = 0;
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        setRedoWeights(meshes[i]);
+        vertexCount += (int)meshes[i].indices.size();
+    }
+
+    status = redoIt();
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    setResult(vertexCount);
+
+    return status;
+}
+
+
+MStatus smoothWeightsCmd::redoIt()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    // Apply the smoothed weights and get the current weights for undo.
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        meshData &data = meshes[i];
+
+        MFnSkinCluster skinFn(data.skinObj, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        skinFn.setWeights(data.meshDag, data.vertexComponents,
+                          data.influenceIndices, data.redoWeights,
+                          data.normalize, &data.undoWeights);
+    }
+
+    return status;
+}
+
+
+MStatus smoothWeightsCmd::undoIt()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        meshData &data = meshes[i];
+
+        MFnSkinCluster skinFn(data.skinObj, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        skinFn.setWeights(data.meshDag, data.vertexComponents,
+                          data.influenceIndices, data.undoWeights,
+                          data.normalize);
+    }
+
+    return status;
+}
+
+
+// ---------------------------------------------------------------------
+// mesh and skin cluster
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Collect the meshes and vertices to smooth from the mesh and
+//      components flags. A mesh without components gets smoothed
+//      entirely. Without any of both flags the current selection is
+//      used.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStatus             The MStatus for finding the meshes.
+//
+MStatus smoothWeightsCmd::getMeshes()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i, j;
+
+    meshes.clear();
+
+    // The meshes and the components are kept in separate lists
+    // because adding the components of an already listed mesh can
+    // merge both into a single item.
+    MSelectionList meshList;
+    MSelectionList componentList;
+
+    for (i = 0; i < meshVal.length(); i ++)
+    {
+        status = meshList.add(meshVal[i]);
+        if (!status)
+        {
+            MGlobal::displayError("The mesh " + meshVal[i] + " does not exist.");
+            return status;
+        }
+    }
+
+    for (i = 0; i < componentsVal.length(); i ++)
+    {
+        status = componentList.add(componentsVal[i]);
+        if (!status)
+        {
+            MGlobal::displayError("The components " + componentsVal[i] + " do not exist.");
+            return status;
+        }
+    }
+
+    if (!meshVal.length() && !componentsVal.length())
+        MGlobal::getActiveSelectionList(componentList);
+
+    // The vertices of each mesh in a per-vertex mask, to merge several
+    // component strings of the same mesh.
+    std::vector<std::vector<bool> > masks;
+
+    unsigned int meshCount = meshList.length();
+    unsigned int itemCount = meshCount + componentList.length();
+
+    for (i = 0; i < itemCount; i ++)
+    {
+        MDagPath dagPath;
+        MObject components;
+        if (i < meshCount)
+            status = meshList.getDagPath(i, dagPath);
+        else
+            status = componentList.getDagPath(i - meshCount, dagPath, components);
+        if (!status)
+            continue;
+
+        status = dagPath.extendToShape();
+        if (!status || !dagPath.hasFn(MFn::kMesh))
+        {
+            MGlobal::displayWarning(dagPath.partialPathName() + " is not a mesh and gets skipped.");
+            continue;
+        }
+
+        if (!components.isNull() && !components.hasFn(MFn::kMeshVertComponent))
+        {
+            MGlobal::displayWarning("Only vertex components can be smoothed. " +
+                                    dagPath.partialPathName() + " gets skipped.");
+            continue;
+        }
+
+        unsigned int index = (unsigned)meshes.size();
+        for (j = 0; j < meshes.size(); j ++)
+        {
+            if (meshes[j].meshDag == dagPath)
+            {
+                index = j;
+                break;
+            }
+        }
+
+        if (index == meshes.size())
+        {
+            meshData data;
+            data.meshDag = dagPath;
+            status = getSkinCluster(dagPath, data.skinObj);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+            meshes.push_back(data);
+
+            MFnMesh meshFn(dagPath);
+            masks.push_back(std::vector<bool>((unsigned)meshFn.numVertices(), false));
+        }
+
+        std::vector<bool> &mask = masks[index];
+
+        if (components.isNull())
+            mask.assign(mask.size(), true);
+        else
+        {
+            MIntArray elements;
+            MFnSingleIndexedComponent compFn(components);
+            compFn.getElements(elements);
+            for (j = 0; j < elements.length(); j ++)
+            {
+                if ((unsigned)elements[j] < mask.size())
+                    mask[(unsigned)elements[j]] = true;
+            }
+        }
+    }
+
+    if (!meshes.size())
+    {
+        MGlobal::displayError("No skinned mesh or vertices specified.");
+        return MStatus::kInvalidParameter;
+    }
+
+    // Create the sorted vertex components of each mesh.
+    for (i = 0; i < meshes.size(); i ++)
+    {
+        meshData &data = meshes[i];
+        std::vector<bool> &mask = masks[i];
+
+        MIntArray elements;
+        for (j = 0; j < mask.size(); j ++)
+        {
+            if (mask[j])
+            {
+                data.indices.push_back(j);
+                elements.append((int)j);
+            }
+        }
+
+        MFnSingleIndexedComponent compFn;
+        data.vertexComponents = compFn.create(MFn::kMeshVertComponent);
+        compFn.addElements(elements);
+    }
+
+    return MStatus::kSuccess;
+}
+
+
+//
+// Description:
+//      Get the skin cluster settings, the weights of all vertices and
+//      the polygon vertices of the given mesh. Since the Maya API is
+//      not thread safe this runs on the main thread.
+//
+// Input Arguments:
+//      data                The mesh data.
+//
+// Return Value:
+//      MStatus             The MStatus for getting the weights.
+//
+MStatus smoothWeightsCmd::getMeshWeights(meshData &data)
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i, j;
+
+    MFnSkinCluster skinFn(data.skinObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    // Get the settings from the skin cluster node.
+    MFnDependencyNode skinMFn(data.skinObj);
+    unsigned int maxInfluences = (unsigned)skinMFn.findPlug("maxInfluences", false).asInt();
+    bool maintainMaxInfluences = skinMFn.findPlug("maintainMaxInfluences", false).asBool();
+    data.maxInfluences = maintainMaxInfluences ? maxInfluences : 0;
+    data.normalize = (unsigned)skinMFn.findPlug("normalizeWeights", false).asInt();
+
+    MDagPathArray influences;
+    skinFn.influenceObjects(influences);
+    data.influenceCount = influences.length();
+
+    data.influenceIndices.clear();
+    for (i = 0; i < data.influenceCount; i ++)
+        data.influenceIndices.append((int)i);
+
+    // Influences which are not part of the influences flag are treated
+    // as locked.
+    data.locks.assign(data.influenceCount, false);
+    if (!ignoreLockVal)
+        data.locks = getInfluenceLocks(influences);
+    if (influencesVal.length())
+    {
+        for (i = 0; i < data.influenceCount; i ++)
+        {
+            bool listed = false;
+            for (j = 0; j < influencesVal.length(); j ++)
+            {
+                if (influences[i].partialPathName() == influencesVal[j] ||
+                    influences[i].fullPathName() == influencesVal[j])
+                {
+                    listed = true;
+                    break;
+                }
+            }
+            if (!listed)
+                data.locks[i] = true;
+        }
+    }
+
+    // Get the weights of all vertices since the smoothing reads the
+    // weights of the neighbours outside the components.
+    MFnMesh meshFn(data.meshDag);
+    data.numVertices = (unsigned)meshFn.numVertices();
+
+    MFnSingleIndexedComponent allCompFn;
+    MObject allVtxCompObj = allCompFn.create(MFn::kMeshVertComponent);
+    allCompFn.setCompleteData((int)data.numVertices);
+
+    MDoubleArray allWeights;
+    status = skinFn.getWeights(data.meshDag, allVtxCompObj, allWeights, data.influenceCount);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    data.weights.resize(allWeights.length());
+    allWeights.get(data.weights.data());
+
+    MIntArray polyCounts;
+    MIntArray polyVertices;
+    meshFn.getVertices(polyCounts, polyVertices);
+
+    data.polyCounts.resize(polyCounts.length());
+    data.polyVertices.resize(polyVertices.length());
+    polyCounts.get(data.polyCounts.data());
+    polyVertices.get(data.polyVertices.data());
+
+    return status;
+}
+
+
+//
+// Description:
+//      Smooth the weights of the vertices of the given mesh. Only the
+//      plain arrays of the mesh data are used, which allows to smooth
+//      several meshes concurrently.
+//
+// Input Arguments:
+//      data                The mesh data.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsCmd::smoothMesh(meshData &data) const
+{
+    meshTopology topology;
+    topology.create(data.numVertices, data.polyCounts, data.polyVertices);
+
+    weightSmoother smoother;
+    smoother.create(data.influenceCount,
+                    data.locks,
+                    data.maxInfluences,
+                    data.normalize != 0);
+    smoother.smooth(topology, data.indices, strengthVal, (unsigned)iterationsVal, data.weights);
+
+    // The polygon vertices are not needed anymore.
+    std::vector<int>().swap(data.polyCounts);
+    std::vector<int>().swap(data.polyVertices);
+}
+
+
+//
+// Description:
+//      Copy the smoothed weights of the components to the redo weights
+//      in the order of the sorted indices and release the weights of
+//      all vertices.
+//
+// Input Arguments:
+//      data                The mesh data.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsCmd::setRedoWeights(meshData &data)
+{
+    unsigned int i, j;
+
+    unsigned int influenceCount = data.influenceCount;
+    unsigned int elementCount = (unsigned)data.indices.size();
+
+    data.redoWeights.setLength(elementCount * influenceCount);
+    for (i = 0; i < elementCount; i ++)
+    {
+        unsigned int offset = data.indices[i] * influenceCount;
+        for (j = 0; j < influenceCount; j ++)
+            data.redoWeights[i * influenceCount + j] = data.weights[offset + j];
+    }
+
+    std::vector<double>().swap(data.weights);
+}
+
+
+//
+// Description:
+//      Get the skin cluster of the given mesh.
+//
+// Input Arguments:
+//      meshDag             The dagPath of the mesh.
+//      skinClusterObj      The MObject of the found skin cluster node.
+//
+// Return Value:
+//      MStatus             The MStatus for the setting up the
+//                          dependency graph iterator.
+//
+MStatus smoothWeightsCmd::getSkinCluster(MDagPath meshDag, MObject &skinClusterObj)
+{
+    MStatus status;
+
+    MObject meshObj = meshDag.node();
+
+    MItDependencyGraph dependIter(meshObj,
+                                  MFn::kSkinClusterFilter,
+                                  MItDependencyGraph::kUpstream,
+                                  MItDependencyGraph::kDepthFirst,
+                                  MItDependencyGraph::kPlugLevel,
+                                  &status);
+    if (!status)
+    {
+        MGlobal::displayError("Failed setting up the dependency graph iterator.");
+        return status;
+    }
+
+    if (!dependIter.isDone())
+        skinClusterObj = dependIter.currentItem();
+
+    // Make sure that the mesh is bound to a skin cluster.
+    if (skinClusterObj.isNull())
+    {
+        MGlobal::displayError("The mesh " + meshDag.partialPathName() + " is not bound to a skin cluster.");
+        return MStatus::kNotFound;
+    }
+
+    return status;
+}
+
+
+//
+// Description:
+//      Return the lock states of the given influences.
+//
+// Input Arguments:
+//      dagPaths            The dagPath array of all influences.
+//
+// Return Value:
+//      bool array          The array of all influence lock states.
+//
+std::vector<bool> smoothWeightsCmd::getInfluenceLocks(MDagPathArray dagPaths)
+{
+    unsigned int i;
+
+    unsigned int numInfluences = dagPaths.length();
+
+    std::vector<bool> locks(numInfluences, false);
+
+    for (i = 0; i < dagPaths.length(); i ++)
+    {
+        MObject influenceObj = dagPaths[i].node();
+        MFnDependencyNode influenceFn(influenceObj);
+        MPlug lockPlug = influenceFn.findPlug("liw", false);
+        if (!lockPlug.isNull())
+            locks[i] = lockPlug.asBool();
+    }
+
+    return locks;
+}
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
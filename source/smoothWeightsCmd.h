@@ -0,0 +1,135 @@
+// ---------------------------------------------------------------------
+//
+//  smoothWeightsCmd.h
+//  brSmoothWeights
+//
+//  Copyright (c) 2021 Ingo Clemens. All rights reserved.
+//
+// ---------------------------------------------------------------------
+
+#ifndef __brSmoothWeights__smoothWeightsCmd__
+#define __brSmoothWeights__smoothWeightsCmd__
+
+#include <vector>
+
+#include <maya/MArgDatabase.h>
+#include <maya/MArgList.h>
+#include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MDoubleArray.h>
+#include <maya/MGlobal.h>
+#include <maya/MIntArray.h>
+#include <maya/MPxCommand.h>
+#include <maya/MSelectionList.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+#include <maya/MSyntax.h>
+
+// ---------------------------------------------------------------------
+// The command for smoothing the skin weights of meshes without the
+// tool context, i.e. for batch processing in pipeline scripts.
+//
+// The given meshes and vertex components get flood smoothed in surface
+// mode with the weightSmoother. The command doesn't depend on a view,
+// camera or selection and creates a single undo step for all meshes.
+// Several meshes are smoothed concurrently.
+//
+// brSmoothWeights -mesh "body" -iterations 10 -strength 0.5;
+// brSmoothWeights -components "body.vtx[0:99]" -influences "spine1";
+// ---------------------------------------------------------------------
+
+class smoothWeightsCmd : public MPxCommand
+{
+public:
+
+    smoothWeightsCmd();
+    ~smoothWeightsCmd();
+
+    static void* creator();
+    static MSyntax newSyntax();
+
+    MStatus parseArgs(const MArgList& args);
+
+    MStatus doIt(const MArgList &args);
+    MStatus redoIt();
+    MStatus undoIt();
+
+    bool isUndoable() const;
+
+private:
+
+    // The smoothing data of a single mesh.
+    struct meshData
+    {
+        MDagPath meshDag;
+        MObject skinObj;
+        MObject vertexComponents;
+        std::vector<unsigned int> indices;  // The sorted indices of the
+                                            // smoothed vertices.
+        MIntArray influenceIndices;
+        unsigned int influenceCount;
+        std::vector<bool> locks;            // True, if the influence
+                                            // keeps its weights.
+        unsigned int maxInfluences;         // 0, if the number of
+                                            // influences is not
+                                            // limited.
+        unsigned int normalize;
+        unsigned int numVertices;
+        std::vector<int> polyCounts;
+        std::vector<int> polyVertices;
+        std::vector<double> weights;        // The weights of all
+                                            // vertices.
+        MDoubleArray redoWeights;           // The smoothed weights of
+                                            // the components.
+        MDoubleArray undoWeights;           // The previous weights of
+                                            // the components.
+    };
+
+    MStringArray componentsVal;
+    bool ignoreLockVal;
+    MStringArray influencesVal;
+    int iterationsVal;
+    MStringArray meshVal;
+    double strengthVal;
+
+    std::vector<meshData> meshes;
+
+    MStatus getMeshes();
+    MStatus getMeshWeights(meshData &data);
+    void smoothMesh(meshData &data) const;
+    void setRedoWeights(meshData &data);
+
+    MStatus getSkinCluster(MDagPath meshDag, MObject &skinClusterObj);
+    std::vector<bool> getInfluenceLocks(MDagPathArray dagPaths);
+};
+
+#endif
+
+// ---------------------------------------------------------------------
+// MIT License
+//
+// Copyright (c) 2021 Ingo Clemens, brave rabbit
+// brSmoothWeights and brTransferWeights are under the terms of the MIT
+// License
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// Author: Ingo Clemens    www.braverabbit.com
+// ---------------------------------------------------------------------
@@ -33,26 +33,34 @@ smoothWeightsTool::smoothWeightsTool()
     setCommandString("brSmoothWeightsCmd");
 
     affectSelectedVal = true;
+    bindPoseVal = false;
     colorVal = MColor(0.0, 0.0, 0.0);
     curveVal = 2;
     depthVal = 1;
     depthStartVal = 1;
+    distanceVal = 0;
     drawBrushVal = true;
     drawRangeVal = true;
     enterToolCommandVal = "";
     exitToolCommandVal = "";
+    floodModeVal = 0;
+    floodToleranceVal = 0.0;
     fractionOversamplingVal = false;
     ignoreLockVal = false;
     keepShellsTogetherVal = true;
     lineWidthVal = 1;
     messageVal = 2;
+    mirrorVal = 0;
+    mirrorToleranceVal = 0.001;
     oversamplingVal = 1;
+    precisionVal = 0;
     rangeVal = 0.5;
     sizeVal = 5.0;
     strengthVal = 0.25;
     toleranceVal = 0.001;
     undersamplingVal = 2;
     volumeVal = false;
+    weightingVal = 0;
 }
 
 smoothWeightsTool::~smoothWeightsTool()
@@ -83,18 +91,26 @@ bool smoothWeightsTool::isUndoable() const
 
 #define kAffectSelectedFlag             "-as"
 #define kAffectSelectedFlagLong         "-affectSelected"
+#define kBindPoseFlag                   "-bp"
+#define kBindPoseFlagLong               "-bindPose"
+#define kCacheDirectoryFlag             "-cd"
+#define kCacheDirectoryFlagLong         "-cacheDirectory"
 #define kColorRFlag                     "-cr"
 #define kColorRFlagLong                 "-colorR"
 #define kColorGFlag                     "-cg"
 #define kColorGFlagLong                 "-colorG"
 #define kColorBFlag                     "-cb"
 #define kColorBFlagLong                 "-colorB"
+#define kCountersFlag                   "-cnt"
+#define kCountersFlagLong               "-counters"
 #define kCurveFlag                      "-c"
 #define kCurveFlagLong                  "-curve"
 #define kDepthFlag                      "-d"
 #define kDepthFlagLong                  "-depth"
 #define kDepthStartFlag                 "-ds"
 #define kDepthStartFlagLong             "-depthStart"
+#define kDistanceFlag                   "-dis"
+#define kDistanceFlagLong               "-distance"
 #define kDrawBrushFlag                  "-db"
 #define kDrawBrushFlagLong              "-drawBrush"
 #define kDrawRangeFlag                  "-dr"
@@ -105,6 +121,10 @@ bool smoothWeightsTool::isUndoable() const
 #define kExitToolCommandFlagLong        "-exitToolCommand"
 #define kFloodFlag                      "-f"
 #define kFloodFlagLong                  "-flood"
+#define kFloodModeFlag                  "-fm"
+#define kFloodModeFlagLong              "-floodMode"
+#define kFloodToleranceFlag             "-ftl"
+#define kFloodToleranceFlagLong         "-floodTolerance"
 #define kFractionOversamplingFlag       "-fo"
 #define kFractionOversamplingFlagLong   "-fractionOversampling"
 #define kIgnoreLockFlag                 "-il"
@@ -115,20 +135,36 @@ bool smoothWeightsTool::isUndoable() const
 #define kLineWidthFlagLong              "-lineWidth"
 #define kMessageFlag                    "-m"
 #define kMessageFlagLong                "-message"
+#define kMirrorFlag                     "-mir"
+#define kMirrorFlagLong                 "-mirror"
+#define kMirrorToleranceFlag            "-mtl"
+#define kMirrorToleranceFlagLong        "-mirrorTolerance"
 #define kOversamplingFlag               "-o"
 #define kOversamplingFlagLong           "-oversampling"
+#define kPrecisionFlag                  "-pr"
+#define kPrecisionFlagLong              "-precision"
 #define kRangeFlag                      "-r"
 #define kRangeFlagLong                  "-range"
 #define kSizeFlag                       "-s"
 #define kSizeFlagLong                   "-size"
+#define kStatsFlag                      "-sts"
+#define kStatsFlagLong                  "-stats"
 #define kStrengthFlag                   "-st"
 #define kStrengthFlagLong               "-strength"
 #define kToleranceFlag                  "-to"
 #define kToleranceFlagLong              "-tolerance"
+#define kTraceFlag                      "-tr"
+#define kTraceFlagLong                  "-trace"
+#define kTraceFileFlag                  "-tf"
+#define kTraceFileFlagLong              "-traceFile"
 #define kUndersamplingFlag              "-us"
 #define kUndersamplingFlagLong          "-undersampling"
 #define kVolumeFlag                     "-v"
 #define kVolumeFlagLong                 "-volume"
+#define kWeightingFlag                  "-wg"
+#define kWeightingFlagLong              "-weighting"
+#define kWriteTraceFlag                 "-wt"
+#define kWriteTraceFlagLong             "-writeTrace"
 
 
 MSyntax smoothWeightsTool::newSyntax()
@@ -136,28 +172,36 @@ MSyntax smoothWeightsTool::newSyntax()
     MSyntax syntax;
 
     syntax.addFlag(kAffectSelectedFlag, kAffectSelectedFlagLong, MSyntax::kBoolean);
+    syntax.addFlag(kBindPoseFlag, kBindPoseFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kColorRFlag, kColorRFlagLong, MSyntax::kDouble);
     syntax.addFlag(kColorGFlag, kColorGFlagLong, MSyntax::kDouble);
     syntax.addFlag(kColorBFlag, kColorBFlagLong, MSyntax::kDouble);
     syntax.addFlag(kCurveFlag, kCurveFlagLong, MSyntax::kLong);
     syntax.addFlag(kDepthFlag, kDepthFlagLong, MSyntax::kLong);
     syntax.addFlag(kDepthStartFlag, kDepthStartFlagLong, MSyntax::kLong);
+    syntax.addFlag(kDistanceFlag, kDistanceFlagLong, MSyntax::kLong);
     syntax.addFlag(kDrawBrushFlag, kDrawBrushFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kDrawRangeFlag, kDrawRangeFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kEnterToolCommandFlag, kEnterToolCommandFlagLong, MSyntax::kString);
     syntax.addFlag(kExitToolCommandFlag, kExitToolCommandFlagLong, MSyntax::kString);
+    syntax.addFlag(kFloodModeFlag, kFloodModeFlagLong, MSyntax::kLong);
+    syntax.addFlag(kFloodToleranceFlag, kFloodToleranceFlagLong, MSyntax::kDouble);
     syntax.addFlag(kFractionOversamplingFlag, kFractionOversamplingFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kIgnoreLockFlag, kIgnoreLockFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kKeepShellsTogetherFlag, kKeepShellsTogetherFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kLineWidthFlag, kLineWidthFlagLong, MSyntax::kLong);
     syntax.addFlag(kMessageFlag, kMessageFlagLong, MSyntax::kLong);
+    syntax.addFlag(kMirrorFlag, kMirrorFlagLong, MSyntax::kLong);
+    syntax.addFlag(kMirrorToleranceFlag, kMirrorToleranceFlagLong, MSyntax::kDouble);
     syntax.addFlag(kOversamplingFlag, kOversamplingFlagLong, MSyntax::kLong);
+    syntax.addFlag(kPrecisionFlag, kPrecisionFlagLong, MSyntax::kLong);
     syntax.addFlag(kRangeFlag, kRangeFlagLong, MSyntax::kDouble);
     syntax.addFlag(kSizeFlag, kSizeFlagLong, MSyntax::kDouble);
     syntax.addFlag(kStrengthFlag, kStrengthFlagLong, MSyntax::kDouble);
     syntax.addFlag(kToleranceFlag, kToleranceFlagLong, MSyntax::kDouble);
     syntax.addFlag(kUndersamplingFlag, kUndersamplingFlagLong, MSyntax::kLong);
     syntax.addFlag(kVolumeFlag, kVolumeFlagLong, MSyntax::kBoolean);
+    syntax.addFlag(kWeightingFlag, kWeightingFlagLong, MSyntax::kLong);
 
     return syntax;
 }
@@ -174,6 +218,11 @@ MStatus smoothWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kAffectSelectedFlag, 0, affectSelectedVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kBindPoseFlag))
+    {
+        status = argData.getFlagArgument(kBindPoseFlag, 0, bindPoseVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kColorRFlag))
     {
         double value;
@@ -210,6 +259,11 @@ MStatus smoothWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kDepthStartFlag, 0, depthStartVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kDistanceFlag))
+    {
+        status = argData.getFlagArgument(kDistanceFlag, 0, distanceVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kDrawBrushFlag))
     {
         status = argData.getFlagArgument(kDrawBrushFlag, 0, drawBrushVal);
@@ -230,6 +284,16 @@ MStatus smoothWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kExitToolCommandFlag, 0, exitToolCommandVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kFloodModeFlag))
+    {
+        status = argData.getFlagArgument(kFloodModeFlag, 0, floodModeVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+    if (argData.isFlagSet(kFloodToleranceFlag))
+    {
+        status = argData.getFlagArgument(kFloodToleranceFlag, 0, floodToleranceVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kFractionOversamplingFlag))
     {
         status = argData.getFlagArgument(kFractionOversamplingFlag, 0, fractionOversamplingVal);
@@ -255,11 +319,26 @@ MStatus smoothWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kMessageFlag, 0, messageVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kMirrorFlag))
+    {
+        status = argData.getFlagArgument(kMirrorFlag, 0, mirrorVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+    if (argData.isFlagSet(kMirrorToleranceFlag))
+    {
+        status = argData.getFlagArgument(kMirrorToleranceFlag, 0, mirrorToleranceVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kOversamplingFlag))
     {
         status = argData.getFlagArgument(kOversamplingFlag, 0, oversamplingVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kPrecisionFlag))
+    {
+        status = argData.getFlagArgument(kPrecisionFlag, 0, precisionVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kRangeFlag))
     {
         status = argData.getFlagArgument(kRangeFlag, 0, rangeVal);
@@ -290,6 +369,11 @@ MStatus smoothWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kVolumeFlag, 0, volumeVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kWeightingFlag))
+    {
+        status = argData.getFlagArgument(kWeightingFlag, 0, weightingVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
 
     return status;
 }
@@ -407,6 +491,8 @@ MStatus smoothWeightsTool::finalize()
     cmd += "-image1 \"brSmoothWeights.svg\" -image2 \"vacantCell.png\" -image3 \"vacantCell.png\"";
     cmd += " " + MString(kAffectSelectedFlag) + " ";
     cmd += affectSelectedVal;
+    cmd += " " + MString(kBindPoseFlag) + " ";
+    cmd += bindPoseVal;
     cmd += " " + MString(kColorRFlag) + " ";
     cmd += colorVal.r;
     cmd += " " + MString(kColorGFlag) + " ";
@@ -419,6 +505,8 @@ MStatus smoothWeightsTool::finalize()
     cmd += depthVal;
     cmd += " " + MString(kDepthStartFlag) + " ";
     cmd += depthStartVal;
+    cmd += " " + MString(kDistanceFlag) + " ";
+    cmd += distanceVal;
     cmd += " " + MString(kDrawBrushFlag) + " ";
     cmd += drawBrushVal;
     cmd += " " + MString(kDrawRangeFlag) + " ";
@@ -427,6 +515,10 @@ MStatus smoothWeightsTool::finalize()
     cmd += "\"" + enterToolCommandVal + "\"";
     cmd += " " + MString(kExitToolCommandFlag) + " ";
     cmd += "\"" + exitToolCommandVal + "\"";
+    cmd += " " + MString(kFloodModeFlag) + " ";
+    cmd += floodModeVal;
+    cmd += " " + MString(kFloodToleranceFlag) + " ";
+    cmd += floodToleranceVal;
     cmd += " " + MString(kFractionOversamplingFlag) + " ";
     cmd += fractionOversamplingVal;
     cmd += " " + MString(kIgnoreLockFlag) + " ";
@@ -437,8 +529,14 @@ MStatus smoothWeightsTool::finalize()
     cmd += lineWidthVal;
     cmd += " " + MString(kMessageFlag) + " ";
     cmd += messageVal;
+    cmd += " " + MString(kMirrorFlag) + " ";
+    cmd += mirrorVal;
+    cmd += " " + MString(kMirrorToleranceFlag) + " ";
+    cmd += mirrorToleranceVal;
     cmd += " " + MString(kOversamplingFlag) + " ";
     cmd += oversamplingVal;
+    cmd += " " + MString(kPrecisionFlag) + " ";
+    cmd += precisionVal;
     cmd += " " + MString(kRangeFlag) + " ";
     cmd += rangeVal;
     cmd += " " + MString(kSizeFlag) + " ";
@@ -451,6 +549,8 @@ MStatus smoothWeightsTool::finalize()
     cmd += undersamplingVal;
     cmd += " " + MString(kVolumeFlag) + " ";
     cmd += volumeVal;
+    cmd += " " + MString(kWeightingFlag) + " ";
+    cmd += weightingVal;
     cmd += " brSmoothWeightsContext1;";
 
     MGlobal::setOptionVarValue("brSmoothWeightsContext1", cmd);
@@ -474,6 +574,12 @@ void smoothWeightsTool::setAffectSelected(bool value)
 }
 
 
+void smoothWeightsTool::setBindPose(bool value)
+{
+    bindPoseVal = value;
+}
+
+
 void smoothWeightsTool::setColor(MColor value)
 {
     colorVal = value;
@@ -498,6 +604,12 @@ void smoothWeightsTool::setDepthStart(int value)
 }
 
 
+void smoothWeightsTool::setDistance(int value)
+{
+    distanceVal = value;
+}
+
+
 void smoothWeightsTool::setDrawBrush(bool value)
 {
     drawBrushVal = value;
@@ -522,6 +634,18 @@ void smoothWeightsTool::setExitToolCommand(MString value)
 }
 
 
+void smoothWeightsTool::setFloodMode(int value)
+{
+    floodModeVal = value;
+}
+
+
+void smoothWeightsTool::setFloodTolerance(double value)
+{
+    floodToleranceVal = value;
+}
+
+
 void smoothWeightsTool::setFractionOversampling(bool value)
 {
     fractionOversamplingVal = value;
@@ -552,12 +676,30 @@ void smoothWeightsTool::setMessage(int value)
 }
 
 
+void smoothWeightsTool::setMirror(int value)
+{
+    mirrorVal = value;
+}
+
+
+void smoothWeightsTool::setMirrorTolerance(double value)
+{
+    mirrorToleranceVal = value;
+}
+
+
 void smoothWeightsTool::setOversampling(int value)
 {
     oversamplingVal = value;
 }
 
 
+void smoothWeightsTool::setPrecision(int value)
+{
+    precisionVal = value;
+}
+
+
 void smoothWeightsTool::setRange(double value)
 {
     rangeVal = value;
@@ -594,6 +736,12 @@ void smoothWeightsTool::setVolume(bool value)
 }
 
 
+void smoothWeightsTool::setWeighting(int value)
+{
+    weightingVal = value;
+}
+
+
 // ---------------------------------------------------------------------
 // public methods for setting the undo/redo variables
 // ---------------------------------------------------------------------
@@ -662,26 +810,55 @@ smoothWeightsContext::smoothWeightsContext()
     // These values will be used to reset the tool from the tool
     // properties window.
     affectSelectedVal = true;
+    bindPoseVal = false;
+    cacheDirectoryVal = "";
     colorVal = MColor(0.0, 0.0, 0.0);
     curveVal = 2;
     depthVal = 1;
     depthStartVal = 1;
+    distanceVal = 0;
     drawBrushVal = true;
     drawRangeVal = true;
     enterToolCommandVal = "";
     exitToolCommandVal = "";
+    floodModeVal = 0;
+    floodToleranceVal = 0.0;
     fractionOversamplingVal = false;
     ignoreLockVal = false;
     keepShellsTogetherVal = true;
     lineWidthVal = 1;
     messageVal = 2;
+    mirrorVal = 0;
+    mirrorToleranceVal = 0.001;
     oversamplingVal = 1;
+    precisionVal = 0;
     rangeVal = 0.5;
     sizeVal = 5.0;
     strengthVal = 0.25;
     toleranceVal = 0.001;
+    traceFileVal = "";
     undersamplingVal = 2;
     volumeVal = false;
+    weightingVal = 0;
+
+    // Record the timed stages in the trace while it's enabled.
+    stats.setTrace(&trace);
+
+    // The caches are only used while a cache directory is set.
+    saveCallbackId = 0;
+    topologyHash = 0;
+    topologyCached = false;
+    topologyPairCount = 0;
+
+    // The mirror stamps get initialized with the mirror map.
+    mirrorGeneration = 0;
+
+    // The heat method is only tried once per mesh.
+    heatFailed = false;
+
+    // All data gets read on the first press.
+    dirtyLayers = kDirtyAll;
+    ignoreWeightChanges = false;
 
     // True, only if the smoothing is performed. False when adjusting
     // the brush settings. It's used to control whether undo/redo needs
@@ -690,6 +867,15 @@ smoothWeightsContext::smoothWeightsContext()
 }
 
 
+smoothWeightsContext::~smoothWeightsContext()
+{
+    removeDirtyCallbacks();
+
+    if (saveCallbackId != 0)
+        MMessage::removeCallback(saveCallbackId);
+}
+
+
 void smoothWeightsContext::toolOnSetup(MEvent &)
 {
     setHelpString(helpString);
@@ -698,6 +884,10 @@ void smoothWeightsContext::toolOnSetup(MEvent &)
 
     MGlobal::executeCommand(enterToolCommandVal);
 
+    // The statistics only cover the strokes of the current tool
+    // session.
+    stats.clear();
+
     getMesh();
 }
 
@@ -706,6 +896,13 @@ void smoothWeightsContext::toolOffCleanup()
 {
     setInViewMessage(false);
 
+    // Store the adjacency and the opposite vertices which have been
+    // found while painting.
+    writeTopologyCache();
+
+    // Nothing tracks the changes while the tool is inactive.
+    removeDirtyCallbacks();
+
     MGlobal::executeCommand(exitToolCommandVal);
 }
 
@@ -826,6 +1023,27 @@ MStatus smoothWeightsContext::doDrag(MEvent &event,
 
                 drawManager.circle2d(end, lineWidthVal + 3.0, true);
             }
+
+            // Display the current value below the initial adjust
+            // position of the cursor, since the y axis of the screen
+            // points up and the strength line gets drawn upwards.
+            // Drawing the text natively is much faster than a heads-up
+            // message which needs to be evaluated through MEL with
+            // every drag event.
+            MString message = "Brush Size";
+            if (!sizeAdjust)
+                message = "Brush Strength";
+
+            char info[32];
+#ifdef _WIN64
+            sprintf_s(info, "%s: %.2f", message.asChar(), adjustValue);
+#else
+            sprintf(info, "%s: %.2f", message.asChar(), adjustValue);
+#endif
+
+            MPoint textPos(startScreenX, startScreenY - 50);
+            drawManager.setFontSize(MHWRender::MUIDrawManager::kDefaultFontSize);
+            drawManager.text2d(textPos, MString(info), MHWRender::MUIDrawManager::kCenter);
         }
     }
 
@@ -859,6 +1077,10 @@ MStatus smoothWeightsContext::doPressCommon(MEvent event)
     if (meshDag.node().isNull())
         return MStatus::kNotFound;
 
+    stats.beginStroke();
+    counters.clear();
+    scopedTimer timer(stats, strokeStats::kPress);
+
     // initialize
     undersamplingSteps = 0;
     performBrush = false;
@@ -866,14 +1088,6 @@ MStatus smoothWeightsContext::doPressCommon(MEvent event)
     view = M3dView::active3dView();
     event.getPosition(screenX, screenY);
 
-    // Get the size of the viewport and calculate the center for placing
-    // the value messages when adjusting the brush settings.
-    unsigned int x;
-    unsigned int y;
-    view.viewport(x, y, width, height);
-    viewCenterX = (short)width / 2;
-    viewCenterY = (short)height / 2;
-
     // Store the initial mouse position. These get used when adjusting
     // the brush size and strength values.
     startScreenX = screenX;
@@ -888,13 +1102,51 @@ MStatus smoothWeightsContext::doPressCommon(MEvent event)
     // the current lock states of all influences
     // -----------------------------------------------------------------
 
-    influenceLocks = getInfluenceLocks(inflDagPaths);
+    // Only the data which has changed since the last press gets
+    // refreshed.
+    if (dirtyLayers & kDirtyInfluences)
+    {
+        influenceIndices = getInfluenceIndices(skinObj, inflDagPaths);
+
+        unsigned int normalizeValue;
+        getSkinClusterAttributes(skinObj,
+                                 maxInfluences,
+                                 maintainMaxInfluences,
+                                 normalizeValue);
+        normalize = false;
+        if (normalizeValue > 0)
+            normalize = true;
+
+        // Follow the lock states of the new influences. This also
+        // marks the locks and the weights for refreshing.
+        addDirtyCallbacks();
+        dirtyLayers &= ~kDirtyInfluences;
+    }
+
+    if (dirtyLayers & kDirtyLocks)
+    {
+        influenceLocks = getInfluenceLocks(inflDagPaths);
+        dirtyLayers &= ~kDirtyLocks;
+    }
+
+    // The number of locked influences is needed for maintaining the
+    // max influences with the compacted influence lists.
+    lockedCount = 0;
+    for (i = 0; i < influenceLocks.size(); i ++)
+    {
+        if (isLocked(i))
+            lockedCount ++;
+    }
 
     // -----------------------------------------------------------------
     // vertex selection
     // -----------------------------------------------------------------
 
-    vtxSelection = getSelectionVertices();
+    if (dirtyLayers & kDirtySelection)
+    {
+        vtxSelection = getSelectionVertices();
+        dirtyLayers &= ~kDirtySelection;
+    }
     unsigned int numSelection = vtxSelection.length();
 
     // Create an array marking which indices are affected. This depends
@@ -906,13 +1158,45 @@ MStatus smoothWeightsContext::doPressCommon(MEvent event)
     for (i = 0; i < numSelection; i ++)
         selectedIndices[(unsigned)vtxSelection[i]] = !state;
 
+    // -----------------------------------------------------------------
+    // bind pose
+    // -----------------------------------------------------------------
+
+    // The positions of the input geometry don't change when the rig
+    // gets posed and only need to be captured once for the mesh.
+    if (bindPoseVal && bindPoints.length() != numVertices)
+        captureBindPose();
+
+    // -----------------------------------------------------------------
+    // mirror
+    // -----------------------------------------------------------------
+
+    if (mirrorVal > 0 && mirrorVal < 4)
+        updateMirror();
+
+    // -----------------------------------------------------------------
+    // smoothing weights
+    // -----------------------------------------------------------------
+
+    // The cotangent weights are computed once per mesh and are shared
+    // by painting and flooding.
+    if (weightingVal == 1 && !volumeVal)
+        updateSmoothingOperator();
+
     // -----------------------------------------------------------------
     // closest point on surface
     // -----------------------------------------------------------------
 
+    // The brush range and the smoothing read the cached adjacency and
+    // positions of the mesh. Make sure these match the current shape.
+    updateTopology();
+
     // Getting the closest index cannot be performed when in flood mode.
     if (eventIsValid(event))
     {
+        if (distanceVal == 2 && !volumeVal)
+            updateHeatDistance();
+
         // Get the vertex index which is closest to the cursor position.
         // This method also defines the surface point and view vector.
         MIntArray closestIndices;
@@ -974,7 +1258,31 @@ MStatus smoothWeightsContext::doPressCommon(MEvent event)
         // undo/redo unreliable. It might be possible with a different
         // approach though.
         else
-            getAllWeights();
+        {
+            // The weights only need to be read again if they have been
+            // changed outside of the strokes. In single precision mode
+            // the undo weights need to be read in double precision.
+            if ((dirtyLayers & kDirtyWeights) ||
+                precisionVal == 1 ||
+                currentWeights.length() != numVertices * influenceCount)
+            {
+                getAllWeights();
+                dirtyLayers &= ~kDirtyWeights;
+            }
+            else
+                prevWeights.copy(currentWeights);
+
+            // The smoothing merges the influences with a weight of the
+            // neighbours instead of testing all influences.
+            smoother.create(influenceCount,
+                            influenceLocks,
+                            maintainMaxInfluences ? maxInfluences : 0,
+                            normalize);
+            if (singleWeights.empty())
+                smoother.createInfluenceLists(currentWeights, numVertices);
+            else
+                smoother.createInfluenceLists(singleWeights, numVertices);
+        }
     }
     return status;
 }
@@ -1001,8 +1309,12 @@ MStatus smoothWeightsContext::doDragCommon(MEvent event)
     // -----------------------------------------------------------------
     if (event.mouseButton() == MEvent::kLeftMouse)
     {
+        traceSpan dabSpan(trace, "dab", "brush");
+
         MIntArray closestIndices;
         MFloatArray closestDistances;
+        counters.add(strokeCounters::kArrays, 2);
+
         if (!getClosestIndex(event, closestIndices, closestDistances))
             return MStatus::kNotFound;
 
@@ -1051,8 +1363,6 @@ MStatus smoothWeightsContext::doDragCommon(MEvent event)
 
         // Define the settings for either setting the brush size or the
         // brush strength.
-        MString message = "Brush Size";
-        MString slider = "Size";
         double dragDistance = deltaPos.x;
         double min = 0.0;
         unsigned int max = 1000;
@@ -1065,8 +1375,6 @@ MStatus smoothWeightsContext::doDragCommon(MEvent event)
         // Vary the settings if the strength gets adjusted.
         if (!sizeAdjust)
         {
-            message = "Brush Strength";
-            slider = "Strength";
             dragDistance = deltaPos.y;
             max = 1;
             baseValue = strengthVal;
@@ -1089,39 +1397,11 @@ MStatus smoothWeightsContext::doDragCommon(MEvent event)
 
         // Store the modified value for drawing and for setting the
         // values when releasing the mouse button.
+        // The value display happens in the viewport 2.0 draw method
+        // and the tool settings slider gets updated once the mouse
+        // button is released. Executing any MEL commands for each drag
+        // event would slow down the adjustment considerably.
         adjustValue = value;
-
-        // -------------------------------------------------------------
-        // value display in the viewport
-        // -------------------------------------------------------------
-        char info[32];
-#ifdef _WIN64
-        sprintf_s(info, "%s: %.2f", message.asChar(), adjustValue);
-#else
-        sprintf(info, "%s: %.2f", message.asChar(), adjustValue);
-#endif
-
-        // Calculate the position for the value display. Since the
-        // heads-up message starts at the center of the viewport an
-        // offset needs to get calculated based on the view size and the
-        // initial adjust position of the cursor.
-        short offsetX = startScreenX - viewCenterX;
-        short offsetY = startScreenY - viewCenterY - 50;
-
-        MString cmd = "headsUpMessage -horizontalOffset ";
-        cmd += offsetX;
-        cmd += " -verticalOffset ";
-        cmd += offsetY;
-        cmd += " -time 0.1 ";
-        cmd += "\"" + MString(info) + "\"";
-        MGlobal::executeCommand(cmd);
-
-        // Also, adjust the slider in the tool settings window if it's
-        // currently open.
-        MString tool("brSmoothWeights");
-        MGlobal::executeCommand("if (`columnLayout -exists " + tool + "`) " +
-                                "floatSliderGrp -edit -value " + (MString() + adjustValue) + " " +
-                                tool + slider + ";");
     }
 
     return status;
@@ -1138,15 +1418,29 @@ void smoothWeightsContext::doReleaseCommon(MEvent event)
     // stored.
     if (event.mouseButton() == MEvent::kMiddleMouse)
     {
+        MString slider = "Size";
         if (sizeAdjust)
             sizeVal = adjustValue;
         else
+        {
             strengthVal = adjustValue;
+            slider = "Strength";
+        }
+
+        // Adjust the slider in the tool settings window if it's
+        // currently open. This only needs to happen once with the final
+        // value rather than with every drag event.
+        MString tool("brSmoothWeights");
+        MGlobal::executeCommand("if (`columnLayout -exists " + tool + "`) " +
+                                "floatSliderGrp -edit -value " + (MString() + adjustValue) + " " +
+                                tool + slider + ";");
     }
 
     // Refresh the view to erase the drawn circle. This might not
     // always be necessary but is just included to complete the process.
+    scopedTimer refreshTimer(stats, strokeStats::kRefresh);
     view.refresh(false, true);
+    refreshTimer.stop();
 
     // If the smoothing has been performed send the current values to
     // the tool command along with the necessary data for undo and redo.
@@ -1156,26 +1450,34 @@ void smoothWeightsContext::doReleaseCommon(MEvent event)
         cmd = (smoothWeightsTool*)newToolCommand();
 
         cmd->setAffectSelected(affectSelectedVal);
+        cmd->setBindPose(bindPoseVal);
         cmd->setColor(colorVal);
         cmd->setCurve(curveVal);
         cmd->setDepth(depthVal);
         cmd->setDepthStart(depthStartVal);
+        cmd->setDistance(distanceVal);
         cmd->setDrawBrush(drawBrushVal);
         cmd->setDrawRange(drawRangeVal);
         cmd->setEnterToolCommand(enterToolCommandVal);
         cmd->setExitToolCommand(exitToolCommandVal);
+        cmd->setFloodMode(floodModeVal);
+        cmd->setFloodTolerance(floodToleranceVal);
         cmd->setFractionOversampling(fractionOversamplingVal);
         cmd->setIgnoreLock(ignoreLockVal);
         cmd->setKeepShellsTogether(keepShellsTogetherVal);
         cmd->setLineWidth(lineWidthVal);
         cmd->setMessage(messageVal);
+        cmd->setMirror(mirrorVal);
+        cmd->setMirrorTolerance(mirrorToleranceVal);
         cmd->setOversampling(oversamplingVal);
+        cmd->setPrecision(precisionVal);
         cmd->setRange(rangeVal);
         cmd->setSize(sizeVal);
         cmd->setStrength(strengthVal);
         cmd->setTolerance(toleranceVal);
         cmd->setUndersampling(undersamplingVal);
         cmd->setVolume(volumeVal);
+        cmd->setWeighting(weightingVal);
 
         cmd->setMesh(meshDag);
         cmd->setSkinCluster(skinObj);
@@ -1193,6 +1495,11 @@ void smoothWeightsContext::doReleaseCommon(MEvent event)
 
         cmd->finalize();
     }
+
+    // Write the trace with all strokes since the tracing has been
+    // enabled.
+    if (trace.isEnabled() && traceFileVal.length())
+        writeTrace(traceFileVal);
 }
 
 
@@ -1208,6 +1515,9 @@ MStatus smoothWeightsContext::getMesh()
     meshDag = MDagPath();
     skinObj = MObject();
 
+    // The callbacks belong to the previous mesh.
+    removeDirtyCallbacks();
+
     // Clear the weights arrays. Especially the prevWeights array since
     // this stores the weights for undo. Since the prevWeights are only
     // collected when smoothing and not in select mode this would cause
@@ -1216,6 +1526,7 @@ MStatus smoothWeightsContext::getMesh()
     // to the undo weights from the previous mesh. Therefore it's
     // necessary to remove all previous weights when the tool changes.
     currentWeights.clear();
+    singleWeights.clear();
     prevWeights.clear();
 
     // -----------------------------------------------------------------
@@ -1244,6 +1555,26 @@ MStatus smoothWeightsContext::getMesh()
     indexMap = MIntArray(numVertices, -1);
     computeIndex = std::vector<bool>(numVertices, true);
 
+    // The topology for the geodesic distance and the heat method
+    // operators get built when they are needed for the first time.
+    topology.clear();
+    heat.clear();
+    heatFailed = false;
+    operators.clear();
+    smoothing.clear();
+    multigrid.clear();
+
+    // The positions of the input geometry get captured with the
+    // next press if the distances are measured in bind pose.
+    bindPoints.clear();
+
+    // The mirror map belongs to the previous mesh.
+    mirror.clear();
+
+    // Meshes with the same connectivity share the adjacency and the
+    // opposite border vertices through the topology cache.
+    readTopologyCache();
+
     // -----------------------------------------------------------------
     // skin cluster
     // -----------------------------------------------------------------
@@ -1278,10 +1609,166 @@ MStatus smoothWeightsContext::getMesh()
     if (normalizeValue > 0)
         normalize = true;
 
+
+    // -----------------------------------------------------------------
+    // dirty callbacks
+    // -----------------------------------------------------------------
+
+    // Track the changes of the mesh, the skin cluster, the influences
+    // and the selection so that a press only refreshes the data which
+    // has changed. The influences are already up to date.
+    addDirtyCallbacks();
+    dirtyLayers &= ~kDirtyInfluences;
+
     return status;
 }
 
 
+//
+// Description:
+//      Register the callbacks which mark the cached data as dirty when
+//      the mesh, the weights, the influences, the lock states or the
+//      selection change.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::addDirtyCallbacks()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    removeDirtyCallbacks();
+
+    MCallbackId id;
+
+    MObject meshObj = meshDag.node();
+    id = MNodeMessage::addNodeDirtyPlugCallback(meshObj, meshDirtyCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+
+    id = MNodeMessage::addAttributeChangedCallback(skinObj, skinAttributeCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+
+    for (i = 0; i < inflDagPaths.length(); i ++)
+    {
+        MObject influenceObj = inflDagPaths[i].node();
+        id = MNodeMessage::addAttributeChangedCallback(influenceObj, lockAttributeCallback, this, &status);
+        if (status)
+            dirtyCallbackIds.append(id);
+    }
+
+    // Adding or removing influences changes the connections of the
+    // skin cluster.
+    id = MDGMessage::addConnectionCallback(connectionCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+
+    id = MModelMessage::addCallback(MModelMessage::kActiveListModified, selectionCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+}
+
+
+//
+// Description:
+//      Remove all dirty callbacks. Since the changes are not tracked
+//      anymore all cached data is considered dirty.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::removeDirtyCallbacks()
+{
+    if (dirtyCallbackIds.length())
+    {
+        MMessage::removeCallbacks(dirtyCallbackIds);
+        dirtyCallbackIds.clear();
+    }
+
+    dirtyLayers = kDirtyAll;
+}
+
+
+void smoothWeightsContext::meshDirtyCallback(MObject &, MPlug &, void *data)
+{
+    smoothWeightsContext *context = static_cast<smoothWeightsContext*>(data);
+    if (!context->useBindPose())
+        context->dirtyLayers |= kDirtyPoints;
+}
+
+
+void smoothWeightsContext::skinAttributeCallback(MNodeMessage::AttributeMessage message,
+                                                      MPlug &plug,
+                                                      MPlug &,
+                                                      void *data)
+{
+    smoothWeightsContext *context = static_cast<smoothWeightsContext*>(data);
+
+    if (!(message & MNodeMessage::kAttributeSet))
+        return;
+
+    if (context->ignoreWeightChanges)
+        return;
+
+    MFnAttribute attrFn(plug.attribute());
+    MString name = attrFn.name();
+    if (name == "weightList" || name == "weights")
+        context->dirtyLayers |= kDirtyWeights;
+    else if (name == "maxInfluences" ||
+             name == "maintainMaxInfluences" ||
+             name == "normalizeWeights")
+        context->dirtyLayers |= kDirtyInfluences;
+}
+
+
+void smoothWeightsContext::lockAttributeCallback(MNodeMessage::AttributeMessage message,
+                                                      MPlug &plug,
+                                                      MPlug &,
+                                                      void *data)
+{
+    smoothWeightsContext *context = static_cast<smoothWeightsContext*>(data);
+
+    if (!(message & MNodeMessage::kAttributeSet))
+        return;
+
+    MFnAttribute attrFn(plug.attribute());
+    if (attrFn.name() == "lockInfluenceWeights")
+        context->dirtyLayers |= kDirtyLocks;
+}
+
+
+void smoothWeightsContext::connectionCallback(MPlug &,
+                                                   MPlug &destinationPlug,
+                                                   bool,
+                                                   void *data)
+{
+    smoothWeightsContext *context = static_cast<smoothWeightsContext*>(data);
+
+    if (context->skinObj.isNull() || destinationPlug.node() != context->skinObj)
+        return;
+
+    MFnAttribute attrFn(destinationPlug.attribute());
+    if (attrFn.name() == "matrix")
+        context->dirtyLayers |= kDirtyInfluences;
+}
+
+
+void smoothWeightsContext::selectionCallback(void *data)
+{
+    smoothWeightsContext *context = static_cast<smoothWeightsContext*>(data);
+    context->dirtyLayers |= kDirtySelection;
+}
+
+
 //
 // Description:
 //      Get the dagPath of the currently selected object's shape node.
@@ -1473,7 +1960,8 @@ MStatus smoothWeightsContext::getSkinCluster(MDagPath meshDag, MObject &skinClus
 //
 // Description:
 //      Get weights for all vertices and populate the currentWeights
-//      array. Also copy the weights to the prevWeights array for undo.
+//      array or the singleWeights array, depending on the precision.
+//      Also copy the weights to the prevWeights array for undo.
 //
 // Input Arguments:
 //      None
@@ -1485,55 +1973,393 @@ MStatus smoothWeightsContext::getAllWeights()
 {
     MStatus status = MStatus::kSuccess;
 
-    MFnSkinCluster skinFn(skinObj, &status);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-    skinFn.getWeights(meshDag, allVtxCompObj, currentWeights, influenceCount);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    // Reading the weights from the skin cluster is the most expensive
+    // part of the first stroke on a large mesh. The cached weights are
+    // used instead while the scene is unchanged since it was saved.
+    if (!getCachedWeights())
+    {
+        MFnSkinCluster skinFn(skinObj, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        skinFn.getWeights(meshDag, allVtxCompObj, currentWeights, influenceCount);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     // Copy the current weights for undo.
     prevWeights.copy(currentWeights);
 
+    // In single precision mode the smoothing works on a float copy of
+    // the weights, which halves the memory to read and write for each
+    // vertex. The double precision weights are only kept for undo.
+    singleWeights.clear();
+    if (precisionVal == 1)
+    {
+        unsigned int count = currentWeights.length();
+        singleWeights.resize(count);
+        for (unsigned int i = 0; i < count; i ++)
+            singleWeights[i] = (float)currentWeights[i];
+        currentWeights.clear();
+    }
+
     return status;
 }
 
 
 //
 // Description:
-//      Get the influence attributes from the given skin cluster object.
+//      Read the weights of all vertices from the weight cache. The
+//      cache is only used if it belongs to the current skin cluster
+//      and influences and if the scene is unchanged since it was saved
+//      together with the cache.
 //
 // Input Arguments:
-//      skinCluster             The MObject of the skin cluster node.
-//      maxInfluences           The max number of influences per vertex.
-//      maintainMaxInfluences   True, if the max influences count should
-//                              be maintained.
-//      normalize               True, if the weights are normalized.
+//      None
 //
 // Return Value:
-//      None
+//      bool                True, if the weights have been read from the
+//                          cache.
 //
-void smoothWeightsContext::getSkinClusterAttributes(MObject skinCluster,
-                                                    unsigned int &maxInfluences,
-                                                    bool &maintainMaxInfluences,
-                                                    unsigned int &normalize)
+bool smoothWeightsContext::getCachedWeights()
 {
-    // Get the settings from the skin cluster node.
-    MFnDependencyNode skinMFn(skinCluster);
+    unsigned int i;
 
-    MPlug maxInflPlug = skinMFn.findPlug("maxInfluences", false);
-    maxInfluences = (unsigned)maxInflPlug.asInt();
+    if (!cacheDirectoryVal.length())
+        return false;
 
-    MPlug maintainInflPlug = skinMFn.findPlug("maintainMaxInfluences", false);
-    maintainMaxInfluences = maintainInflPlug.asBool();
+    // Any change after opening or saving the scene, including the
+    // strokes of the tool, can affect the weights.
+    int modified = 1;
+    MGlobal::executeCommand("file -query -modified", modified);
+    if (modified)
+        return false;
 
-    MPlug normalizePlug = skinMFn.findPlug("normalizeWeights", false);
-    normalize = (unsigned)normalizePlug.asInt();
-}
+    unsigned long long key = getSceneKey();
+    if (key == 0)
+        return false;
 
+    weightCache cache;
+    if (!cache.open(getWeightCachePath().asChar()))
+        return false;
 
-//
-// Description:
-//      Return the influence indices of all influences of the given
-//      skin cluster node.
-//
+    MFnDependencyNode skinMFn(skinObj);
+    if (cache.key() != key ||
+        cache.name() != skinMFn.name().asChar() ||
+        cache.vertexCount() != numVertices ||
+        cache.influenceCount() != inflDagPaths.length())
+        return false;
+
+    for (i = 0; i < inflDagPaths.length(); i ++)
+    {
+        if (cache.influenceName(i) != inflDagPaths[i].partialPathName().asChar())
+            return false;
+    }
+
+    std::vector<double> weights((size_t)numVertices * inflDagPaths.length());
+    if (!cache.expand(weights.data()))
+        return false;
+
+    currentWeights = MDoubleArray(weights.data(), (unsigned)weights.size());
+    influenceCount = inflDagPaths.length();
+
+    return true;
+}
+
+
+//
+// Description:
+//      Write the weights of the current skin cluster to the weight
+//      cache. The weights are read from the skin cluster because the
+//      current weights of the tool are only updated when painting.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::writeWeightCache()
+{
+    unsigned int i;
+
+    MStatus status = MStatus::kSuccess;
+
+    if (!cacheDirectoryVal.length() || !MObjectHandle(skinObj).isValid() || !meshDag.isValid())
+        return;
+
+    unsigned long long key = getSceneKey();
+    if (key == 0)
+        return;
+
+    MFnSkinCluster skinFn(skinObj, &status);
+    if (!status)
+        return;
+
+    MDoubleArray weights;
+    unsigned int count = 0;
+    status = skinFn.getWeights(meshDag, allVertexComponents(meshDag), weights, count);
+    if (!status || count == 0)
+        return;
+
+    MDagPathArray dagPaths;
+    skinFn.influenceObjects(dagPaths);
+    if (dagPaths.length() != count)
+        return;
+
+    std::vector<std::string> names(count);
+    for (i = 0; i < count; i ++)
+        names[i] = dagPaths[i].partialPathName().asChar();
+
+    std::vector<double> values(weights.length());
+    weights.get(values.data());
+
+    MString path = getWeightCachePath();
+    if (!weightCache::write(path.asChar(),
+                            skinFn.name().asChar(),
+                            key,
+                            names,
+                            values.data(),
+                            weights.length() / count))
+        MGlobal::displayWarning("The weight cache could not be written to " + path + ".");
+}
+
+
+//
+// Description:
+//      Return the file path of the weight cache for the current skin
+//      cluster. Namespaces are part of the file name.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MString             The path of the cache file.
+//
+MString smoothWeightsContext::getWeightCachePath()
+{
+    MFnDependencyNode skinMFn(skinObj);
+    std::string name = skinMFn.name().asChar();
+    std::replace(name.begin(), name.end(), ':', '_');
+
+    return cacheDirectoryVal + "/" + MString(name.c_str()) + ".brw";
+}
+
+
+//
+// Description:
+//      Return the key which identifies the saved state of the scene.
+//      The weights of a referenced skin cluster also depend on the
+//      state of the referenced file.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      unsigned long long  The key or 0, if the scene isn't saved.
+//
+unsigned long long smoothWeightsContext::getSceneKey()
+{
+    unsigned long long key = weightCache::fileStamp(MFileIO::currentFile().asChar(), 0);
+    if (key == 0)
+        return 0;
+
+    MFnDependencyNode skinMFn(skinObj);
+    if (skinMFn.isFromReferencedFile())
+    {
+        MString referenceFile;
+        MGlobal::executeCommand("referenceQuery -filename -withoutCopyNumber " + skinMFn.name(),
+                                referenceFile);
+        key = weightCache::fileStamp(referenceFile.asChar(), key);
+    }
+
+    return key;
+}
+
+
+//
+// Description:
+//      Read the adjacency, the border flags and the opposite border
+//      vertices from the topology cache if the cache matches the
+//      connectivity of the mesh. The opposite vertices are only used
+//      if they have been found with the current tolerance.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::readTopologyCache()
+{
+    unsigned int i;
+
+    topologyHash = 0;
+    topologyCached = false;
+    topologyPairCount = 0;
+
+    if (!cacheDirectoryVal.length())
+        return;
+
+    std::vector<int> counts;
+    std::vector<int> vertices;
+    getPolygonValues(counts, vertices);
+    topologyHash = topologyCache::connectivityHash(numVertices, counts, vertices);
+
+    double tolerance;
+    std::vector<int> pairs;
+    if (!topologyCache::read(getTopologyCachePath().asChar(),
+                             topologyHash,
+                             numVertices,
+                             topology,
+                             tolerance,
+                             pairs))
+        return;
+
+    // The opposite vertices depend on the tolerance. They get replaced
+    // with the pairs of the current tolerance when writing the cache.
+    if (tolerance != toleranceVal)
+        return;
+
+    for (i = 0; i < pairs.size(); i += 2)
+    {
+        indexMap[(unsigned)pairs[i]] = pairs[i + 1];
+        indexMap[(unsigned)pairs[i + 1]] = pairs[i];
+        computeIndex[(unsigned)pairs[i + 1]] = false;
+        computeIndex[(unsigned)pairs[i]] = true;
+    }
+    topologyPairCount = (unsigned)pairs.size() / 2;
+    topologyCached = true;
+}
+
+
+//
+// Description:
+//      Write the adjacency, the border flags and the opposite border
+//      vertices to the topology cache. The adjacency gets built if it
+//      doesn't exist yet so that the next activation doesn't need to
+//      query the mesh for the border vertices. Nothing is written if
+//      the cache is up to date.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::writeTopologyCache()
+{
+    unsigned int i;
+
+    if (!cacheDirectoryVal.length() || !meshDag.isValid() || numVertices == 0)
+        return;
+
+    // Skip the mesh if its topology has changed while the tool was
+    // active.
+    if ((unsigned)meshFn.numVertices() != numVertices ||
+        indexMap.length() != numVertices)
+        return;
+
+    std::vector<int> pairs;
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (indexMap[i] > -1 && computeIndex[i])
+        {
+            pairs.push_back((int)i);
+            pairs.push_back(indexMap[i]);
+        }
+    }
+
+    if (topologyHash == 0 || topology.isEmpty())
+    {
+        std::vector<int> counts;
+        std::vector<int> vertices;
+        getPolygonValues(counts, vertices);
+
+        topologyHash = topologyCache::connectivityHash(numVertices, counts, vertices);
+        if (topology.isEmpty())
+            topology.create(numVertices, counts, vertices);
+        topologyCached = false;
+    }
+
+    // The cache only needs to be written if new pairs have been found
+    // since reading it.
+    if (topologyCached && topologyPairCount == pairs.size() / 2)
+        return;
+
+    MString path = getTopologyCachePath();
+    if (topologyCache::write(path.asChar(), topologyHash, topology, toleranceVal, pairs))
+    {
+        topologyCached = true;
+        topologyPairCount = (unsigned)pairs.size() / 2;
+    }
+    else
+        MGlobal::displayWarning("The topology cache could not be written to " + path + ".");
+}
+
+
+//
+// Description:
+//      Return the file path of the topology cache for the current
+//      mesh, which is named after the connectivity hash.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MString             The path of the cache file.
+//
+MString smoothWeightsContext::getTopologyCachePath()
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", topologyHash);
+
+    return cacheDirectoryVal + "/" + MString(name) + ".brt";
+}
+
+
+void smoothWeightsContext::afterSaveCallback(void *data)
+{
+    smoothWeightsContext *context = static_cast<smoothWeightsContext*>(data);
+    context->writeWeightCache();
+    context->writeTopologyCache();
+}
+
+
+//
+// Description:
+//      Get the influence attributes from the given skin cluster object.
+//
+// Input Arguments:
+//      skinCluster             The MObject of the skin cluster node.
+//      maxInfluences           The max number of influences per vertex.
+//      maintainMaxInfluences   True, if the max influences count should
+//                              be maintained.
+//      normalize               True, if the weights are normalized.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::getSkinClusterAttributes(MObject skinCluster,
+                                                    unsigned int &maxInfluences,
+                                                    bool &maintainMaxInfluences,
+                                                    unsigned int &normalize)
+{
+    // Get the settings from the skin cluster node.
+    MFnDependencyNode skinMFn(skinCluster);
+
+    MPlug maxInflPlug = skinMFn.findPlug("maxInfluences", false);
+    maxInfluences = (unsigned)maxInflPlug.asInt();
+
+    MPlug maintainInflPlug = skinMFn.findPlug("maintainMaxInfluences", false);
+    maintainMaxInfluences = maintainInflPlug.asBool();
+
+    MPlug normalizePlug = skinMFn.findPlug("normalizeWeights", false);
+    normalize = (unsigned)normalizePlug.asInt();
+}
+
+
+//
+// Description:
+//      Return the influence indices of all influences of the given
+//      skin cluster node.
+//
 // Input Arguments:
 //      skinCluster         The MObject of the skin cluster node.
 //
@@ -1607,6 +2433,8 @@ std::vector<bool> smoothWeightsContext::getInfluenceLocks(MDagPathArray dagPaths
 //
 bool smoothWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, MFloatArray &distances)
 {
+    scopedTimer timer(stats, strokeStats::kClosestIndex);
+
     unsigned int i, j;
 
     MPoint worldPoint;
@@ -1632,6 +2460,9 @@ bool smoothWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, MFl
     MFloatPointArray hitPoints;
     MFloatArray hitRayParams;
     MIntArray hitFaces;
+    MIntArray hitTriangles;
+    MFloatArray hitBary1;
+    MFloatArray hitBary2;
 
     bool foundIntersect = meshFn.allIntersections(worldPoint,
                                                   worldVector,
@@ -1646,15 +2477,16 @@ bool smoothWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, MFl
                                                   hitPoints,
                                                   &hitRayParams,
                                                   &hitFaces,
-                                                  NULL,
-                                                  NULL,
-                                                  NULL);
+                                                  &hitTriangles,
+                                                  &hitBary1,
+                                                  &hitBary2);
 
     if (!foundIntersect)
         return false;
 
     MItMeshPolygon polyIter(meshFn.object());
     surfacePoints.clear();
+    centerPoints.clear();
 
     // Make sure that the depth value does not go below 0.
     if (depthVal < 1)
@@ -1689,6 +2521,13 @@ bool smoothWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, MFl
     {
         surfacePoints.append(hitPoints[i]);
 
+        // The distances are measured from the same surface position
+        // on the input geometry when using the bind pose.
+        MPoint centerPoint = hitPoints[i];
+        if (useBindPose())
+            centerPoint = getBindPoint(hitFaces[i], hitTriangles[i], hitBary1[i], hitBary2[i]);
+        centerPoints.append(centerPoint);
+
         // If an intersection has been found go through the vertices of
         // the intersected polygon and find the closest vertex.
 
@@ -1702,14 +2541,8 @@ bool smoothWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, MFl
 
         for (j = 0; j < vertices.length(); j ++)
         {
-            MPoint position;
-            meshFn.getPoint(vertices[j], position, MSpace::kWorld);
-
-            // Convert the vertex position point because the hit points
-            // are float points.
-            MFloatPoint posPoint;
-            posPoint.setCast(position);
-            float delta = (float)MVector(posPoint - hitPoints[i]).length();
+            MPoint position = getVertexPosition(vertices[j], MSpace::kWorld);
+            float delta = (float)position.distanceTo(centerPoint);
             // Find which index is closest and store it along with the
             // distance.
             if (j == 0 || closestDistance > delta)
@@ -1800,6 +2633,7 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
     MFnSingleIndexedComponent smoothedCompFn(smoothedCompObj);
 
     MItMeshVertex vtxIter(meshDag);
+    counters.add(strokeCounters::kIterators);
 
     for (i = 0; i < indices.length(); i ++)
     {
@@ -1815,6 +2649,8 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
         // In paint mode, get the indices within the brush radius.
         if (!flood)
         {
+            scopedTimer rangeTimer(stats, strokeStats::kRange);
+
             if (!volumeVal)
             {
                 // Add the closest index and it's distance. If the brush
@@ -1841,6 +2677,11 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
             values = MFloatArray(vtxSelection.length(), 1.0f);
         }
 
+        // Add the vertices on the other side of the mirror plane so
+        // that they get smoothed with the same weights commit.
+        if (useMirror())
+            appendMirrorIndices(rangeIndices, values);
+
         // -------------------------------------------------------------
         // Compare the brush vertices with the current selection and
         // order the falloff values.
@@ -1859,6 +2700,12 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
         MFloatArray orderedValues(numVertices, -1);
         MIntArray filteredIndices;
 
+        // The range, value, ordered value and filtered index arrays of
+        // the dab.
+        counters.add(strokeCounters::kArrays, 4);
+
+        scopedTimer seamsTimer(stats, strokeStats::kSeams);
+
         // Set the value for each range index.
         for (j = 0; j < rangeIndices.length(); j ++)
         {
@@ -1915,10 +2762,12 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
                         MIntArray edges;
                         vtxIter.getConnectedEdges(edges);
 
+                        counters.add(strokeCounters::kArrays, 2);
+
                         int oppositeIndex;
                         // In case it's a boundary vertex get the
                         // opposite vertex.
-                        if (oppositeBoundaryIndex(vtxIter.position(), faces, edges, oppositeIndex))
+                        if (oppositeBoundaryIndex(getVertexPosition(vtxIter, MSpace::kObject), faces, edges, oppositeIndex))
                         {
                             // If the borders of the shells are out of
                             // the tolerance range the opposite index
@@ -1954,6 +2803,8 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
         }
         rangeIndices.copy(filteredIndices);
 
+        seamsTimer.stop();
+
         // -------------------------------------------------------------
         // weights component object
         // -------------------------------------------------------------
@@ -1979,20 +2830,79 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
         // The length of the array is the number of vertices within the
         // brush radius * the number of influences.
         smoothedWeights = MDoubleArray(rangeCount * influenceCount, 0.0);
+        counters.add(strokeCounters::kArrays);
+
+        // Select the smoothing kernel for the current settings.
+        weightsKernel kernel = getWeightsKernel(flood);
+
+        // In volume mode the vertices of the dab are the candidates for
+        // the range of each vertex.
+        std::vector<unsigned int> volumeIndices;
+        if (volumeVal)
+        {
+            volumeIndices.resize(rangeCount);
+            for (j = 0; j < rangeCount; j ++)
+                volumeIndices[j] = (unsigned)rangeIndices[j];
+        }
+
+        // -------------------------------------------------------------
+        // active set for the convergence-driven flood
+        // -------------------------------------------------------------
+
+        // With a flood tolerance the oversampling is the maximum number
+        // of passes. Each pass only processes the vertices whose
+        // weights or neighbour weights changed by more than the
+        // tolerance in the previous pass and the flood stops once no
+        // vertex is left.
+        bool converge = flood && !volumeVal && floodToleranceVal > 0.0;
+
+        std::vector<unsigned char> active;
+        std::vector<unsigned char> changed;
+        std::vector<int> elements;
+        if (converge)
+        {
+            active = std::vector<unsigned char>(rangeCount, 1);
+            changed = std::vector<unsigned char>(rangeCount, 0);
+            elements = std::vector<int>(numVertices, -1);
+            for (j = 0; j < rangeCount; j ++)
+                elements[(unsigned)rangeIndices[j]] = (int)j;
+        }
 
         // -------------------------------------------------------------
         // smooth the weights in a multi-threaded loop
         // -------------------------------------------------------------
 
+        scopedTimer computeTimer(stats, strokeStats::kCompute);
+
         for (m = 0; m < (unsigned)oversamplingVal; m ++)
         {
             tbb::parallel_for(tbb::blocked_range<unsigned int>(0, rangeCount),
                               [&](tbb::blocked_range<unsigned int> r)
             {
+                traceSpan span(trace, "smoothRange", "worker");
+
+                // The steps of the search for the opposite elements.
+                unsigned long long scans = 0;
+
+                // The working memory of the kernel, which is reused
+                // for all vertices of the task.
+                smoothBuffer buffer;
+
+                std::vector<double> previous;
+                if (converge)
+                    previous.resize(influenceCount);
+
                 for (unsigned int k = r.begin(); k < r.end(); k ++)
                 {
                     unsigned int rangeIndex = (unsigned)rangeIndices[k];
 
+                    if (converge)
+                    {
+                        changed[k] = 0;
+                        if (!active[k])
+                            continue;
+                    }
+
                     // Only smooth the indices which are have their
                     // compute flag set to true. This applies to all
                     // vertices in single-shell mode or only one vertex
@@ -2014,6 +2924,7 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
                             // values as the source boundary index.
                             for (unsigned l = 0; l < rangeCount; l ++)
                             {
+                                scans ++;
                                 if ((int)rangeIndices[l] == oppositeIndex)
                                 {
                                     oppositeElement = (int)l;
@@ -2022,22 +2933,108 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
                             }
                         }
 
-                        computeWeights(rangeIndex,
-                                       orderedValues[rangeIndex],
-                                       oppositeIndex,
-                                       k,
-                                       oppositeElement,
-                                       rangeIndices,
-                                       flood);
+                        unsigned int offset = rangeIndex * influenceCount;
+                        if (converge)
+                        {
+                            for (unsigned int l = 0; l < influenceCount; l ++)
+                            {
+                                if (singleWeights.empty())
+                                    previous[l] = currentWeights[offset + l];
+                                else
+                                    previous[l] = singleWeights[offset + l];
+                            }
+                        }
+
+                        (this->*kernel)(rangeIndex,
+                                        orderedValues[rangeIndex],
+                                        oppositeIndex,
+                                        k,
+                                        oppositeElement,
+                                        volumeIndices,
+                                        buffer);
+
+                        if (converge)
+                        {
+                            for (unsigned int l = 0; l < influenceCount; l ++)
+                            {
+                                double delta = smoothedWeights[k * influenceCount + l] - previous[l];
+                                if (delta > floodToleranceVal || delta < -floodToleranceVal)
+                                {
+                                    changed[k] = 1;
+                                    break;
+                                }
+                            }
+                        }
                     }
                 }
+
+                counters.add(strokeCounters::kSeamScans, scans);
             });
+
+            // The written vertices get their new influence lists once
+            // no other vertex of the pass reads these anymore.
+            for (j = 0; j < rangeCount; j ++)
+                smoother.updateInfluenceList((unsigned)rangeIndices[j]);
+
+            if (!converge)
+                continue;
+
+            // Collect the vertices for the next pass. A change of a
+            // vertex affects the average of all its neighbours,
+            // including the neighbours of the opposite boundary vertex.
+            // Boundary vertices which are not computed themselves pass
+            // the activation on to their computed counterpart.
+            std::fill(active.begin(), active.end(), 0);
+            unsigned int activeCount = 0;
+
+            auto activate = [&](unsigned int vertex)
+            {
+                if (!computeIndex[vertex] && indexMap[vertex] > -1)
+                    vertex = (unsigned)indexMap[vertex];
+
+                int element = elements[vertex];
+                if (element > -1 && !active[(unsigned)element])
+                {
+                    active[(unsigned)element] = 1;
+                    activeCount ++;
+                }
+            };
+
+            for (j = 0; j < rangeCount; j ++)
+            {
+                if (!changed[j])
+                    continue;
+
+                unsigned int rangeIndex = (unsigned)rangeIndices[j];
+                int sides[2] = {(int)rangeIndex, indexMap[rangeIndex]};
+                for (unsigned int l = 0; l < 2; l ++)
+                {
+                    if (sides[l] < 0)
+                        continue;
+
+                    unsigned int vertex = (unsigned)sides[l];
+                    activate(vertex);
+                    for (unsigned int e = topology.rowStart(vertex); e < topology.rowEnd(vertex); e ++)
+                        activate(topology.neighbor(e));
+                }
+            }
+
+            if (!activeCount)
+                break;
         }
 
+        computeTimer.stop();
+
         // Set the new weights.
+        scopedTimer setWeightsTimer(stats, strokeStats::kSetWeights);
+        counters.add(strokeCounters::kSetWeightsCalls);
+        counters.add(strokeCounters::kSetWeightsRows, rangeCount);
+        ignoreWeightChanges = true;
         skinFn.setWeights(meshDag, vtxComponents, influenceIndices, smoothedWeights, normalize);
+        ignoreWeightChanges = false;
     }
 
+    scopedTimer refreshTimer(stats, strokeStats::kRefresh);
     view.refresh(true);
 
     return status;
@@ -2046,272 +3043,201 @@ MStatus smoothWeightsContext::performSmooth(MEvent event,
 
 //
 // Description:
-//      Calculate an interpolated weight value from the current weight
-//      of the given index and the weights of the connected vertices.
+//      Set the current weight at the given index in the double or
+//      single precision weights.
 //
 // Input Arguments:
-//      index               The vertex index.
-//      scale               The scale value for the smoothing.
-//      oppositeIndex       The opposite boundary index.
-//      element             The element index of the vertex index
-//                          in the current array of brush vertices.
-//                          This is needed for setting the related
-//                          weights.
-//      oppositeElement     The element index of the opposite index.
-//      volumeIndices       The complete list of indices within the
+//      value               The weight value.
+//      index               The index in the weights array.
+//
+// Return Value:
+//      None
+//
+template <>
+inline void smoothWeightsContext::setCurrentWeight<false>(double value, unsigned int index)
+{
+    currentWeights[index] = value;
+}
+
+
+template <>
+inline void smoothWeightsContext::setCurrentWeight<true>(double value, unsigned int index)
+{
+    singleWeights[index] = (float)value;
+}
+
+
+//
+// Description:
+//      Calculate an interpolated weight value from the current weight
+//      of the given index and the weights of the connected vertices.
+//      The averaging is done by the shared smoothing kernel of the core
+//      library. The context only collects the neighbours and writes the
+//      result to the smoothed and current weights.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      scale               The scale value for the smoothing.
+//      oppositeIndex       The opposite boundary index.
+//      element             The element index of the vertex index
+//                          in the current array of brush vertices.
+//                          This is needed for setting the related
+//                          weights.
+//      oppositeElement     The element index of the opposite index.
+//      volumeIndices       The complete list of indices within the
 //                          brush radius. These are needed for the
 //                          volume-based smoothing.
-//      flood               True, if a flood smooth is performed.
+//      buffer              The working memory of the kernel.
+//
+// Template Arguments:
+//      VolumeMode          True, if the smoothing is volume-based.
+//      HasLocks            True, if any influence is locked and the
+//                          locks are not ignored.
+//      MaxInfluences       True, if the max influences need to be
+//                          maintained.
+//      Normalize           True, if the weights get normalized.
+//      WriteCurrent        True, if the smoothed weights need to be
+//                          stored in the current weights.
+//      SinglePrecision     True, if the current weights are stored in
+//                          single precision. All sums are still
+//                          computed in double precision.
 //
 // Return Value:
 //      None
 //
+template <bool VolumeMode, bool HasLocks, bool MaxInfluences, bool Normalize, bool WriteCurrent, bool SinglePrecision>
 void smoothWeightsContext::computeWeights(unsigned int index,
                                           double scale,
                                           int oppositeIndex,
                                           unsigned int element,
                                           int oppositeElement,
-                                          MIntArray volumeIndices,
-                                          bool flood)
+                                          const std::vector<unsigned int> &volumeIndices,
+                                          smoothBuffer &buffer)
 {
-    unsigned int i, j;
-
-    // Create the object for the current vertex.
-    MFnSingleIndexedComponent vtxCompFn;
-    MObject vtxObj = vtxCompFn.create(MFn::kMeshVertComponent);
-    vtxCompFn.addElement((int)index);
-
-    // Get the connected vertices.
-    MItMeshVertex vtxIter(meshDag, vtxObj);
-    MIntArray connected;
-    int prevIndex;
+    unsigned int i, j, u;
 
-    // The array for storing the distance based falloff values when in
-    // volume mode.
-    MFloatArray rangeValues;
+    // Get the scale value based on the brush falloff and strength.
+    double smoothStrength = strengthVal;
+    if (fractionOversamplingVal)
+        smoothStrength /= oversamplingVal;
 
-    if (!volumeVal)
+    if (!VolumeMode && weightingVal == 1 && !smoothing.isEmpty())
     {
-        vtxIter.getConnectedVertices(connected);
-
-        // If an opposite vertex exists in case of a boundary vertex get
-        // it's connected vertices and add these to the connected array.
-        if (oppositeIndex > -1)
-        {
-            vtxIter.setIndex(oppositeIndex, prevIndex);
-            MIntArray connectedOpposite;
-            vtxIter.getConnectedVertices(connectedOpposite);
-            for (i = 0; i < connectedOpposite.length(); i ++)
-                connected.append(connectedOpposite[i]);
-        }
+        smoother.getWeightedNeighbors(smoothing, index, oppositeIndex, buffer);
+    }
+    else if (!VolumeMode)
+    {
+        smoother.getNeighbors(topology, index, oppositeIndex, buffer);
     }
     else
     {
         // Based on the brush volume get all indices which are within
-        // the range if the current vertex.
-        MIntArray rangeIndices;
-        getVerticesInVolumeRange((int)index, volumeIndices, rangeIndices, rangeValues);
-
-        // The range vertices are the ones the current vertex gets it's
-        // weights from, just like the connected vertices in surface
-        // mode.
-        connected.copy(rangeIndices);
+        // the range if the current vertex. The range vertices are the
+        // ones the current vertex gets it's weights from, just like
+        // the connected vertices in surface mode.
+        buffer.shares.clear();
+        topology.getVolumeRange(index, volumeIndices, sizeVal * rangeVal,
+                                buffer.neighbors, buffer.scales);
+        for (j = 0; j < buffer.scales.size(); j ++)
+            buffer.scales[j] = getFalloffValue(buffer.scales[j], smoothStrength);
 
         // Create the scale value for the brush falloff based on the
         // distance of the current vertex to the surface point at the
         // cursor position.
-        vtxIter.setIndex((int)index, prevIndex);
-        MPoint pnt = vtxIter.position(MSpace::kWorld);
-        double delta = MVector(pnt - surfacePoints[0]).length();
+        //
+        // A mirrored vertex gets measured from its partner vertex on
+        // the brush side of the mirror plane. Both positions are from
+        // the same point set the mirror map has been built from, so
+        // that this also works with the bind pose or if the mesh isn't
+        // centered at the origin.
+        unsigned int measureIndex = index;
+        if (isMirrored(index) && mirror.mirrorIndex(index) > -1)
+            measureIndex = (unsigned)mirror.mirrorIndex(index);
+
+        const double *point = topology.point(measureIndex);
+        MPoint pnt(point[0], point[1], point[2]);
+
+        double delta = MVector(pnt - centerPoints[0]).length();
         scale = 1 - (delta / sizeVal);
     }
 
-    // Get the scale value based on the brush falloff and strength.
-    double smoothStrength = strengthVal;
-    if (fractionOversamplingVal)
-        smoothStrength /= oversamplingVal;
     scale = getFalloffValue(scale, smoothStrength);
 
-    unsigned int connectedCount = connected.length();
-
-    double maxWeight = 0.0;
-    double maxWeightUnlocked = 0.0;
-    double maxWeightLocked = 0.0;
-    bool hasLocks = false;
+    unsigned int connectedCount = (unsigned)buffer.neighbors.size();
 
-    // Create a new array for the averaged weights for the max influence
-    // process.
-    MDoubleArray newWeights(influenceCount, 0.0);
-    MIntArray inflIndices;
-    inflIndices.setLength(influenceCount);
+    // In volume mode all volume vertices are tested for being in range
+    // of the vertex.
+    counters.add(strokeCounters::kNeighbors, VolumeMode ? volumeIndices.size() : connectedCount);
 
     // -----------------------------------------------------------------
-    // smooth by averaging connected weights
+    // smooth
     // -----------------------------------------------------------------
 
-    for (i = 0; i < influenceCount; i ++)
+    // Only the influences which have a weight on the vertex, its
+    // opposite boundary vertex or any of the connected vertices are
+    // returned by the kernel. All other influences are zero and stay
+    // zero, which is also the value they already have in the smoothed
+    // and current weights.
+    if (SinglePrecision)
     {
-        double currentValue = 0.0;
-        double weight = 0.0;
-
-        // Create an index based on the influence count.
-        unsigned int k = influenceCount * element + i;
-        unsigned int w = influenceCount * index + i;
-        currentValue = (currentWeights[w] / connectedCount) * (1 - scale);
-
-        // Collect the weights per influence.
-        // When in volume mode it's possible that the volume range is
-        // too small and no vertices are found. In this case there are
-        // no weights to average. But since the resulting
-        // smoothedWeights array is initialized with 0 values the
-        // current weights have to get transferred to smoothedWeights
-        // or the vertex will have no weights at all.
-        if (connectedCount && !isLocked(i))
-        {
-            for (j = 0; j < connectedCount; j ++)
-            {
-                // Create an index based on the influence count.
-                unsigned int l = influenceCount * (unsigned)connected[j] + i;
-
-                double weightScale = scale;
-                if (volumeVal)
-                    weightScale = rangeValues[j];
-                weight += ((currentWeights[l] / connectedCount) * weightScale) + currentValue;
-            }
-        }
-        else
-        {
-            weight = currentWeights[w];
-        }
-
-        smoothedWeights.set(weight, k);
-        setCurrentWeight(weight, w, flood);
-
-        newWeights.set(weight, i);
-        inflIndices.set((int)i, i);
-
-        maxWeight += weight;
-        if (isLocked(i))
-        {
-            maxWeightLocked += weight;
-            hasLocks = true;
-        }
-        else
-            maxWeightUnlocked += weight;
+        smoother.computeVertex<VolumeMode, HasLocks, MaxInfluences, Normalize>(singleWeights,
+                                                                            index,
+                                                                            oppositeIndex,
+                                                                            scale,
+                                                                            buffer);
+    }
+    else
+    {
+        smoother.computeVertex<VolumeMode, HasLocks, MaxInfluences, Normalize>(currentWeights,
+                                                                            index,
+                                                                            oppositeIndex,
+                                                                            scale,
+                                                                            buffer);
     }
 
+    unsigned int unionCount = (unsigned)buffer.influences.size();
+
     // -----------------------------------------------------------------
-    // maintain max influences
+    // set the weights
     // -----------------------------------------------------------------
 
-    if (connectedCount)
+    for (u = 0; u < unionCount; u ++)
     {
-        if (maintainMaxInfluences)
-        {
-            MIntArray sortedIds = sortIndicesByValues(inflIndices, newWeights);
-
-            // Define the start index to find the max weight indices
-            // based on the max influences count.
-            unsigned int maxLimitIndex = influenceCount - maxInfluences;
-            if (influenceCount < maxInfluences)
-                maxLimitIndex = 0;
-
-            maxWeight = 0.0;
-            maxWeightUnlocked = 0.0;
-            maxWeightLocked = 0.0;
+        i = buffer.influences[u];
 
-            for (i = 0; i < influenceCount; i ++)
-            {
-                unsigned int sortedIndex = (unsigned)sortedIds[i];
+        unsigned int k = influenceCount * element + i;
+        unsigned int w = influenceCount * index + i;
 
-                unsigned int k = influenceCount * element + sortedIndex;
-                unsigned int w = influenceCount * index + sortedIndex;
+        smoothedWeights.set(buffer.values[u], k);
+        if (WriteCurrent)
+            setCurrentWeight<SinglePrecision>(buffer.values[u], w);
+    }
 
-                // Discard any influence which is located at the
-                // beginning of the list and is not locked.
-                if (i < maxLimitIndex && !isLocked(sortedIndex))
-                {
-                    smoothedWeights.set(0.0, k);
-                    setCurrentWeight(0.0, w, flood);
-                }
-                else
-                {
-                    double weight = newWeights[sortedIndex];
-                    smoothedWeights.set(weight, k);
-                    setCurrentWeight(weight, w, flood);
-                    maxWeight += weight;
-
-                    // If the influence is locked the maxLimitIndex
-                    // needs to be raised to account for any influences
-                    // which are locked but are outside the index range.
-                    if (isLocked(sortedIndex))
-                    {
-                        maxLimitIndex += 1;
-                        maxWeightLocked += weight;
-                    }
-                    else
-                        maxWeightUnlocked += weight;
-                }
-            }
-        }
+    if (WriteCurrent)
+        smoother.setInfluenceList(index, buffer);
 
-        // -------------------------------------------------------------
-        // normalize
-        // -------------------------------------------------------------
+    // -----------------------------------------------------------------
+    // matching the values of the opposite boundary vertex
+    // -----------------------------------------------------------------
 
-        if (normalize)
+    // If an opposite vertex exists in case of a boundary vertex apply
+    // the same final weights to the opposite vertex as well. The union
+    // includes all influences of the opposite vertex.
+    if (connectedCount && oppositeIndex > -1)
+    {
+        for (u = 0; u < unionCount; u ++)
         {
-            for (i = 0; i < influenceCount; i ++)
-            {
-                unsigned int k = influenceCount * element + i;
-                unsigned int w = influenceCount * index + i;
-
-                double value = 0.0;
-                // In case there aren't any locked influences the
-                // normalization can consider all weights.
-                if (!hasLocks)
-                    value = smoothedWeights[k] / maxWeight;
-                // If one or more influences are locked keep the weights
-                // of the locked and calculate a scaling factor for the
-                // unlocked based on the unlocked weight sum and the
-                // remaining weight range.
-                else
-                {
-                    value = smoothedWeights[k];
-                    double remainingWeight = 1 - maxWeightLocked;
-                    if (!isLocked(i))
-                    {
-                        if (remainingWeight > 0)
-                            value *= remainingWeight / maxWeightUnlocked;
-                        else
-                            value = 0.0;
-                    }
-                }
+            i = buffer.influences[u];
 
-                smoothedWeights.set(value, k);
-                setCurrentWeight(value, w, flood);
-            }
+            unsigned int k = influenceCount * (unsigned)oppositeElement + i;
+            unsigned int w = influenceCount * (unsigned)oppositeIndex + i;
+            smoothedWeights.set(buffer.values[u], k);
+            if (WriteCurrent)
+                setCurrentWeight<SinglePrecision>(buffer.values[u], w);
         }
 
-        // -------------------------------------------------------------
-        // matching the values of the opposite boundary vertex
-        // -------------------------------------------------------------
-
-        // If an opposite vertex exists in case of a boundary vertex
-        // apply the same final weights to the opposite vertex as well.
-        if (oppositeIndex > -1)
-        {
-            for (i = 0; i < influenceCount; i ++)
-            {
-                unsigned int k = influenceCount * element + i;
-                double value = smoothedWeights[k];
-
-                k = influenceCount * (unsigned)oppositeElement + i;
-                unsigned int w = influenceCount * (unsigned)oppositeIndex + i;
-                smoothedWeights.set(value, k);
-                setCurrentWeight(value, w, flood);
-            }
-        }
+        if (WriteCurrent)
+            smoother.setInfluenceList((unsigned)oppositeIndex, buffer);
     }
 }
 
@@ -2337,32 +3263,75 @@ bool smoothWeightsContext::isLocked(unsigned int index)
 
 //
 // Description:
-//      Set the weight value at the given index for the current weights
-//      array. The value only needs to get set when flooding is
-//      performed and the oversampling is set to anything larger than 1.
-//      The reason for this switch when flooding is because in order to
-//      get a smooth result the flooding needs to draw values from the
-//      original weights list. If this is not the case the result could
-//      be jaggy because some vertices draw from unsmoothed weights and
-//      others from already smoothed neighbours. But when flood
-//      smoothing with several iterations the next iteration needs to
-//      refer to previous smoothed iteration. Therefore the smoothed
-//      values need to get stored in the currentWeights array.
+//      Return the specialized smoothing kernel for the current settings.
+//      The kernel is selected once per dab so that the loops over the
+//      influences don't need to check the settings for each weight.
+//
+//      The smoothed weights only need to be stored in the current
+//      weights array when flooding is performed and the oversampling
+//      is set to anything larger than 1. The reason for this switch
+//      when flooding is because in order to get a smooth result the
+//      flooding needs to draw values from the original weights list.
+//      If this is not the case the result could be jaggy because some
+//      vertices draw from unsmoothed weights and others from already
+//      smoothed neighbours. But when flood smoothing with several
+//      iterations the next iteration needs to refer to previous
+//      smoothed iteration. Therefore the smoothed values need to get
+//      stored in the currentWeights array.
 //
 // Input Arguments:
-//      event               The mouse event.
-//      indices             The list of vertex indices along the
-//                          intersection ray.
-//      distances           The list of distances of the vertices to the
-//                          intersection ray.
+//      flood               True, if a flood smooth is performed.
 //
 // Return Value:
-//      MStatus             The MStatus for selecting the components.
+//      weightsKernel       The member function pointer of the kernel.
 //
-void smoothWeightsContext::setCurrentWeight(double value, unsigned int index, bool flood)
-{
-    if (!flood || (flood && oversamplingVal > 1))
-        currentWeights.set(value, index);
+smoothWeightsContext::weightsKernel smoothWeightsContext::getWeightsKernel(bool flood)
+{
+    // The kernel for each combination of the settings, with the bits
+    // of the table index matching the order of the template arguments.
+#define WEIGHTS_KERNEL(mode) &smoothWeightsContext::computeWeights<(mode & 1) != 0, \
+                                                                  (mode & 2) != 0, \
+                                                                  (mode & 4) != 0, \
+                                                                  (mode & 8) != 0, \
+                                                                  (mode & 16) != 0, \
+                                                                  (mode & 32) != 0>
+
+    static const weightsKernel kernels[64] = {
+        WEIGHTS_KERNEL(0), WEIGHTS_KERNEL(1), WEIGHTS_KERNEL(2), WEIGHTS_KERNEL(3),
+        WEIGHTS_KERNEL(4), WEIGHTS_KERNEL(5), WEIGHTS_KERNEL(6), WEIGHTS_KERNEL(7),
+        WEIGHTS_KERNEL(8), WEIGHTS_KERNEL(9), WEIGHTS_KERNEL(10), WEIGHTS_KERNEL(11),
+        WEIGHTS_KERNEL(12), WEIGHTS_KERNEL(13), WEIGHTS_KERNEL(14), WEIGHTS_KERNEL(15),
+        WEIGHTS_KERNEL(16), WEIGHTS_KERNEL(17), WEIGHTS_KERNEL(18), WEIGHTS_KERNEL(19),
+        WEIGHTS_KERNEL(20), WEIGHTS_KERNEL(21), WEIGHTS_KERNEL(22), WEIGHTS_KERNEL(23),
+        WEIGHTS_KERNEL(24), WEIGHTS_KERNEL(25), WEIGHTS_KERNEL(26), WEIGHTS_KERNEL(27),
+        WEIGHTS_KERNEL(28), WEIGHTS_KERNEL(29), WEIGHTS_KERNEL(30), WEIGHTS_KERNEL(31),
+        WEIGHTS_KERNEL(32), WEIGHTS_KERNEL(33), WEIGHTS_KERNEL(34), WEIGHTS_KERNEL(35),
+        WEIGHTS_KERNEL(36), WEIGHTS_KERNEL(37), WEIGHTS_KERNEL(38), WEIGHTS_KERNEL(39),
+        WEIGHTS_KERNEL(40), WEIGHTS_KERNEL(41), WEIGHTS_KERNEL(42), WEIGHTS_KERNEL(43),
+        WEIGHTS_KERNEL(44), WEIGHTS_KERNEL(45), WEIGHTS_KERNEL(46), WEIGHTS_KERNEL(47),
+        WEIGHTS_KERNEL(48), WEIGHTS_KERNEL(49), WEIGHTS_KERNEL(50), WEIGHTS_KERNEL(51),
+        WEIGHTS_KERNEL(52), WEIGHTS_KERNEL(53), WEIGHTS_KERNEL(54), WEIGHTS_KERNEL(55),
+        WEIGHTS_KERNEL(56), WEIGHTS_KERNEL(57), WEIGHTS_KERNEL(58), WEIGHTS_KERNEL(59),
+        WEIGHTS_KERNEL(60), WEIGHTS_KERNEL(61), WEIGHTS_KERNEL(62), WEIGHTS_KERNEL(63)
+    };
+
+#undef WEIGHTS_KERNEL
+
+    unsigned int mode = 0;
+    if (volumeVal)
+        mode |= 1;
+    if (!ignoreLockVal && lockedCount)
+        mode |= 2;
+    if (maintainMaxInfluences && influenceCount > maxInfluences)
+        mode |= 4;
+    if (normalize)
+        mode |= 8;
+    if (!flood || oversamplingVal > 1)
+        mode |= 16;
+    if (!singleWeights.empty())
+        mode |= 32;
+
+    return kernels[mode];
 }
 
 
@@ -2469,6 +3438,10 @@ void smoothWeightsContext::performFlood()
     // method to simply smooth with the current strength value.
     doPressCommon(event);
 
+    // The flood vertices replace the selected vertices and not all
+    // flood modes keep the current weights up to date.
+    dirtyLayers |= kDirtySelection | kDirtyWeights;
+
     // If the current selection doesn't contain any components fill the
     // array with the indices of all vertices of the mesh.
     if (!vtxSelection.length())
@@ -2502,6 +3475,19 @@ void smoothWeightsContext::performFlood()
         }
     }
 
+    // The implicit flood diffuses the weights of all flood vertices
+    // with a single solve instead of explicit smoothing passes.
+    // If the solve fails the explicit flood is performed instead.
+    if (floodModeVal != 0 && !volumeVal)
+    {
+        if (performImplicitFlood() == MStatus::kSuccess)
+        {
+            performBrush = true;
+            doReleaseCommon(event);
+            return;
+        }
+    }
+
     // Create an array with only the first index of the selection to be
     // able to call performSmooth(). This is identical to passing the
     // closest vertex to the brush when painting.
@@ -2520,443 +3506,1022 @@ void smoothWeightsContext::performFlood()
 
 //
 // Description:
-//      Return a component MObject for all vertex components of the
-//      given mesh.
+//      Smooth the weights of all flood vertices by solving the implicit
+//      diffusion (M + tL) w = M w0 for each unlocked influence. The
+//      vertices outside the flood selection keep their weights and act
+//      as the boundary of the solve. The diffusion time is the
+//      strength times the oversampling, measured in squared mean edge
+//      lengths. The influences are solved in parallel, followed by the
+//      max influences and the normalization per vertex.
+//      With the multigrid flood mode the vertex clusters are built once
+//      per mesh and the solve uses the multigrid preconditioner.
+//      The iteration limit grows with the number of flood vertices. If
+//      the solve doesn't converge for any influence the weights are
+//      restored and a failure is returned.
 //
 // Input Arguments:
-//      meshDag             The dagPath of the mesh object.
+//      None
 //
 // Return Value:
-//      MObject             The component object for all mesh vertices.
+//      MStatus             kSuccess if the weights have been set.
 //
-MObject smoothWeightsContext::allVertexComponents(MDagPath meshDag)
+MStatus smoothWeightsContext::performImplicitFlood()
 {
-    MFnSingleIndexedComponent compFn;
-    MObject vtxComponents = compFn.create(MFn::kMeshVertComponent);
-    MFnMesh meshFn(meshDag);
-    compFn.setCompleteData((int)numVertices);
-    return vtxComponents;
-}
+    MStatus status = MStatus::kSuccess;
 
+    unsigned int i;
 
-//
-// Description:
-//      Return a sorted index array defined by the given value array.
-//      The sorting is based on the insertion sorting algorithm:
-//      www.sorting-algorithms.com
-//
-// Input Arguments:
-//      indices             The array of indices to sort.
-//      values              The value array the sorting is based on.
-//
-// Return Value:
-//      The sorted array of indices.
-//
-MIntArray smoothWeightsContext::sortIndicesByValues(MIntArray indices, MDoubleArray values)
-{
-    unsigned int i, j;
+    MFnSkinCluster skinFn(skinObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    for (i = 0; i < values.length(); i ++)
+    // The solve is always performed in double precision.
+    if (!singleWeights.empty())
     {
-        for (j = i; j >= 1 && values[j] < values[j - 1]; j --)
-        {
-            double value = values[j - 1];
-            values.remove(j - 1);
-            values.insert(value, j);
-
-            int index = indices[j - 1];
-            indices.remove(j - 1);
-            indices.insert(index, j);
-        }
+        currentWeights.setLength((unsigned)singleWeights.size());
+        for (i = 0; i < singleWeights.size(); i ++)
+            currentWeights[i] = singleWeights[i];
+        singleWeights.clear();
     }
 
-    return indices;
-}
+    updateOperators();
+    if (operators.isEmpty() || currentWeights.length() != numVertices * influenceCount)
+        return MStatus::kFailure;
 
+    unsigned int floodCount = vtxSelection.length();
 
-// ---------------------------------------------------------------------
-// mesh walking to collect vertices inside the brush radius
-// ---------------------------------------------------------------------
+    std::vector<bool> fixed(numVertices, true);
+    for (i = 0; i < floodCount; i ++)
+        fixed[(unsigned)vtxSelection[i]] = false;
 
-//
-// Description:
-//      Based on the given index find the connected indices within the
-//      brush radius and their distances to the respective surface
-//      point.
-//
-// Input Arguments:
-//      index               The vertex index.
-//      hitIndex            The index of the item along the intersection
-//                          ray.
-//      indices             The array of indices within the range.
-//      values              The array of falloff values for the indices.
-//
-// Return Value:
-//      None
-//
-void smoothWeightsContext::getVerticesInRange(int index,
-                                              int hitIndex,
-                                              MIntArray &indices,
-                                              MFloatArray &values)
-{
-    unsigned int i, j;
+    double edgeLength = operators.meanEdgeLength();
+    double time = strengthVal * oversamplingVal * edgeLength * edgeLength;
 
-    MItMeshVertex vtxIter(meshDag);
+    bool useMultigrid = floodModeVal == 2;
 
-    // This array stored which indices have beeen visited by setting
-    // their index to false.
-    std::vector<bool> visited(numVertices, false);
-
-    // Set the center vertex as visited to prevent it from being listed
-    // twice due to the walking process.
-    visited[(unsigned)index] = true;
-
-    // This array holds the indices which should be processed for each
-    // iteration, walking from the center vertex outward.
-    // The first time it only includes the center vertex which is
-    // closest to the cursor. The next time it holds all the vertices
-    // which are connected to the center vertex, and so on.
-    MIntArray walkIndices;
-    walkIndices.append(index);
-
-    // Continue to go through connected vertices as long as these are
-    // within the brush radius. Once an iteration contains only vertices
-    // which are out of range walkIndices will be empty and the process
-    // can be finished.
-    while (walkIndices.length() > 0)
-    {
-        MIntArray nextIndices;
-        for (i = 0; i < walkIndices.length(); i ++)
-        {
-            // The connected vertices and their values which are in
-            // range.
-            MIntArray connectedIndices;
-            MFloatArray connectedValues;
-            int oppositeIndex = -1;
-            getConnectedInRange(surfacePoints[(unsigned)hitIndex],
-                                walkIndices[i],
-                                visited,
-                                connectedIndices,
-                                connectedValues,
-                                oppositeIndex);
-
-            for (j = 0; j < connectedIndices.length(); j ++)
-            {
-                // Add the found vertices and their values to the return
-                // arrays.
-                indices.append(connectedIndices[j]);
-                values.append(connectedValues[j]);
-
-                // Store the connected indices of each walk index to be
-                // used for the next walk iteration.
-                nextIndices.append(connectedIndices[j]);
-            }
-        }
-        walkIndices = nextIndices;
+    // The conjugate gradient needs more iterations the more vertices
+    // are free, while the multigrid cycles barely depend on the mesh
+    // density. The limits only guard against a solve which doesn't
+    // converge.
+    unsigned int maxIterations;
+    if (useMultigrid)
+        maxIterations = 200 + (unsigned int)std::sqrt((double)floodCount);
+    else
+        maxIterations = 1000 + 4 * (unsigned int)std::sqrt((double)floodCount);
 
-        // Break from the loop in case the brush radius includes all
-        // vertices.
-        if (indices.length() == (unsigned)vtxIter.count())
-        {
-            break;
-        }
+    diffusionSolver solver;
+    if (useMultigrid)
+    {
+        if (multigrid.isEmpty())
+            multigrid.create(operators);
+        if (!multigrid.setup(operators, time, fixed))
+            return MStatus::kFailure;
     }
-}
-
+    else
+        solver.create(operators, time, fixed);
 
-//
-// Description:
-//      Get the vertices which are connected to the given index and
-//      their falloff values.
-//
-// Input Arguments:
-//      centerPoint         The intersection surface point.
-//      index               The index of the current vertex.
-//      visited             The array of indices which already have been
-//                          visited and processed.
-//      indices             The array of connected indices if they are
-//                          within the range.
-//      values              The array of distances of the indices to the
-//                          surface point.
-//      oppositeIndex       The opposite index of the given index if
-//                          this is located on a shell boundary.
-//
-// Return Value:
-//      None
-//
-void smoothWeightsContext::getConnectedInRange(MPoint centerPoint,
-                                               int index,
-                                               std::vector<bool> &visited,
-                                               MIntArray &indices,
-                                               MFloatArray &values,
-                                               int &oppositeIndex)
-{
-    unsigned int i;
+    // -----------------------------------------------------------------
+    // solve per influence
+    // -----------------------------------------------------------------
 
-    MItMeshVertex vtxIter(meshDag);
+    scopedTimer computeTimer(stats, strokeStats::kCompute);
 
-    int prevIndex;
-    vtxIter.setIndex(index, prevIndex);
+    // Locked influences keep their weights.
+    std::vector<unsigned int> influences;
+    for (i = 0; i < influenceCount; i ++)
+    {
+        if (!isLocked(i))
+            influences.push_back(i);
+    }
 
-    // Get the connected vertices of the current index.
-    MIntArray connectedIndices;
-    vtxIter.getConnectedVertices(connectedIndices);
+    std::atomic<bool> converged(true);
 
-    // If the selection should span across the shell boundary get the
-    // opposite vertex and it's connected vertices.
-    if (keepShellsTogetherVal)
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, (unsigned)influences.size()),
+                      [&](tbb::blocked_range<unsigned int> r)
     {
-        // If the index has already been mapped simply get the opposite
-        // index from the mapping array and then get it's connected
-        // vertices.
-        if (indexMap[(unsigned)index] > -1)
+        std::vector<double> values(numVertices);
+
+        for (unsigned int k = r.begin(); k < r.end(); k ++)
         {
-            oppositeIndex = indexMap[(unsigned)index];
+            // There is no need to continue once a solve has failed.
+            if (!converged)
+                return;
 
-            // Add the opposite vertex to the array of connected
-            // vertices.
-            connectedIndices.append(oppositeIndex);
+            unsigned int influence = influences[k];
 
-            // Get all vertices which are connected to the opposite
-            // boundary vertex and add them to the array of connected
-            // vertices.
-            appendConnectedIndices(oppositeIndex, connectedIndices);
-        }
-        // Otherwise, if the index has't been mapped yet check if the
-        // current vertex is located on the boundary.
-        else if (onBoundary(index))
-        {
-            MIntArray faces;
-            vtxIter.getConnectedFaces(faces);
+            // Influences without any weights can be skipped.
+            bool hasWeights = false;
+            for (unsigned int v = 0; v < numVertices; v ++)
+            {
+                values[v] = currentWeights[v * influenceCount + influence];
+                if (values[v] > 0.0)
+                    hasWeights = true;
+            }
+            if (!hasWeights)
+                continue;
 
-            MIntArray edges;
-            vtxIter.getConnectedEdges(edges);
+            unsigned int iterations;
+            bool result;
+            if (useMultigrid)
+                result = multigrid.solve(values, 1e-5, maxIterations, iterations);
+            else
+                result = solver.solve(values, 1e-5, maxIterations, iterations);
+            if (!result)
+            {
+                converged = false;
+                return;
+            }
 
-            // In case it's a boundary vertex get the opposite vertex.
-            if (oppositeBoundaryIndex(vtxIter.position(), faces, edges, oppositeIndex))
+            for (unsigned int v = 0; v < floodCount; v ++)
             {
-                // Add the opposite vertex to the array of connected
-                // vertices.
-                connectedIndices.append(oppositeIndex);
-
-                // Get all vertices which are connected to the opposite
-                // boundary vertex and add them to the array of
-                // connected vertices.
-                appendConnectedIndices(oppositeIndex, connectedIndices);
+                unsigned int index = (unsigned)vtxSelection[v];
+                double value = values[index];
+                if (value < 0.0)
+                    value = 0.0;
+                currentWeights[index * influenceCount + influence] = value;
             }
         }
+    });
+
+    // Restore the weights of the flood vertices from the undo weights,
+    // which have been read with the press.
+    if (!converged)
+    {
+        for (i = 0; i < floodCount; i ++)
+        {
+            unsigned int offset = (unsigned)vtxSelection[i] * influenceCount;
+            for (unsigned int j = 0; j < influenceCount; j ++)
+                currentWeights[offset + j] = prevWeights[offset + j];
+        }
+
+        MGlobal::displayWarning("The implicit flood did not converge. "
+                                "The weights are smoothed with the default flood instead.");
+        return MStatus::kFailure;
     }
 
-    for (i = 0; i < connectedIndices.length(); i ++)
+    // -----------------------------------------------------------------
+    // shell boundaries
+    // -----------------------------------------------------------------
+
+    // The solve doesn't know about the opposite vertices of shell
+    // boundaries. Both vertices of a pair get the average weights.
+    if (keepShellsTogetherVal)
     {
-        int nextIndex = connectedIndices[i];
-        // Continue if the current index hasn't been processed yet.
-        if (!visited[(unsigned)nextIndex])
+        updateTopology();
+
+        for (i = 0; i < floodCount; i ++)
         {
-            MPoint pos;
-            meshFn.getPoint(nextIndex, pos, MSpace::kWorld);
-            MVector delta(pos - centerPoint);
-            double distance = delta.length();
+            unsigned int index = (unsigned)vtxSelection[i];
+            if (!topology.onBoundary(index))
+                continue;
+
+            int oppositeIndex = getOppositeIndex((int)index);
+            if (oppositeIndex < (int)index || fixed[(unsigned)oppositeIndex])
+                continue;
 
-            // Check of the vertex position is within the brush radius.
-            if (distance <= sizeVal)
+            for (unsigned int j = 0; j < influenceCount; j ++)
             {
-                // Append the index and the distance to the arrays.
-                indices.append(nextIndex);
-                values.append((float)(1 - (distance / sizeVal)));
-                // Mark the index as visited.
-                visited[(unsigned)nextIndex] = true;
+                unsigned int a = index * influenceCount + j;
+                unsigned int b = (unsigned)oppositeIndex * influenceCount + j;
+                double value = (currentWeights[a] + currentWeights[b]) * 0.5;
+                currentWeights[a] = value;
+                currentWeights[b] = value;
             }
         }
     }
-}
 
+    // -----------------------------------------------------------------
+    // maintain max influences & normalize
+    // -----------------------------------------------------------------
 
-//
-// Description:
-//      Get the connected vertices of the given index and append then to
-//      the given array of indices.
-//
-// Input Arguments:
-//      index               The vertex index.
-//      indices             The array of connected indices to append to.
-//
-// Return Value:
-//      None
-//
-void smoothWeightsContext::appendConnectedIndices(int index, MIntArray &indices)
-{
-    unsigned int i;
+    std::vector<unsigned int> allInfluences(influenceCount);
+    for (i = 0; i < influenceCount; i ++)
+        allInfluences[i] = i;
 
-    MItMeshVertex vtxIter(meshDag);
+    std::vector<bool> locks;
+    if (!ignoreLockVal)
+        locks = influenceLocks;
 
-    int prevIndex;
-    vtxIter.setIndex(index, prevIndex);
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, floodCount),
+                      [&](tbb::blocked_range<unsigned int> r)
+    {
+        std::vector<double> values(influenceCount);
+        std::vector<unsigned int> order;
 
-    MIntArray vertexList;
-    vtxIter.getConnectedVertices(vertexList);
+        for (unsigned int k = r.begin(); k < r.end(); k ++)
+        {
+            unsigned int offset = (unsigned)vtxSelection[k] * influenceCount;
+            unsigned int j;
 
-    for (i = 0; i < vertexList.length(); i ++)
-        indices.append(vertexList[i]);
-}
+            for (j = 0; j < influenceCount; j ++)
+                values[j] = currentWeights[offset + j];
+
+            if (maintainMaxInfluences && influenceCount > maxInfluences)
+            {
+                limitInfluences(values.data(), allInfluences.data(), influenceCount,
+                                locks, lockedCount, maxInfluences, order);
+            }
+
+            if (normalize)
+                normalizeWeights(values.data(), allInfluences.data(), influenceCount, locks);
+
+            for (j = 0; j < influenceCount; j ++)
+                currentWeights[offset + j] = values[j];
+        }
+    });
+
+    computeTimer.stop();
+
+    // -----------------------------------------------------------------
+    // set the weights
+    // -----------------------------------------------------------------
+
+    MFnSingleIndexedComponent compFn;
+    MObject vtxComponents = compFn.create(MFn::kMeshVertComponent);
+    compFn.addElements(vtxSelection);
+    MIntArray floodIndices;
+    compFn.getElements(floodIndices);
+
+    smoothedWeights = MDoubleArray(floodIndices.length() * influenceCount, 0.0);
+    for (i = 0; i < floodIndices.length(); i ++)
+    {
+        unsigned int offset = (unsigned)floodIndices[i] * influenceCount;
+        for (unsigned int j = 0; j < influenceCount; j ++)
+            smoothedWeights[i * influenceCount + j] = currentWeights[offset + j];
+    }
+
+    // Add the flood vertices to the component list for undo.
+    MFnSingleIndexedComponent smoothedCompFn(smoothedCompObj);
+    smoothedCompFn.addElements(floodIndices);
+
+    scopedTimer setWeightsTimer(stats, strokeStats::kSetWeights);
+    counters.add(strokeCounters::kSetWeightsCalls);
+    counters.add(strokeCounters::kSetWeightsRows, floodIndices.length());
+    skinFn.setWeights(meshDag, vtxComponents, influenceIndices, smoothedWeights, normalize);
+    setWeightsTimer.stop();
+
+    scopedTimer refreshTimer(stats, strokeStats::kRefresh);
+    view.refresh(true);
+
+    return status;
+}
 
 
 //
 // Description:
-//      Return the vertex indices within the brush volume.
+//      Return a component MObject for all vertex components of the
+//      given mesh.
 //
 // Input Arguments:
-//      None
+//      meshDag             The dagPath of the mesh object.
 //
 // Return Value:
-//      int array           The array of indices in the volume.
+//      MObject             The component object for all mesh vertices.
 //
-MIntArray smoothWeightsContext::getVerticesInVolume()
+MObject smoothWeightsContext::allVertexComponents(MDagPath meshDag)
 {
-    MIntArray indices;
+    MFnSingleIndexedComponent compFn;
+    MObject vtxComponents = compFn.create(MFn::kMeshVertComponent);
+    MFnMesh meshFn(meshDag);
+    compFn.setCompleteData((int)numVertices);
+    return vtxComponents;
+}
 
-    double radius = sizeVal * sizeVal;
 
-    MItMeshVertex vtxIter(meshDag);
-    while (!vtxIter.isDone())
+// ---------------------------------------------------------------------
+// mesh walking to collect vertices inside the brush radius
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Based on the given index find the connected indices within the
+//      brush radius and their distances to the respective surface
+//      point.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      hitIndex            The index of the item along the intersection
+//                          ray.
+//      indices             The array of indices within the range.
+//      values              The array of falloff values for the indices.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::getVerticesInRange(int index,
+                                              int hitIndex,
+                                              MIntArray &indices,
+                                              MFloatArray &values)
+{
+    unsigned int i;
+
+    if (distanceVal == 1 && topology.hasPoints())
+    {
+        getVerticesInGeodesicRange(index, hitIndex, indices, values);
+        return;
+    }
+    else if (distanceVal == 2 && !heat.isEmpty())
     {
-        MPoint pnt = vtxIter.position(MSpace::kWorld);
+        getVerticesInHeatRange(index, hitIndex, indices, values);
+        return;
+    }
+
+    // Walk outward from the center vertex over the cached adjacency as
+    // long as the connected vertices are within the brush radius. The
+    // walk includes the opposite vertices of shell boundaries.
+    MPoint centerPoint = centerPoints[(unsigned)hitIndex];
+    double center[3] = {centerPoint.x, centerPoint.y, centerPoint.z};
+
+    std::vector<unsigned int> rangeIndices;
+    std::vector<double> rangeDistances;
+    topology.getEuclideanRange((unsigned)index,
+                               center,
+                               sizeVal,
+                               [this](unsigned int vertex)
+                               { return getOppositeIndex((int)vertex); },
+                               rangeIndices,
+                               rangeDistances);
+
+    counters.add(strokeCounters::kRangeVertices, rangeIndices.size());
+
+    for (i = 0; i < rangeIndices.size(); i ++)
+    {
+        indices.append((int)rangeIndices[i]);
+        values.append((float)(1 - (rangeDistances[i] / sizeVal)));
+    }
+}
 
-        double x = pnt.x - surfacePoints[0].x;
-        double y = pnt.y - surfacePoints[0].y;
-        double z = pnt.z - surfacePoints[0].z;
 
-        x *= x;
-        y *= y;
-        z *= z;
+//
+// Description:
+//      Based on the given index find the connected indices within the
+//      brush radius by measuring the distance along the mesh edges
+//      instead of the straight distance to the surface point.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      hitIndex            The index of the item along the intersection
+//                          ray.
+//      indices             The array of indices within the range.
+//      values              The array of falloff values for the indices.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::getVerticesInGeodesicRange(int index,
+                                                      int hitIndex,
+                                                      MIntArray &indices,
+                                                      MFloatArray &values)
+{
+    unsigned int i;
 
-        if (x + y + z <= radius)
-            indices.append(vtxIter.index());
+    MPoint pos = getVertexPosition(index, MSpace::kWorld);
+    double startDistance = pos.distanceTo(centerPoints[(unsigned)hitIndex]);
 
-        vtxIter.next();
-    }
+    std::vector<unsigned int> rangeIndices;
+    std::vector<double> rangeDistances;
+    topology.getGeodesicRange((unsigned)index,
+                              startDistance,
+                              sizeVal,
+                              [this](unsigned int vertex)
+                              { return getOppositeIndex((int)vertex); },
+                              rangeIndices,
+                              rangeDistances);
 
-    return indices;
+    counters.add(strokeCounters::kRangeVertices, rangeIndices.size());
+
+    for (i = 0; i < rangeIndices.size(); i ++)
+    {
+        indices.append((int)rangeIndices[i]);
+        values.append((float)(1 - (rangeDistances[i] / sizeVal)));
+    }
 }
 
 
 //
 // Description:
-//      Return the vertex indices of the brush volume which are within
-//      the range of the current index.
+//      Based on the given index find the indices within the brush
+//      radius by using the heat method distance field of the mesh. The
+//      distances of all vertices are the result of two solves with the
+//      prefactored operators.
 //
 // Input Arguments:
 //      index               The vertex index.
-//      volumeIndices       The array of all indices of the brush
-//                          volume.
-//      rangeIndices        The array of indices which are in range of
-//                          the vertex.
-//      values              The array of falloff values based on the
-//                          distance to the center vertex.
+//      hitIndex            The index of the item along the intersection
+//                          ray.
+//      indices             The array of indices within the range.
+//      values              The array of falloff values for the indices.
 //
 // Return Value:
 //      None
 //
-void smoothWeightsContext::getVerticesInVolumeRange(int index,
-                                                    MIntArray volumeIndices,
-                                                    MIntArray &rangeIndices,
-                                                    MFloatArray &values)
+void smoothWeightsContext::getVerticesInHeatRange(int index,
+                                                  int hitIndex,
+                                                  MIntArray &indices,
+                                                  MFloatArray &values)
 {
     unsigned int i;
 
-    double radius = sizeVal * rangeVal;
-    radius *= radius;
+    MPoint pos = getVertexPosition(index, MSpace::kWorld);
+    double startDistance = pos.distanceTo(centerPoints[(unsigned)hitIndex]);
 
-    double smoothStrength = strengthVal;
-    if (fractionOversamplingVal)
-        smoothStrength /= oversamplingVal;
+    std::vector<unsigned int> sources(1, (unsigned)index);
+    std::vector<double> distances;
+    heat.getDistances(sources, distances);
+
+    counters.add(strokeCounters::kRangeVertices, distances.size());
+
+    for (i = 0; i < distances.size(); i ++)
+    {
+        double distance = startDistance + distances[i];
+        if (i != (unsigned)index && distance <= sizeVal)
+        {
+            indices.append((int)i);
+            values.append((float)(1 - (distance / sizeVal)));
+        }
+    }
+}
+
+
+//
+// Description:
+//      Return the vertex on the neighbouring shell which shares the
+//      position with the given border vertex. Previously mapped pairs
+//      are taken from the index map.
+//
+// Input Arguments:
+//      index               The index of the border vertex.
+//
+// Return Value:
+//      int                 The opposite vertex index or -1.
+//
+int smoothWeightsContext::getOppositeIndex(int index)
+{
+    if (!keepShellsTogetherVal)
+        return -1;
+
+    if (indexMap[(unsigned)index] > -1)
+        return indexMap[(unsigned)index];
 
     MItMeshVertex vtxIter(meshDag);
+    counters.add(strokeCounters::kIterators);
+
     int prevIndex;
     vtxIter.setIndex(index, prevIndex);
 
-    MPoint point = vtxIter.position(MSpace::kWorld);
+    MIntArray faces;
+    vtxIter.getConnectedFaces(faces);
+
+    MIntArray edges;
+    vtxIter.getConnectedEdges(edges);
+
+    counters.add(strokeCounters::kArrays, 2);
 
-    for (i = 0; i < volumeIndices.length(); i ++)
+    int oppositeIndex;
+    if (oppositeBoundaryIndex(getVertexPosition(vtxIter, MSpace::kObject), faces, edges, oppositeIndex) &&
+        oppositeIndex != index)
+        return oppositeIndex;
+
+    return -1;
+}
+
+
+//
+// Description:
+//      Build the cached vertex adjacency of the mesh if it doesn't
+//      exist yet and update the edge lengths from the current world
+//      space positions.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::updateTopology()
+{
+    if (topology.isEmpty())
     {
-        int volumeIndex = volumeIndices[i];
+        std::vector<int> counts;
+        std::vector<int> vertices;
+        getPolygonValues(counts, vertices);
+
+        topology.create(numVertices, counts, vertices);
+    }
 
-        vtxIter.setIndex(volumeIndex, prevIndex);
+    // The edge lengths only change with the shape of the mesh or when
+    // switching between the bind pose and the current shape.
+    if (topology.hasPoints() && !(dirtyLayers & kDirtyPoints))
+        return;
 
-        MPoint pnt = vtxIter.position(MSpace::kWorld);
+    std::vector<double> values;
+    getPointValues(values);
+    topology.setPoints(values);
+    dirtyLayers &= ~kDirtyPoints;
+}
 
-        double x = pnt.x - point.x;
-        double y = pnt.y - point.y;
-        double z = pnt.z - point.z;
 
-        x *= x;
-        y *= y;
-        z *= z;
+//
+// Description:
+//      Triangulate the mesh and factorize the heat method operators if
+//      this hasn't been done yet for the current mesh. The operators
+//      are based on the world space positions at the time of the first
+//      use and are kept until the mesh changes.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::updateHeatDistance()
+{
+    if (!heat.isEmpty() || heatFailed)
+        return;
+
+    std::vector<int> triangles;
+    getTriangleValues(triangles);
+
+    std::vector<double> values;
+    getPointValues(values);
+
+    // A failed factorization is remembered until the mesh or the bind
+    // pose setting changes, so that it doesn't get repeated with every
+    // press.
+    if (!heat.create(numVertices, triangles, values))
+    {
+        heatFailed = true;
+        MGlobal::displayWarning("The heat method could not be set up for the mesh. "
+                                "The distance is measured in euclidean space.");
+    }
+}
+
+
+//
+// Description:
+//      Build the cotangent smoothing weights if this hasn't been done
+//      yet for the current mesh.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::updateSmoothingOperator()
+{
+    if (!smoothing.isEmpty())
+        return;
+
+    updateOperators();
+    smoothing.create(operators);
+}
+
+
+//
+// Description:
+//      Build the cotangent Laplacian and the mass matrix if this hasn't
+//      been done yet for the current mesh.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::updateOperators()
+{
+    if (!operators.isEmpty())
+        return;
+
+    std::vector<int> triangles;
+    getTriangleValues(triangles);
+
+    std::vector<double> values;
+    getPointValues(values);
+
+    operators.create(numVertices, triangles, values);
+}
+
+
+// ---------------------------------------------------------------------
+// bind pose
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Capture the world space positions of the skin cluster input
+//      geometry, which is the mesh before the deformation. These are
+//      independent of the current pose and are kept for the mesh.
+//      Also create the intersector for the seam detection based on the
+//      input geometry.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStatus             kSuccess if the input geometry matches the
+//                          mesh.
+//
+MStatus smoothWeightsContext::captureBindPose()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    bindPoints.clear();
+
+    MFnSkinCluster skinFn(skinObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    unsigned int index = skinFn.indexForOutputShape(meshDag.node(), &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    // Get the geometry from the input plug of the skin cluster so that
+    // any deformation before the skin cluster is included.
+    MPlug inputPlug = skinFn.findPlug("input", false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    inputPlug = inputPlug.elementByLogicalIndex(index, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    MPlug geometryPlug = inputPlug.child(0, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MObject inputObj = geometryPlug.asMObject();
+    MFnMesh inputFn(inputObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    // The input geometry is only usable if the vertices match.
+    if ((unsigned)inputFn.numVertices() != numVertices)
+        return MStatus::kFailure;
+
+    MMatrix matrix = meshDag.inclusiveMatrix();
+
+    status = bindIntersector.create(inputObj, matrix);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MPointArray points;
+    inputFn.getPoints(points, MSpace::kObject);
+    for (i = 0; i < points.length(); i ++)
+        points[i] *= matrix;
+
+    bindPoints = points;
+
+    return status;
+}
+
+
+//
+// Description:
+//      Return if the distances are measured on the input geometry of
+//      the skin cluster.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      bool                True, if the bind pose has been captured.
+//
+bool smoothWeightsContext::useBindPose()
+{
+    return bindPoseVal && bindPoints.length() == numVertices;
+}
+
+
+//
+// Description:
+//      Return the position on the input geometry which corresponds to
+//      the given position on a triangle of the mesh.
+//
+// Input Arguments:
+//      faceIndex           The index of the polygon.
+//      triangleIndex       The index of the triangle of the polygon.
+//      bary1               The barycentric coordinate of the first
+//                          triangle vertex.
+//      bary2               The barycentric coordinate of the second
+//                          triangle vertex.
+//
+// Return Value:
+//      MPoint              The position in bind pose.
+//
+MPoint smoothWeightsContext::getBindPoint(int faceIndex, int triangleIndex, float bary1, float bary2)
+{
+    int vertices[3];
+    meshFn.getPolygonTriangleVertices(faceIndex, triangleIndex, vertices);
+
+    MPoint p1 = bindPoints[(unsigned)vertices[0]];
+    MPoint p2 = bindPoints[(unsigned)vertices[1]];
+    MPoint p3 = bindPoints[(unsigned)vertices[2]];
+    double bary3 = 1.0 - bary1 - bary2;
+
+    return MPoint(p1.x * bary1 + p2.x * bary2 + p3.x * bary3,
+                  p1.y * bary1 + p2.y * bary2 + p3.y * bary3,
+                  p1.z * bary1 + p2.z * bary2 + p3.z * bary3);
+}
+
+
+//
+// Description:
+//      Return the position of the given vertex which is used for
+//      measuring distances. This is the world space position of the
+//      input geometry when using the bind pose.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      space               The space of the mesh position.
+//
+// Return Value:
+//      MPoint              The vertex position.
+//
+MPoint smoothWeightsContext::getVertexPosition(int index, MSpace::Space space)
+{
+    if (useBindPose())
+        return bindPoints[(unsigned)index];
+
+    MPoint position;
+    meshFn.getPoint(index, position, space);
+    return position;
+}
+
+
+//
+// Description:
+//      Return the position of the current vertex of the given iterator
+//      which is used for measuring distances.
+//
+// Input Arguments:
+//      vtxIter             The vertex iterator set to the vertex.
+//      space               The space of the mesh position.
+//
+// Return Value:
+//      MPoint              The vertex position.
+//
+MPoint smoothWeightsContext::getVertexPosition(MItMeshVertex &vtxIter, MSpace::Space space)
+{
+    if (useBindPose())
+        return bindPoints[(unsigned)vtxIter.index()];
+
+    return vtxIter.position(space);
+}
+
+
+//
+// Description:
+//      Get the world space positions of all mesh vertices as a flat
+//      array of xyz values. These are the positions of the input
+//      geometry when using the bind pose.
+//
+// Input Arguments:
+//      values              The array of positions.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::getPointValues(std::vector<double> &values)
+{
+    unsigned int i;
+
+    MPointArray points;
+    if (useBindPose())
+        points = bindPoints;
+    else
+        meshFn.getPoints(points, MSpace::kWorld);
+
+    values.resize(points.length() * 3);
+    for (i = 0; i < points.length(); i ++)
+    {
+        values[i * 3] = points[i].x;
+        values[i * 3 + 1] = points[i].y;
+        values[i * 3 + 2] = points[i].z;
+    }
+}
+
+
+//
+// Description:
+//      Get the vertex indices of all mesh triangles as a flat array.
+//
+// Input Arguments:
+//      values              The array of triangle vertex indices.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::getTriangleValues(std::vector<int> &values)
+{
+    MIntArray triangleCounts;
+    MIntArray triangleVertices;
+    meshFn.getTriangles(triangleCounts, triangleVertices);
+
+    values.resize(triangleVertices.length());
+    triangleVertices.get(values.data());
+}
+
+
+//
+// Description:
+//      Get the vertex count and the vertex indices of all mesh
+//      polygons as flat arrays.
+//
+// Input Arguments:
+//      counts              The array of vertex counts per polygon.
+//      vertices            The array of polygon vertex indices.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::getPolygonValues(std::vector<int> &counts, std::vector<int> &vertices)
+{
+    MIntArray polyCounts;
+    MIntArray polyVertices;
+    meshFn.getVertices(polyCounts, polyVertices);
+
+    counts.resize(polyCounts.length());
+    vertices.resize(polyVertices.length());
+    polyCounts.get(counts.data());
+    polyVertices.get(vertices.data());
+}
+
+
+//
+// Description:
+//      Return the vertex indices within the brush volume.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      int array           The array of indices in the volume.
+//
+MIntArray smoothWeightsContext::getVerticesInVolume()
+{
+    unsigned int i;
+
+    MIntArray indices;
+
+    double center[3] = {centerPoints[0].x, centerPoints[0].y, centerPoints[0].z};
+
+    std::vector<unsigned int> volumeIndices;
+    topology.getVerticesInSphere(center, sizeVal, volumeIndices);
+
+    for (i = 0; i < volumeIndices.size(); i ++)
+        indices.append((int)volumeIndices[i]);
+
+    counters.add(strokeCounters::kRangeVertices, numVertices);
+    counters.add(strokeCounters::kArrays);
+
+    return indices;
+}
+
+
+//
+// Description:
+//      Calculate the brush weight value based on the given linear
+//      falloff value.
+//
+// Input Arguments:
+//      value               The linear falloff value.
+//      strength            The brush strength value.
+//
+// Return Value:
+//      double              The brush curve-based falloff value.
+//
+double smoothWeightsContext::getFalloffValue(double value, double strength)
+{
+    return falloffValue(curveVal, value, strength);
+}
+
+
+//
+// Description:
+//      Return if the given event is valid by querying the mouse button
+//      and testing the returned MStatus.
+//
+// Input Arguments:
+//      event               The MEvent to test.
+//
+// Return Value:
+//      bool                True, if the event is valid.
+//
+bool smoothWeightsContext::eventIsValid(MEvent event)
+{
+    MStatus status;
+    event.mouseButton(&status);
+    if (!status)
+        return false;
+    return true;
+}
+
+
+// ---------------------------------------------------------------------
+// mirror
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Build the mirror map for the vertices. The map is kept for the
+//      mesh and only gets rebuilt when the mesh or the mirror settings
+//      change. It's based on the positions the distances are measured
+//      on.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::updateMirror()
+{
+    unsigned int axis = (unsigned)(mirrorVal - 1);
 
-        double delta = x + y + z;
+    if (mirror.size() != numVertices)
+    {
+        std::vector<double> points;
+        getPointValues(points);
+        mirror.create(points, axis, mirrorToleranceVal);
 
-        if (volumeIndex != index && delta <= radius)
-        {
-            rangeIndices.append(volumeIndex);
+        mirrorStamps = std::vector<unsigned int>(numVertices, 0);
+        mirrorGeneration = 0;
+    }
+}
 
-            float value = (float)(1 - (delta / radius));
-            value = (float)getFalloffValue(value, smoothStrength);
-            values.append(value);
-        }
 
-        vtxIter.next();
-    }
+//
+// Description:
+//      Return if the brush gets mirrored.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      bool                True, if the mirror map matches the mesh.
+//
+bool smoothWeightsContext::useMirror()
+{
+    return mirrorVal > 0 && mirror.size() == numVertices;
 }
 
 
 //
 // Description:
-//      Calculate the brush weight value based on the given linear
-//      falloff value.
+//      Append the mirrored vertices of the given brush vertices to the
+//      indices along with the falloff value of their source vertex, so
+//      that both sides get smoothed in the same pass. Vertices which
+//      are already part of the brush aren't added twice.
+//      The vertices get stamped with the current generation, which
+//      avoids clearing an array for all vertices with each dab.
 //
 // Input Arguments:
-//      value               The linear falloff value.
-//      strength            The brush strength value.
+//      indices             The vertex indices of the brush.
+//      values              The falloff values of the brush vertices.
 //
 // Return Value:
-//      double              The brush curve-based falloff value.
+//      None
 //
-double smoothWeightsContext::getFalloffValue(double value, double strength)
+void smoothWeightsContext::appendMirrorIndices(MIntArray &indices, MFloatArray &values)
 {
-    if (curveVal == 0)
-        return 1.0 * strength;
-    // linear
-    else if (curveVal == 1)
-        return value * strength;
-    // smoothstep
-    else if (curveVal == 2)
-        return (value * value * (3 - 2 * value)) * strength;
-    // narrow - quadratic
-    else if (curveVal == 3)
-        return (1 - pow((1 - value) / 1, 0.4)) * strength;
-    else
-        return value;
+    unsigned int i;
+
+    // Each dab uses two stamps, one for the brush vertices and one for
+    // the mirrored vertices.
+    mirrorGeneration += 2;
+    if (mirrorGeneration < 2)
+    {
+        std::fill(mirrorStamps.begin(), mirrorStamps.end(), 0);
+        mirrorGeneration = 2;
+    }
+
+    unsigned int count = indices.length();
+    for (i = 0; i < count; i ++)
+        mirrorStamps[(unsigned)indices[i]] = mirrorGeneration;
+
+    for (i = 0; i < count; i ++)
+    {
+        int index = mirror.mirrorIndex((unsigned)indices[i]);
+        if (index != -1 && mirrorStamps[(unsigned)index] < mirrorGeneration)
+        {
+            mirrorStamps[(unsigned)index] = mirrorGeneration + 1;
+            indices.append(index);
+            values.append(values[i]);
+        }
+    }
+
+    counters.add(strokeCounters::kRangeVertices, indices.length() - count);
 }
 
 
 //
 // Description:
-//      Return if the given event is valid by querying the mouse button
-//      and testing the returned MStatus.
+//      Return if the given vertex has been added as the mirrored vertex
+//      of the current dab.
 //
 // Input Arguments:
-//      event               The MEvent to test.
+//      index               The vertex index.
 //
 // Return Value:
-//      bool                True, if the event is valid.
+//      bool                True, if the vertex is mirrored.
 //
-bool smoothWeightsContext::eventIsValid(MEvent event)
+bool smoothWeightsContext::isMirrored(unsigned int index)
 {
-    MStatus status;
-    event.mouseButton(&status);
-    if (!status)
-        return false;
-    return true;
+    return useMirror() && mirrorStamps[index] == mirrorGeneration + 1;
 }
 
 
@@ -2978,6 +4543,11 @@ bool smoothWeightsContext::onBoundary(int index)
 {
     unsigned int i;
 
+    // The border flags are known without querying the mesh once the
+    // adjacency has been built or read from the topology cache.
+    if (!topology.isEmpty())
+        return topology.onBoundary((unsigned)index);
+
     int prevIndex;
 
     MItMeshVertex vtxIter(meshDag);
@@ -2988,6 +4558,9 @@ bool smoothWeightsContext::onBoundary(int index)
 
     MItMeshEdge edgeIter(meshDag);
 
+    counters.add(strokeCounters::kIterators, 2);
+    counters.add(strokeCounters::kArrays);
+
     for (i = 0; i < edges.length(); i ++)
     {
         edgeIter.setIndex(edges[i], prevIndex);
@@ -3025,6 +4598,11 @@ bool smoothWeightsContext::oppositeBoundaryIndex(MPoint point,
 
     bool result = false;
 
+    counters.add(strokeCounters::kSeamLookups);
+
+    // The faces and edges are passed by value.
+    counters.add(strokeCounters::kArrays, 2);
+
     int faceIndex;
 
     double edgeLength = averageEdgeLength(edges) * 0.25;
@@ -3072,14 +4650,16 @@ bool smoothWeightsContext::oppositeBoundaryIndex(MPoint point,
     MIntArray vertices;
     polyIter.getVertices(vertices);
 
+    counters.add(strokeCounters::kIterators);
+    counters.add(strokeCounters::kArrays);
+
     // Go through the face vertices and check which one matches the
     // position of the initial boundary vertex.
     for (i = 0; i < vertices.length(); i ++)
     {
         int vtx = vertices[i];
 
-        MPoint vtxPoint;
-        meshFn.getPoint(vtx, vtxPoint);
+        MPoint vtxPoint = getVertexPosition(vtx, MSpace::kObject);
         if (vtxPoint.isEquivalent(point, toleranceVal))
         {
             index = vtx;
@@ -3111,9 +4691,15 @@ bool smoothWeightsContext::getClosestFace(MPoint point, MIntArray faces, int &in
 {
     unsigned int i;
 
+    // The faces are passed by value.
+    counters.add(strokeCounters::kArrays);
+
     // Get the closest point to the given boundary point.
     MPointOnMesh meshPoint;
-    intersector.getClosestPoint(point, meshPoint);
+    if (useBindPose())
+        bindIntersector.getClosestPoint(point, meshPoint);
+    else
+        intersector.getClosestPoint(point, meshPoint);
 
     // The face index of the closest point.
     index = meshPoint.faceIndex();
@@ -3148,6 +4734,10 @@ double smoothWeightsContext::averageEdgeLength(MIntArray edges)
 
     MItMeshEdge edgeIter(meshDag);
 
+    // The edges are passed by value.
+    counters.add(strokeCounters::kArrays);
+    counters.add(strokeCounters::kIterators);
+
     int prevIndex;
     for (i = 0; i < numEdges; i ++)
     {
@@ -3182,6 +4772,46 @@ void smoothWeightsContext::setAffectSelected(bool value)
 }
 
 
+void smoothWeightsContext::setBindPose(bool value)
+{
+    // The edge lengths and the operators are based on the positions
+    // the distances are measured on.
+    if (value != bindPoseVal)
+    {
+        dirtyLayers |= kDirtyPoints;
+        mirror.clear();
+        heat.clear();
+        heatFailed = false;
+        operators.clear();
+        smoothing.clear();
+        multigrid.clear();
+    }
+
+    bindPoseVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
+void smoothWeightsContext::setCacheDirectory(MString value)
+{
+    cacheDirectoryVal = value;
+
+    // Saving the scene only writes the weight cache while a directory
+    // is set.
+    if (cacheDirectoryVal.length() && saveCallbackId == 0)
+    {
+        saveCallbackId = MSceneMessage::addCallback(MSceneMessage::kAfterSave,
+                                                    afterSaveCallback,
+                                                    this);
+    }
+    else if (!cacheDirectoryVal.length() && saveCallbackId != 0)
+    {
+        MMessage::removeCallback(saveCallbackId);
+        saveCallbackId = 0;
+    }
+}
+
+
 void smoothWeightsContext::setColorR(float value)
 {
     colorVal.r = value;
@@ -3224,6 +4854,13 @@ void smoothWeightsContext::setDepthStart(int value)
 }
 
 
+void smoothWeightsContext::setDistance(int value)
+{
+    distanceVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void smoothWeightsContext::setDrawBrush(bool value)
 {
     drawBrushVal = value;
@@ -3261,6 +4898,20 @@ void smoothWeightsContext::setFlood(double value)
 }
 
 
+void smoothWeightsContext::setFloodMode(int value)
+{
+    floodModeVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
+void smoothWeightsContext::setFloodTolerance(double value)
+{
+    floodToleranceVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void smoothWeightsContext::setFractionOversampling(bool value)
 {
     fractionOversamplingVal = value;
@@ -3298,6 +4949,27 @@ void smoothWeightsContext::setMessage(int value)
 }
 
 
+void smoothWeightsContext::setMirror(int value)
+{
+    // The mirror map needs to be rebuilt for a different plane.
+    if (value != mirrorVal)
+        mirror.clear();
+
+    mirrorVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
+void smoothWeightsContext::setMirrorTolerance(double value)
+{
+    if (value != mirrorToleranceVal)
+        mirror.clear();
+
+    mirrorToleranceVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void smoothWeightsContext::setOversampling(int value)
 {
     oversamplingVal = value;
@@ -3305,6 +4977,13 @@ void smoothWeightsContext::setOversampling(int value)
 }
 
 
+void smoothWeightsContext::setPrecision(int value)
+{
+    precisionVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void smoothWeightsContext::setRange(double value)
 {
     rangeVal = value;
@@ -3333,6 +5012,18 @@ void smoothWeightsContext::setTolerance(double value)
 }
 
 
+void smoothWeightsContext::setTrace(bool value)
+{
+    trace.setEnabled(value);
+}
+
+
+void smoothWeightsContext::setTraceFile(MString value)
+{
+    traceFileVal = value;
+}
+
+
 void smoothWeightsContext::setUndersampling(int value)
 {
     undersamplingVal = value;
@@ -3347,6 +5038,30 @@ void smoothWeightsContext::setVolume(bool value)
 }
 
 
+void smoothWeightsContext::setWeighting(int value)
+{
+    weightingVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
+//
+// Description:
+//      Write the recorded trace as a Chrome trace_event JSON file.
+//
+// Input Arguments:
+//      path                The file path of the JSON file.
+//
+// Return Value:
+//      None
+//
+void smoothWeightsContext::writeTrace(MString path)
+{
+    if (!trace.write(path.asChar()))
+        MGlobal::displayWarning("The trace could not be written to " + path + ".");
+}
+
+
 // ---------------------------------------------------------------------
 // getting values from the command flags
 // ---------------------------------------------------------------------
@@ -3357,6 +5072,18 @@ bool smoothWeightsContext::getAffectSelected()
 }
 
 
+bool smoothWeightsContext::getBindPose()
+{
+    return bindPoseVal;
+}
+
+
+MString smoothWeightsContext::getCacheDirectory()
+{
+    return cacheDirectoryVal;
+}
+
+
 float smoothWeightsContext::getColorR()
 {
     return colorVal.r;
@@ -3375,6 +5102,30 @@ float smoothWeightsContext::getColorB()
 }
 
 
+//
+// Description:
+//      Return the number of vertices and influences of the mesh and the
+//      counters of the last stroke.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStringArray        One line per counter.
+//
+MStringArray smoothWeightsContext::getCounters()
+{
+    MStringArray result;
+    result.append(("vertices " + std::to_string(numVertices)).c_str());
+    result.append(("influences " + std::to_string(influenceCount)).c_str());
+
+    std::vector<std::string> lines = counters.report();
+    for (unsigned int i = 0; i < lines.size(); i ++)
+        result.append(lines[i].c_str());
+    return result;
+}
+
+
 int smoothWeightsContext::getCurve()
 {
     return curveVal;
@@ -3393,6 +5144,12 @@ int smoothWeightsContext::getDepthStart()
 }
 
 
+int smoothWeightsContext::getDistance()
+{
+    return distanceVal;
+}
+
+
 bool smoothWeightsContext::getDrawBrush()
 {
     return drawBrushVal;
@@ -3417,6 +5174,18 @@ MString smoothWeightsContext::getExitToolCommand()
 }
 
 
+int smoothWeightsContext::getFloodMode()
+{
+    return floodModeVal;
+}
+
+
+double smoothWeightsContext::getFloodTolerance()
+{
+    return floodToleranceVal;
+}
+
+
 bool smoothWeightsContext::getFractionOversampling()
 {
     return fractionOversamplingVal;
@@ -3447,12 +5216,30 @@ int smoothWeightsContext::getMessage()
 }
 
 
+int smoothWeightsContext::getMirror()
+{
+    return mirrorVal;
+}
+
+
+double smoothWeightsContext::getMirrorTolerance()
+{
+    return mirrorToleranceVal;
+}
+
+
 int smoothWeightsContext::getOversampling()
 {
     return oversamplingVal;
 }
 
 
+int smoothWeightsContext::getPrecision()
+{
+    return precisionVal;
+}
+
+
 double smoothWeightsContext::getRange()
 {
     return rangeVal;
@@ -3465,6 +5252,27 @@ double smoothWeightsContext::getSize()
 }
 
 
+//
+// Description:
+//      Return the timings of the brush stages for all strokes since
+//      the tool has been activated and for the last stroke.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStringArray        One line per stage.
+//
+MStringArray smoothWeightsContext::getStats()
+{
+    MStringArray result;
+    std::vector<std::string> lines = stats.report();
+    for (unsigned int i = 0; i < lines.size(); i ++)
+        result.append(lines[i].c_str());
+    return result;
+}
+
+
 double smoothWeightsContext::getStrength()
 {
     return strengthVal;
@@ -3477,6 +5285,18 @@ double smoothWeightsContext::getTolerance()
 }
 
 
+bool smoothWeightsContext::getTrace()
+{
+    return trace.isEnabled();
+}
+
+
+MString smoothWeightsContext::getTraceFile()
+{
+    return traceFileVal;
+}
+
+
 int smoothWeightsContext::getUndersampling()
 {
     return undersamplingVal;
@@ -3489,6 +5309,12 @@ bool smoothWeightsContext::getVolume()
 }
 
 
+int smoothWeightsContext::getWeighting()
+{
+    return weightingVal;
+}
+
+
 // ---------------------------------------------------------------------
 // command to create the context
 // ---------------------------------------------------------------------
@@ -3519,29 +5345,43 @@ MStatus smoothWeightsContextCmd::appendSyntax()
     MSyntax syn = syntax();
 
     syn.addFlag(kAffectSelectedFlag, kAffectSelectedFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kBindPoseFlag, kBindPoseFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kCacheDirectoryFlag, kCacheDirectoryFlagLong, MSyntax::kString);
     syn.addFlag(kColorRFlag, kColorRFlagLong, MSyntax::kDouble);
     syn.addFlag(kColorGFlag, kColorGFlagLong, MSyntax::kDouble);
     syn.addFlag(kColorBFlag, kColorBFlagLong, MSyntax::kDouble);
+    syn.addFlag(kCountersFlag, kCountersFlagLong);
     syn.addFlag(kCurveFlag, kCurveFlagLong, MSyntax::kLong);
     syn.addFlag(kDepthFlag, kDepthFlagLong, MSyntax::kLong);
     syn.addFlag(kDepthStartFlag, kDepthStartFlagLong, MSyntax::kLong);
+    syn.addFlag(kDistanceFlag, kDistanceFlagLong, MSyntax::kLong);
     syn.addFlag(kDrawBrushFlag, kDrawBrushFlagLong, MSyntax::kBoolean);
     syn.addFlag(kDrawRangeFlag, kDrawRangeFlagLong, MSyntax::kBoolean);
     syn.addFlag(kEnterToolCommandFlag, kEnterToolCommandFlagLong, MSyntax::kString);
     syn.addFlag(kExitToolCommandFlag, kExitToolCommandFlagLong, MSyntax::kString);
     syn.addFlag(kFloodFlag, kFloodFlagLong, MSyntax::kDouble);
+    syn.addFlag(kFloodModeFlag, kFloodModeFlagLong, MSyntax::kLong);
+    syn.addFlag(kFloodToleranceFlag, kFloodToleranceFlagLong, MSyntax::kDouble);
     syn.addFlag(kFractionOversamplingFlag, kFractionOversamplingFlagLong, MSyntax::kBoolean);
     syn.addFlag(kIgnoreLockFlag, kIgnoreLockFlagLong, MSyntax::kBoolean);
     syn.addFlag(kKeepShellsTogetherFlag, kKeepShellsTogetherFlagLong, MSyntax::kBoolean);
     syn.addFlag(kLineWidthFlag, kLineWidthFlagLong, MSyntax::kLong);
     syn.addFlag(kMessageFlag, kMessageFlagLong, MSyntax::kLong);
+    syn.addFlag(kMirrorFlag, kMirrorFlagLong, MSyntax::kLong);
+    syn.addFlag(kMirrorToleranceFlag, kMirrorToleranceFlagLong, MSyntax::kDouble);
     syn.addFlag(kOversamplingFlag, kOversamplingFlagLong, MSyntax::kLong);
+    syn.addFlag(kPrecisionFlag, kPrecisionFlagLong, MSyntax::kLong);
     syn.addFlag(kRangeFlag, kRangeFlagLong, MSyntax::kDouble);
     syn.addFlag(kSizeFlag, kSizeFlagLong, MSyntax::kDouble);
+    syn.addFlag(kStatsFlag, kStatsFlagLong);
     syn.addFlag(kStrengthFlag, kStrengthFlagLong, MSyntax::kDouble);
     syn.addFlag(kToleranceFlag, kToleranceFlagLong, MSyntax::kDouble);
+    syn.addFlag(kTraceFlag, kTraceFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kTraceFileFlag, kTraceFileFlagLong, MSyntax::kString);
     syn.addFlag(kUndersamplingFlag, kUndersamplingFlagLong, MSyntax::kLong);
     syn.addFlag(kVolumeFlag, kVolumeFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kWeightingFlag, kWeightingFlagLong, MSyntax::kLong);
+    syn.addFlag(kWriteTraceFlag, kWriteTraceFlagLong, MSyntax::kString);
 
     return MStatus::kSuccess;
 }
@@ -3560,6 +5400,20 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setAffectSelected(value);
     }
 
+    if (argData.isFlagSet(kBindPoseFlag))
+    {
+        bool value;
+        status = argData.getFlagArgument(kBindPoseFlag, 0, value);
+        smoothContext->setBindPose(value);
+    }
+
+    if (argData.isFlagSet(kCacheDirectoryFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kCacheDirectoryFlag, 0, value);
+        smoothContext->setCacheDirectory(value);
+    }
+
     if (argData.isFlagSet(kColorRFlag))
     {
         double value;
@@ -3602,6 +5456,13 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setDepthStart(value);
     }
 
+    if (argData.isFlagSet(kDistanceFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kDistanceFlag, 0, value);
+        smoothContext->setDistance(value);
+    }
+
     if (argData.isFlagSet(kDrawBrushFlag))
     {
         bool value;
@@ -3637,6 +5498,20 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setFlood(value);
     }
 
+    if (argData.isFlagSet(kFloodModeFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kFloodModeFlag, 0, value);
+        smoothContext->setFloodMode(value);
+    }
+
+    if (argData.isFlagSet(kFloodToleranceFlag))
+    {
+        double value;
+        status = argData.getFlagArgument(kFloodToleranceFlag, 0, value);
+        smoothContext->setFloodTolerance(value);
+    }
+
     if (argData.isFlagSet(kFractionOversamplingFlag))
     {
         bool value;
@@ -3672,6 +5547,20 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setMessage(value);
     }
 
+    if (argData.isFlagSet(kMirrorFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kMirrorFlag, 0, value);
+        smoothContext->setMirror(value);
+    }
+
+    if (argData.isFlagSet(kMirrorToleranceFlag))
+    {
+        double value;
+        status = argData.getFlagArgument(kMirrorToleranceFlag, 0, value);
+        smoothContext->setMirrorTolerance(value);
+    }
+
     if (argData.isFlagSet(kOversamplingFlag))
     {
         int value;
@@ -3679,6 +5568,13 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setOversampling(value);
     }
 
+    if (argData.isFlagSet(kPrecisionFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kPrecisionFlag, 0, value);
+        smoothContext->setPrecision(value);
+    }
+
     if (argData.isFlagSet(kRangeFlag))
     {
         double value;
@@ -3707,6 +5603,20 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setTolerance(value);
     }
 
+    if (argData.isFlagSet(kTraceFlag))
+    {
+        bool value;
+        status = argData.getFlagArgument(kTraceFlag, 0, value);
+        smoothContext->setTrace(value);
+    }
+
+    if (argData.isFlagSet(kTraceFileFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kTraceFileFlag, 0, value);
+        smoothContext->setTraceFile(value);
+    }
+
     if (argData.isFlagSet(kUndersamplingFlag))
     {
         int value;
@@ -3721,6 +5631,20 @@ MStatus smoothWeightsContextCmd::doEditFlags()
         smoothContext->setVolume(value);
     }
 
+    if (argData.isFlagSet(kWeightingFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kWeightingFlag, 0, value);
+        smoothContext->setWeighting(value);
+    }
+
+    if (argData.isFlagSet(kWriteTraceFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kWriteTraceFlag, 0, value);
+        smoothContext->writeTrace(value);
+    }
+
     return status;
 }
 
@@ -3731,6 +5655,11 @@ MStatus smoothWeightsContextCmd::doQueryFlags()
 
     if (argData.isFlagSet(kAffectSelectedFlag))
         setResult(smoothContext->getAffectSelected());
+    if (argData.isFlagSet(kBindPoseFlag))
+        setResult(smoothContext->getBindPose());
+
+    if (argData.isFlagSet(kCacheDirectoryFlag))
+        setResult(smoothContext->getCacheDirectory());
 
     if (argData.isFlagSet(kColorRFlag))
         setResult(smoothContext->getColorR());
@@ -3741,6 +5670,9 @@ MStatus smoothWeightsContextCmd::doQueryFlags()
     if (argData.isFlagSet(kColorBFlag))
         setResult(smoothContext->getColorB());
 
+    if (argData.isFlagSet(kCountersFlag))
+        setResult(smoothContext->getCounters());
+
     if (argData.isFlagSet(kCurveFlag))
         setResult(smoothContext->getCurve());
 
@@ -3750,6 +5682,9 @@ MStatus smoothWeightsContextCmd::doQueryFlags()
     if (argData.isFlagSet(kDepthStartFlag))
         setResult(smoothContext->getDepthStart());
 
+    if (argData.isFlagSet(kDistanceFlag))
+        setResult(smoothContext->getDistance());
+
     if (argData.isFlagSet(kDrawBrushFlag))
         setResult(smoothContext->getDrawBrush());
 
@@ -3762,6 +5697,12 @@ MStatus smoothWeightsContextCmd::doQueryFlags()
     if (argData.isFlagSet(kExitToolCommandFlag))
         setResult(smoothContext->getExitToolCommand());
 
+    if (argData.isFlagSet(kFloodModeFlag))
+        setResult(smoothContext->getFloodMode());
+
+    if (argData.isFlagSet(kFloodToleranceFlag))
+        setResult(smoothContext->getFloodTolerance());
+
     if (argData.isFlagSet(kFractionOversamplingFlag))
         setResult(smoothContext->getFractionOversampling());
 
@@ -3776,28 +5717,47 @@ MStatus smoothWeightsContextCmd::doQueryFlags()
 
     if (argData.isFlagSet(kMessageFlag))
         setResult(smoothContext->getMessage());
+    if (argData.isFlagSet(kMirrorFlag))
+        setResult(smoothContext->getMirror());
+    if (argData.isFlagSet(kMirrorToleranceFlag))
+        setResult(smoothContext->getMirrorTolerance());
 
     if (argData.isFlagSet(kOversamplingFlag))
         setResult(smoothContext->getOversampling());
 
+    if (argData.isFlagSet(kPrecisionFlag))
+        setResult(smoothContext->getPrecision());
+
     if (argData.isFlagSet(kRangeFlag))
         setResult(smoothContext->getRange());
 
     if (argData.isFlagSet(kSizeFlag))
         setResult(smoothContext->getSize());
 
+    if (argData.isFlagSet(kStatsFlag))
+        setResult(smoothContext->getStats());
+
     if (argData.isFlagSet(kStrengthFlag))
         setResult(smoothContext->getStrength());
 
     if (argData.isFlagSet(kToleranceFlag))
         setResult(smoothContext->getTolerance());
 
+    if (argData.isFlagSet(kTraceFlag))
+        setResult(smoothContext->getTrace());
+
+    if (argData.isFlagSet(kTraceFileFlag))
+        setResult(smoothContext->getTraceFile());
+
     if (argData.isFlagSet(kUndersamplingFlag))
         setResult(smoothContext->getUndersampling());
 
     if (argData.isFlagSet(kVolumeFlag))
         setResult(smoothContext->getVolume());
 
+    if (argData.isFlagSet(kWeightingFlag))
+        setResult(smoothContext->getWeighting());
+
     return MStatus::kSuccess;
 }
 
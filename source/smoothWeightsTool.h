@@ -11,6 +11,10 @@
 #ifndef __smoothWeightsTool__smoothWeightsTool__
 #define __smoothWeightsTool__smoothWeightsTool__
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <tbb/parallel_for.h>
@@ -25,11 +29,15 @@
 #include <maya/MSyntax.h>
 
 #include <maya/M3dView.h>
+#include <maya/MCallbackIdArray.h>
 #include <maya/MCursor.h>
 #include <maya/MDagPath.h>
 #include <maya/MDagPathArray.h>
+#include <maya/MDGMessage.h>
 #include <maya/MEvent.h>
+#include <maya/MFileIO.h>
 #include <maya/MFloatPointArray.h>
+#include <maya/MFnAttribute.h>
 #include <maya/MFnCamera.h>
 #include <maya/MFnMesh.h>
 #include <maya/MFnSingleIndexedComponent.h>
@@ -42,12 +50,29 @@
 #include <maya/MItSelectionList.h>
 #include <maya/MMatrix.h>
 #include <maya/MMeshIntersector.h>
+#include <maya/MModelMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPointArray.h>
+#include <maya/MSceneMessage.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
+#include <maya/MStringArray.h>
 #include <maya/MToolsInfo.h>
 #include <maya/MUIDrawManager.h>
 
+#include "core/diffusionSolver.h"
+#include "core/heatDistance.h"
+#include "core/meshTopology.h"
+#include "core/mirrorMap.h"
+#include "core/multigridSolver.h"
+#include "core/strokeCounters.h"
+#include "core/strokeStats.h"
+#include "core/topologyCache.h"
+#include "core/weightCache.h"
+#include "core/weightFunctions.h"
+#include "core/weightSmoother.h"
+
 // ---------------------------------------------------------------------
 // the tool
 // ---------------------------------------------------------------------
@@ -73,26 +98,34 @@ public:
 
     // setting the attributes
     void setAffectSelected(bool value);
+    void setBindPose(bool value);
     void setColor(MColor color);
     void setCurve(int value);
     void setDepth(int value);
     void setDepthStart(int value);
+    void setDistance(int value);
     void setDrawBrush(bool value);
     void setDrawRange(bool value);
     void setEnterToolCommand(MString value);
     void setExitToolCommand(MString value);
+    void setFloodMode(int value);
+    void setFloodTolerance(double value);
     void setFractionOversampling(bool value);
     void setIgnoreLock(bool value);
     void setKeepShellsTogether(bool value);
     void setLineWidth(int value);
     void setMessage(int value);
+    void setMirror(int value);
+    void setMirrorTolerance(double value);
     void setOversampling(int value);
+    void setPrecision(int value);
     void setRange(double value);
     void setSize(double value);
     void setStrength(double value);
     void setTolerance(double value);
     void setUndersampling(int value);
     void setVolume(bool value);
+    void setWeighting(int value);
 
 public:
 
@@ -107,25 +140,33 @@ public:
 private:
 
     bool affectSelectedVal;
+    bool bindPoseVal;
     MColor colorVal;
     int curveVal;
     int depthVal;
     int depthStartVal;
+    int distanceVal;
     bool drawBrushVal;
     bool drawRangeVal;
     MString enterToolCommandVal;
     MString exitToolCommandVal;
+    int floodModeVal;
+    double floodToleranceVal;
     bool fractionOversamplingVal;
     bool ignoreLockVal;
     bool keepShellsTogetherVal;
     int lineWidthVal;
     int messageVal;
+    int mirrorVal;
+    double mirrorToleranceVal;
     int oversamplingVal;
+    int precisionVal;
     double rangeVal;
     double sizeVal;
     double strengthVal;
     double toleranceVal;
     int undersamplingVal;
+    int weightingVal;
     bool volumeVal;
 
     MIntArray influenceIndices;
@@ -151,6 +192,7 @@ class smoothWeightsContext : public MPxContext
 public:
 
     smoothWeightsContext();
+    ~smoothWeightsContext();
     void toolOnSetup(MEvent &event);
     void toolOffCleanup();
 
@@ -177,10 +219,34 @@ public:
     void doReleaseCommon(MEvent event);
 
     MStatus getMesh();
+    void addDirtyCallbacks();
+    void removeDirtyCallbacks();
     MStatus getSelection(MDagPath &dagPath);
     MIntArray getSelectionVertices();
     MStatus getSkinCluster(MDagPath meshDag, MObject &skinClusterObj);
     MStatus getAllWeights();
+    bool getCachedWeights();
+    void writeWeightCache();
+    MString getWeightCachePath();
+    unsigned long long getSceneKey();
+    void readTopologyCache();
+    void writeTopologyCache();
+    MString getTopologyCachePath();
+    static void afterSaveCallback(void *data);
+    static void meshDirtyCallback(MObject &node, MPlug &plug, void *data);
+    static void skinAttributeCallback(MNodeMessage::AttributeMessage message,
+                                      MPlug &plug,
+                                      MPlug &otherPlug,
+                                      void *data);
+    static void lockAttributeCallback(MNodeMessage::AttributeMessage message,
+                                      MPlug &plug,
+                                      MPlug &otherPlug,
+                                      void *data);
+    static void connectionCallback(MPlug &sourcePlug,
+                                   MPlug &destinationPlug,
+                                   bool made,
+                                   void *data);
+    static void selectionCallback(void *data);
     void getSkinClusterAttributes(MObject skinCluster,
                                   unsigned int &maxInfluences,
                                   bool &maintainMaxInfluences,
@@ -191,39 +257,64 @@ public:
     MStatus getCameraClip(double &nearClip, double &farClip, MMatrix &camMat);
 
     // smooth computation
+    typedef void (smoothWeightsContext::*weightsKernel)(unsigned int,
+                                                        double,
+                                                        int,
+                                                        unsigned int,
+                                                        int,
+                                                        const std::vector<unsigned int> &,
+                                                        smoothBuffer &);
+
     MStatus performSmooth(MEvent event, MIntArray indices, MFloatArray distances);
-    void setCurrentWeight(double value, unsigned int index, bool flood);
+    weightsKernel getWeightsKernel(bool flood);
+    template <bool SinglePrecision>
+    void setCurrentWeight(double value, unsigned int index);
+    template <bool VolumeMode, bool HasLocks, bool MaxInfluences, bool Normalize, bool WriteCurrent, bool SinglePrecision>
     void computeWeights(unsigned int index,
                         double falloff,
                         int oppositeIndex,
                         unsigned int element,
                         int oppositeElement,
-                        MIntArray volumeIndices,
-                        bool flood);
+                        const std::vector<unsigned int> &volumeIndices,
+                        smoothBuffer &buffer);
     bool isLocked(unsigned int index);
     // selection
     MStatus performSelect(MEvent event, MIntArray indices, MFloatArray distances);
     // flood
     void performFlood();
+    MStatus performImplicitFlood();
 
     MObject allVertexComponents(MDagPath meshDag);
-    MIntArray sortIndicesByValues(MIntArray ids, MDoubleArray array);
     void getVerticesInRange(int index,
                             int hitIndex,
                             MIntArray &indices,
                             MFloatArray &values);
-    void getConnectedInRange(MPoint centerPoint,
-                             int index,
-                             std::vector<bool> &visited,
-                             MIntArray &indices,
-                             MFloatArray &values,
-                             int &oppositeIndex);
-    void appendConnectedIndices(int index, MIntArray &indices);
+    void getVerticesInGeodesicRange(int index,
+                                    int hitIndex,
+                                    MIntArray &indices,
+                                    MFloatArray &values);
+    void getVerticesInHeatRange(int index,
+                                int hitIndex,
+                                MIntArray &indices,
+                                MFloatArray &values);
+    int getOppositeIndex(int index);
+    MStatus captureBindPose();
+    bool useBindPose();
+    MPoint getBindPoint(int faceIndex, int triangleIndex, float bary1, float bary2);
+    MPoint getVertexPosition(int index, MSpace::Space space);
+    MPoint getVertexPosition(MItMeshVertex &vtxIter, MSpace::Space space);
+    void updateMirror();
+    bool useMirror();
+    void appendMirrorIndices(MIntArray &indices, MFloatArray &values);
+    bool isMirrored(unsigned int index);
+    void getPointValues(std::vector<double> &values);
+    void getTriangleValues(std::vector<int> &values);
+    void getPolygonValues(std::vector<int> &counts, std::vector<int> &vertices);
+    void updateOperators();
+    void updateSmoothingOperator();
+    void updateTopology();
+    void updateHeatDistance();
     MIntArray getVerticesInVolume();
-    void getVerticesInVolumeRange(int index,
-                                  MIntArray volumeIndices,
-                                  MIntArray &rangeIndices,
-                                  MFloatArray &values);
 
     double getFalloffValue(double value, double strength);
     bool eventIsValid(MEvent event);
@@ -237,53 +328,79 @@ public:
 
     // setting the attributes
     void setAffectSelected(bool value);
+    void setBindPose(bool value);
+    void setCacheDirectory(MString value);
     void setColorR(float value);
     void setColorG(float value);
     void setColorB(float value);
     void setCurve(int value);
     void setDepth(int value);
     void setDepthStart(int value);
+    void setDistance(int value);
     void setDrawBrush(bool value);
     void setDrawRange(bool value);
     void setEnterToolCommand(MString value);
     void setExitToolCommand(MString value);
     void setFlood(double value);
+    void setFloodMode(int value);
+    void setFloodTolerance(double value);
     void setFractionOversampling(bool value);
     void setIgnoreLock(bool value);
     void setKeepShellsTogether(bool value);
     void setLineWidth(int value);
     void setMessage(int value);
+    void setMirror(int value);
+    void setMirrorTolerance(double value);
     void setOversampling(int value);
+    void setPrecision(int value);
     void setRange(double value);
     void setSize(double value);
     void setStrength(double value);
     void setTolerance(double value);
+    void setTrace(bool value);
+    void setTraceFile(MString value);
     void setUndersampling(int value);
+    void setWeighting(int value);
     void setVolume(bool value);
 
+    void writeTrace(MString path);
+
     // getting the attributes
     bool getAffectSelected();
+    bool getBindPose();
+    MString getCacheDirectory();
     float getColorR();
     float getColorG();
     float getColorB();
+    MStringArray getCounters();
     int getCurve();
     int getDepth();
     int getDepthStart();
+    int getDistance();
     bool getDrawBrush();
     bool getDrawRange();
     MString getEnterToolCommand();
     MString getExitToolCommand();
+    int getFloodMode();
+    double getFloodTolerance();
     bool getFractionOversampling();
     bool getIgnoreLock();
     bool getKeepShellsTogether();
     int getLineWidth();
     int getMessage();
+    int getMirror();
+    double getMirrorTolerance();
     int getOversampling();
+    int getPrecision();
     double getRange();
     double getSize();
+    MStringArray getStats();
     double getStrength();
     double getTolerance();
+    bool getTrace();
+    MString getTraceFile();
     int getUndersampling();
+    int getWeighting();
     bool getVolume();
 
 private:
@@ -295,25 +412,35 @@ private:
 
     // the tool settings
     bool affectSelectedVal;
+    bool bindPoseVal;
+    MString cacheDirectoryVal;
     MColor colorVal;
     int curveVal;
     int depthVal;
     int depthStartVal;
+    int distanceVal;
     bool drawBrushVal;
     bool drawRangeVal;
     MString enterToolCommandVal;
     MString exitToolCommandVal;
+    int floodModeVal;
+    double floodToleranceVal;
     bool fractionOversamplingVal;
     bool ignoreLockVal;
     bool keepShellsTogetherVal;
     int lineWidthVal;
     int messageVal;
+    int mirrorVal;
+    double mirrorToleranceVal;
     int oversamplingVal;
+    int precisionVal;
     double rangeVal;
     double sizeVal;
     double strengthVal;
     double toleranceVal;
+    MString traceFileVal;
     int undersamplingVal;
+    int weightingVal;
     bool volumeVal;
 
     // brush settings for adjusting
@@ -329,10 +456,6 @@ private:
                                 // strength.
 
     M3dView view;
-    unsigned int width;
-    unsigned int height;
-    short viewCenterX;
-    short viewCenterY;
 
     // the cursor position
     short screenX;
@@ -344,6 +467,8 @@ private:
                                 // camera.
     MPointArray surfacePoints;  // The cursor positions on the mesh in
                                 // world space.
+    MPointArray centerPoints;   // The cursor positions on the geometry
+                                // the distances are measured on.
     MVector worldVector;        // The view vector from the camera to
                                 // the surface point.
     double pressDistance;       // The closest distance to the mesh on
@@ -358,6 +483,32 @@ private:
                                 // is used for flooding.
 
     MMeshIntersector intersector;
+    MMeshIntersector bindIntersector;   // The intersector for the
+                                        // input geometry.
+    MPointArray bindPoints;     // The world space positions of the
+                                // skin cluster input geometry.
+
+    mirrorMap mirror;           // The mirrored vertex of each vertex.
+    std::vector<unsigned int> mirrorStamps; // The generation with
+                                            // which a vertex has
+                                            // been added to the
+                                            // current dab.
+    unsigned int mirrorGeneration;
+
+    meshTopology topology;      // The cached vertex adjacency and edge
+                                // lengths for the geodesic distance.
+    heatDistance heat;          // The factorized operators for the heat
+                                // method distance.
+    bool heatFailed;            // True, if the operators for the heat
+                                // method couldn't be factorized.
+    meshLaplacian operators;    // The cotangent Laplacian and mass
+                                // matrix of the triangulated mesh.
+    smoothingOperator smoothing;    // The precomputed cotangent weights
+                                    // for the weighted smoothing.
+    weightSmoother smoother;    // The shared smoothing kernel with the
+                                // influence settings of the stroke.
+    multigridSolver multigrid;  // The vertex clusters for the multigrid
+                                // flood.
 
     std::vector<bool> selectedIndices;  // The current vertex selection
                                         // in a non-sparse array
@@ -376,6 +527,7 @@ private:
     MIntArray influenceIndices;
     MDagPathArray inflDagPaths;
     std::vector<bool> influenceLocks;
+    unsigned int lockedCount;
     bool maintainMaxInfluences;
     unsigned int maxInfluences;
     bool normalize;
@@ -383,6 +535,8 @@ private:
     MDoubleArray currentWeights;    // The array holding all weights.
                                     // Unsmoothed and smoothed weights
                                     // are included.
+    std::vector<float> singleWeights;   // The current weights in single
+                                        // precision mode.
     MDoubleArray prevWeights;       // The previous weights for undo.
     MDoubleArray smoothedWeights;   // The array with only the smoothed
                                     // weights.
@@ -395,6 +549,40 @@ private:
     std::vector<bool> computeIndex; // The array storing which index
                                     // should get processed in case of
                                     // boundary indices.
+    unsigned long long topologyHash;    // The connectivity hash of the
+                                        // mesh for the topology cache.
+    bool topologyCached;            // True, if the topology cache
+                                    // matches the adjacency and the
+                                    // index map.
+    unsigned int topologyPairCount; // The number of opposite vertex
+                                    // pairs in the topology cache.
+
+    strokeCounters counters;        // The work counts of the last
+                                    // stroke.
+    strokeStats stats;              // The timings of the brush stages.
+    strokeTrace trace;              // The optional timeline of the
+                                    // strokes.
+
+    MCallbackId saveCallbackId;     // The callback for writing the
+                                    // weight cache after saving.
+
+    // The cached data which needs to be refreshed on the next press.
+    // The dirty callbacks mark the data which has changed.
+    enum dirtyLayer
+    {
+        kDirtyInfluences = 1,
+        kDirtyLocks = 2,
+        kDirtyPoints = 4,
+        kDirtySelection = 8,
+        kDirtyWeights = 16,
+        kDirtyAll = 31
+    };
+    unsigned int dirtyLayers;
+    bool ignoreWeightChanges;       // True while the context sets the
+                                    // weights of the current stroke,
+                                    // which are already part of the
+                                    // current weights.
+    MCallbackIdArray dirtyCallbackIds;
 };
 
 // ---------------------------------------------------------------------
@@ -33,21 +33,26 @@ transferWeightsTool::transferWeightsTool()
     setCommandString("brTransferWeightsCmd");
 
     affectSelectedVal = true;
+    bindPoseVal = false;
     colorVal = MColor(0.0, 0.0, 0.0);
     curveVal = 2;
     depthVal = 1;
     depthStartVal = 1;
     destinationInfluenceVal = -1;
+    distanceVal = 0;
     drawBrushVal = true;
     enterToolCommandVal = "";
     exitToolCommandVal = "";
     keepShellsTogetherVal = true;
     lineWidthVal = 1;
     messageVal = 2;
+    mirrorVal = 0;
+    mirrorToleranceVal = 0.001;
     replaceVal = false;
     reverseVal = false;
     sizeVal = 5.0;
     sourceInfluenceVal = -1;
+    sourceInfluenceListVal = "";
     strengthVal = 0.2;
     toleranceVal = 0.001;
     undersamplingVal = 2;
@@ -82,12 +87,18 @@ bool transferWeightsTool::isUndoable() const
 
 #define kAffectSelectedFlag             "-as"
 #define kAffectSelectedFlagLong         "-affectSelected"
+#define kBindPoseFlag                   "-bp"
+#define kBindPoseFlagLong               "-bindPose"
+#define kCacheDirectoryFlag             "-cd"
+#define kCacheDirectoryFlagLong         "-cacheDirectory"
 #define kColorRFlag                     "-cr"
 #define kColorRFlagLong                 "-colorR"
 #define kColorGFlag                     "-cg"
 #define kColorGFlagLong                 "-colorG"
 #define kColorBFlag                     "-cb"
 #define kColorBFlagLong                 "-colorB"
+#define kCountersFlag                   "-cnt"
+#define kCountersFlagLong               "-counters"
 #define kCurveFlag                      "-c"
 #define kCurveFlagLong                  "-curve"
 #define kDepthFlag                      "-d"
@@ -96,6 +107,8 @@ bool transferWeightsTool::isUndoable() const
 #define kDepthStartFlagLong             "-depthStart"
 #define kDestinationInfluenceFlag       "-di"
 #define kDestinationInfluenceFlagLong   "-destinationInfluence"
+#define kDistanceFlag                   "-dis"
+#define kDistanceFlagLong               "-distance"
 #define kDrawBrushFlag                  "-db"
 #define kDrawBrushFlagLong              "-drawBrush"
 #define kEnterToolCommandFlag           "-etc"
@@ -110,6 +123,10 @@ bool transferWeightsTool::isUndoable() const
 #define kLineWidthFlagLong              "-lineWidth"
 #define kMessageFlag                    "-m"
 #define kMessageFlagLong                "-message"
+#define kMirrorFlag                     "-mir"
+#define kMirrorFlagLong                 "-mirror"
+#define kMirrorToleranceFlag            "-mtl"
+#define kMirrorToleranceFlagLong        "-mirrorTolerance"
 #define kReplaceFlag                    "-rep"
 #define kReplaceFlagLong                "-replace"
 #define kReverseFlag                    "-rev"
@@ -118,14 +135,24 @@ bool transferWeightsTool::isUndoable() const
 #define kSizeFlagLong                   "-size"
 #define kSourceInfluenceFlag            "-si"
 #define kSourceInfluenceFlagLong        "-sourceInfluence"
+#define kSourceInfluenceListFlag        "-sil"
+#define kSourceInfluenceListFlagLong    "-sourceInfluenceList"
+#define kStatsFlag                      "-sts"
+#define kStatsFlagLong                  "-stats"
 #define kStrengthFlag                   "-st"
 #define kStrengthFlagLong               "-strength"
 #define kToleranceFlag                  "-to"
 #define kToleranceFlagLong              "-tolerance"
+#define kTraceFlag                      "-tr"
+#define kTraceFlagLong                  "-trace"
+#define kTraceFileFlag                  "-tf"
+#define kTraceFileFlagLong              "-traceFile"
 #define kUndersamplingFlag              "-us"
 #define kUndersamplingFlagLong          "-undersampling"
 #define kVolumeFlag                     "-v"
 #define kVolumeFlagLong                 "-volume"
+#define kWriteTraceFlag                 "-wt"
+#define kWriteTraceFlagLong             "-writeTrace"
 
 
 MSyntax transferWeightsTool::newSyntax()
@@ -133,6 +160,7 @@ MSyntax transferWeightsTool::newSyntax()
     MSyntax syntax;
 
     syntax.addFlag(kAffectSelectedFlag, kAffectSelectedFlagLong, MSyntax::kBoolean);
+    syntax.addFlag(kBindPoseFlag, kBindPoseFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kColorRFlag, kColorRFlagLong, MSyntax::kDouble);
     syntax.addFlag(kColorGFlag, kColorGFlagLong, MSyntax::kDouble);
     syntax.addFlag(kColorBFlag, kColorBFlagLong, MSyntax::kDouble);
@@ -140,16 +168,20 @@ MSyntax transferWeightsTool::newSyntax()
     syntax.addFlag(kDepthFlag, kDepthFlagLong, MSyntax::kLong);
     syntax.addFlag(kDepthStartFlag, kDepthStartFlagLong, MSyntax::kLong);
     syntax.addFlag(kDestinationInfluenceFlag, kDestinationInfluenceFlagLong, MSyntax::kLong);
+    syntax.addFlag(kDistanceFlag, kDistanceFlagLong, MSyntax::kLong);
     syntax.addFlag(kDrawBrushFlag, kDrawBrushFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kEnterToolCommandFlag, kEnterToolCommandFlagLong, MSyntax::kString);
     syntax.addFlag(kExitToolCommandFlag, kExitToolCommandFlagLong, MSyntax::kString);
     syntax.addFlag(kKeepShellsTogetherFlag, kKeepShellsTogetherFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kLineWidthFlag, kLineWidthFlagLong, MSyntax::kLong);
     syntax.addFlag(kMessageFlag, kMessageFlagLong, MSyntax::kLong);
+    syntax.addFlag(kMirrorFlag, kMirrorFlagLong, MSyntax::kLong);
+    syntax.addFlag(kMirrorToleranceFlag, kMirrorToleranceFlagLong, MSyntax::kDouble);
     syntax.addFlag(kReplaceFlag, kReplaceFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kReverseFlag, kReverseFlagLong, MSyntax::kBoolean);
     syntax.addFlag(kSizeFlag, kSizeFlagLong, MSyntax::kDouble);
     syntax.addFlag(kSourceInfluenceFlag, kSourceInfluenceFlagLong, MSyntax::kLong);
+    syntax.addFlag(kSourceInfluenceListFlag, kSourceInfluenceListFlagLong, MSyntax::kString);
     syntax.addFlag(kStrengthFlag, kStrengthFlagLong, MSyntax::kDouble);
     syntax.addFlag(kToleranceFlag, kToleranceFlagLong, MSyntax::kDouble);
     syntax.addFlag(kUndersamplingFlag, kUndersamplingFlagLong, MSyntax::kLong);
@@ -170,6 +202,11 @@ MStatus transferWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kAffectSelectedFlag, 0, affectSelectedVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kBindPoseFlag))
+    {
+        status = argData.getFlagArgument(kBindPoseFlag, 0, bindPoseVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kColorRFlag))
     {
         double value;
@@ -211,6 +248,11 @@ MStatus transferWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kDestinationInfluenceFlag, 0, destinationInfluenceVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kDistanceFlag))
+    {
+        status = argData.getFlagArgument(kDistanceFlag, 0, distanceVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kDrawBrushFlag))
     {
         status = argData.getFlagArgument(kDrawBrushFlag, 0, drawBrushVal);
@@ -241,6 +283,16 @@ MStatus transferWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kMessageFlag, 0, messageVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kMirrorFlag))
+    {
+        status = argData.getFlagArgument(kMirrorFlag, 0, mirrorVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+    if (argData.isFlagSet(kMirrorToleranceFlag))
+    {
+        status = argData.getFlagArgument(kMirrorToleranceFlag, 0, mirrorToleranceVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kReplaceFlag))
     {
         status = argData.getFlagArgument(kReplaceFlag, 0, replaceVal);
@@ -261,6 +313,11 @@ MStatus transferWeightsTool::parseArgs(const MArgList& args)
         status = argData.getFlagArgument(kSourceInfluenceFlag, 0, sourceInfluenceVal);
         CHECK_MSTATUS_AND_RETURN_IT(status);
     }
+    if (argData.isFlagSet(kSourceInfluenceListFlag))
+    {
+        status = argData.getFlagArgument(kSourceInfluenceListFlag, 0, sourceInfluenceListVal);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     if (argData.isFlagSet(kStrengthFlag))
     {
         status = argData.getFlagArgument(kStrengthFlag, 0, strengthVal);
@@ -398,6 +455,8 @@ MStatus transferWeightsTool::finalize()
     cmd += "-image1 \"brTransferWeights.svg\" -image2 \"vacantCell.png\" -image3 \"vacantCell.png\"";
     cmd += " " + MString(kAffectSelectedFlag) + " ";
     cmd += affectSelectedVal;
+    cmd += " " + MString(kBindPoseFlag) + " ";
+    cmd += bindPoseVal;
     cmd += " " + MString(kColorRFlag) + " ";
     cmd += colorVal.r;
     cmd += " " + MString(kColorGFlag) + " ";
@@ -412,6 +471,8 @@ MStatus transferWeightsTool::finalize()
     cmd += depthStartVal;
     cmd += " " + MString(kDestinationInfluenceFlag) + " ";
     cmd += destinationInfluenceVal;
+    cmd += " " + MString(kDistanceFlag) + " ";
+    cmd += distanceVal;
     cmd += " " + MString(kDrawBrushFlag) + " ";
     cmd += drawBrushVal;
     cmd += " " + MString(kEnterToolCommandFlag) + " ";
@@ -424,6 +485,10 @@ MStatus transferWeightsTool::finalize()
     cmd += lineWidthVal;
     cmd += " " + MString(kMessageFlag) + " ";
     cmd += messageVal;
+    cmd += " " + MString(kMirrorFlag) + " ";
+    cmd += mirrorVal;
+    cmd += " " + MString(kMirrorToleranceFlag) + " ";
+    cmd += mirrorToleranceVal;
     cmd += " " + MString(kReplaceFlag) + " ";
     cmd += replaceVal;
     cmd += " " + MString(kReverseFlag) + " ";
@@ -432,6 +497,8 @@ MStatus transferWeightsTool::finalize()
     cmd += sizeVal;
     cmd += " " + MString(kSourceInfluenceFlag) + " ";
     cmd += sourceInfluenceVal;
+    cmd += " " + MString(kSourceInfluenceListFlag) + " ";
+    cmd += "\"" + sourceInfluenceListVal + "\"";
     cmd += " " + MString(kStrengthFlag) + " ";
     cmd += strengthVal;
     cmd += " " + MString(kToleranceFlag) + " ";
@@ -463,6 +530,12 @@ void transferWeightsTool::setAffectSelected(bool value)
 }
 
 
+void transferWeightsTool::setBindPose(bool value)
+{
+    bindPoseVal = value;
+}
+
+
 void transferWeightsTool::setColor(MColor value)
 {
     colorVal = value;
@@ -493,6 +566,12 @@ void transferWeightsTool::setDestinationInfluence(int value)
 }
 
 
+void transferWeightsTool::setDistance(int value)
+{
+    distanceVal = value;
+}
+
+
 void transferWeightsTool::setDrawBrush(bool value)
 {
     drawBrushVal = value;
@@ -529,6 +608,18 @@ void transferWeightsTool::setMessage(int value)
 }
 
 
+void transferWeightsTool::setMirror(int value)
+{
+    mirrorVal = value;
+}
+
+
+void transferWeightsTool::setMirrorTolerance(double value)
+{
+    mirrorToleranceVal = value;
+}
+
+
 void transferWeightsTool::setReplace(bool value)
 {
     replaceVal = value;
@@ -553,6 +644,12 @@ void transferWeightsTool::setSourceInfluence(int value)
 }
 
 
+void transferWeightsTool::setSourceInfluenceList(MString value)
+{
+    sourceInfluenceListVal = value;
+}
+
+
 void transferWeightsTool::setStrength(double value)
 {
     strengthVal = value;
@@ -645,26 +742,51 @@ transferWeightsContext::transferWeightsContext()
     // These values will be used to reset the tool from the tool
     // properties window.
     affectSelectedVal = true;
+    bindPoseVal = false;
+    cacheDirectoryVal = "";
     colorVal = MColor(0.0, 0.0, 0.0);
     curveVal = 2;
     depthVal = 1;
     depthStartVal = 1;
     destinationInfluenceVal = -1;
+    distanceVal = 0;
     drawBrushVal = true;
     enterToolCommandVal = "";
     exitToolCommandVal = "";
     keepShellsTogetherVal = true;
     lineWidthVal = 1;
     messageVal = 2;
+    mirrorVal = 0;
+    mirrorToleranceVal = 0.001;
     replaceVal = false;
     reverseVal = false;
     sizeVal = 5.0;
     sourceInfluenceVal = -1;
+    sourceInfluenceListVal = "";
     strengthVal = 0.2;
     toleranceVal = 0.001;
+    traceFileVal = "";
     undersamplingVal = 2;
     volumeVal = false;
 
+    // Record the timed stages in the trace while it's enabled.
+    stats.setTrace(&trace);
+
+    // The caches are only used while a cache directory is set.
+    saveCallbackId = 0;
+    topologyHash = 0;
+    topologyCached = false;
+    topologyPairCount = 0;
+
+    // The mirror stamps get initialized with the mirror map.
+    mirrorGeneration = 0;
+
+    // The heat method is only tried once per mesh.
+    heatFailed = false;
+
+    // All data gets read on the first press.
+    dirtyLayers = kDirtyAll;
+
     // True, only if the transfer is performed. False when adjusting
     // the brush settings. It's used to control whether undo/redo needs
     // to get called.
@@ -672,6 +794,15 @@ transferWeightsContext::transferWeightsContext()
 }
 
 
+transferWeightsContext::~transferWeightsContext()
+{
+    removeDirtyCallbacks();
+
+    if (saveCallbackId != 0)
+        MMessage::removeCallback(saveCallbackId);
+}
+
+
 void transferWeightsContext::toolOnSetup(MEvent &)
 {
     setHelpString(helpString);
@@ -680,6 +811,10 @@ void transferWeightsContext::toolOnSetup(MEvent &)
 
     MGlobal::executeCommand(enterToolCommandVal);
 
+    // The statistics only cover the strokes of the current tool
+    // session.
+    stats.clear();
+
     getMesh();
 }
 
@@ -688,6 +823,13 @@ void transferWeightsContext::toolOffCleanup()
 {
     setInViewMessage(false);
 
+    // Store the adjacency and the opposite vertices which have been
+    // found while painting.
+    writeTopologyCache();
+
+    // Nothing tracks the changes while the tool is inactive.
+    removeDirtyCallbacks();
+
     MGlobal::executeCommand(exitToolCommandVal);
 }
 
@@ -804,6 +946,27 @@ MStatus transferWeightsContext::doDrag(MEvent &event,
 
                 drawManager.circle2d(end, lineWidthVal + 3.0, true);
             }
+
+            // Display the current value below the initial adjust
+            // position of the cursor, since the y axis of the screen
+            // points up and the strength line gets drawn upwards.
+            // Drawing the text natively is much faster than a heads-up
+            // message which needs to be evaluated through MEL with
+            // every drag event.
+            MString message = "Brush Size";
+            if (!sizeAdjust)
+                message = "Brush Strength";
+
+            char info[32];
+#ifdef _WIN64
+            sprintf_s(info, "%s: %.2f", message.asChar(), adjustValue);
+#else
+            sprintf(info, "%s: %.2f", message.asChar(), adjustValue);
+#endif
+
+            MPoint textPos(startScreenX, startScreenY - 50);
+            drawManager.setFontSize(MHWRender::MUIDrawManager::kDefaultFontSize);
+            drawManager.text2d(textPos, MString(info), MHWRender::MUIDrawManager::kCenter);
         }
     }
 
@@ -837,6 +1000,10 @@ MStatus transferWeightsContext::doPressCommon(MEvent event)
     if (meshDag.node().isNull())
         return MStatus::kNotFound;
 
+    stats.beginStroke();
+    counters.clear();
+    scopedTimer timer(stats, strokeStats::kPress);
+
     // initialize
     undersamplingSteps = 0;
     performBrush = false;
@@ -844,14 +1011,6 @@ MStatus transferWeightsContext::doPressCommon(MEvent event)
     view = M3dView::active3dView();
     event.getPosition(screenX, screenY);
 
-    // Get the size of the viewport and calculate the center for placing
-    // the value messages when adjusting the brush settings.
-    unsigned int x;
-    unsigned int y;
-    view.viewport(x, y, width, height);
-    viewCenterX = (short)width / 2;
-    viewCenterY = (short)height / 2;
-
     // Store the initial mouse position. These get used when adjusting
     // the brush size and strength values.
     startScreenX = screenX;
@@ -866,13 +1025,42 @@ MStatus transferWeightsContext::doPressCommon(MEvent event)
     // the current lock states of all influences
     // -----------------------------------------------------------------
 
-    influenceLocks = getInfluenceLocks(inflDagPaths);
+    // Only the data which has changed since the last press gets
+    // refreshed.
+    if (dirtyLayers & kDirtyInfluences)
+    {
+        influenceIndices = getInfluenceIndices(skinObj, inflDagPaths);
+
+        unsigned int normalizeValue;
+        getSkinClusterAttributes(skinObj, normalizeValue);
+        normalize = false;
+        if (normalizeValue > 0)
+            normalize = true;
+
+        // Follow the lock states of the new influences. This also
+        // marks the locks and the weights for refreshing.
+        addDirtyCallbacks();
+        dirtyLayers &= ~kDirtyInfluences;
+
+        // The influence mirror map needs to include the new influences.
+        influenceMirror.clear();
+    }
+
+    if (dirtyLayers & kDirtyLocks)
+    {
+        influenceLocks = getInfluenceLocks(inflDagPaths);
+        dirtyLayers &= ~kDirtyLocks;
+    }
 
     // -----------------------------------------------------------------
     // vertex selection
     // -----------------------------------------------------------------
 
-    vtxSelection = getSelectionVertices();
+    if (dirtyLayers & kDirtySelection)
+    {
+        vtxSelection = getSelectionVertices();
+        dirtyLayers &= ~kDirtySelection;
+    }
     unsigned int numSelection = vtxSelection.length();
 
     // Create an array marking which indices are affected. This depends
@@ -884,13 +1072,37 @@ MStatus transferWeightsContext::doPressCommon(MEvent event)
     for (i = 0; i < numSelection; i ++)
         selectedIndices[(unsigned)vtxSelection[i]] = !state;
 
+    // -----------------------------------------------------------------
+    // bind pose
+    // -----------------------------------------------------------------
+
+    // The positions of the input geometry don't change when the rig
+    // gets posed and only need to be captured once for the mesh.
+    if (bindPoseVal && bindPoints.length() != numVertices)
+        captureBindPose();
+
+    // -----------------------------------------------------------------
+    // mirror
+    // -----------------------------------------------------------------
+
+    if (mirrorVal > 0 && mirrorVal < 4)
+        updateMirror();
+
     // -----------------------------------------------------------------
     // closest point on surface
     // -----------------------------------------------------------------
 
+    // The brush range and the volume falloff read the cached adjacency
+    // and positions of the mesh. Make sure these match the current
+    // shape.
+    updateTopology();
+
     // Getting the closest index cannot be performed when in flood mode.
     if (eventIsValid(event))
     {
+        if (distanceVal == 2 && !volumeVal)
+            updateHeatDistance();
+
         // Get the vertex index which is closest to the cursor position.
         // This method also defines the surface point and view vector.
         MIntArray closestIndices;
@@ -952,10 +1164,22 @@ MStatus transferWeightsContext::doPressCommon(MEvent event)
         // undo/redo unreliable. It might be possible with a different
         // approach though.
         else
-            getAllWeights();
+        {
+            // The weights only need to be read again if they have been
+            // changed. Since the transfer doesn't update the current
+            // weights this includes the previous stroke.
+            if ((dirtyLayers & kDirtyWeights) ||
+                currentWeights.length() != numVertices * influenceCount)
+            {
+                getAllWeights();
+                dirtyLayers &= ~kDirtyWeights;
+            }
+            else
+                prevWeights.copy(currentWeights);
+        }
     }
 
-    resetTransferValues();
+    transfer.reset(numVertices);
 
     return status;
 }
@@ -982,8 +1206,12 @@ MStatus transferWeightsContext::doDragCommon(MEvent event)
     // -----------------------------------------------------------------
     if (event.mouseButton() == MEvent::kLeftMouse)
     {
+        traceSpan dabSpan(trace, "dab", "brush");
+
         MIntArray closestIndices;
         MFloatArray closestDistances;
+        counters.add(strokeCounters::kArrays, 2);
+
         if (!getClosestIndex(event, closestIndices, closestDistances))
             return MStatus::kNotFound;
 
@@ -1032,8 +1260,6 @@ MStatus transferWeightsContext::doDragCommon(MEvent event)
 
         // Define the settings for either setting the brush size or the
         // brush strength.
-        MString message = "Brush Size";
-        MString slider = "Size";
         double dragDistance = deltaPos.x;
         double min = 0.0;
         unsigned int max = 1000;
@@ -1046,8 +1272,6 @@ MStatus transferWeightsContext::doDragCommon(MEvent event)
         // Vary the settings if the strength gets adjusted.
         if (!sizeAdjust)
         {
-            message = "Brush Strength";
-            slider = "Strength";
             dragDistance = deltaPos.y;
             max = 1;
             baseValue = strengthVal;
@@ -1070,39 +1294,11 @@ MStatus transferWeightsContext::doDragCommon(MEvent event)
 
         // Store the modified value for drawing and for setting the
         // values when releasing the mouse button.
+        // The value display happens in the viewport 2.0 draw method
+        // and the tool settings slider gets updated once the mouse
+        // button is released. Executing any MEL commands for each drag
+        // event would slow down the adjustment considerably.
         adjustValue = value;
-
-        // -------------------------------------------------------------
-        // value display in the viewport
-        // -------------------------------------------------------------
-        char info[32];
-#ifdef _WIN64
-        sprintf_s(info, "%s: %.2f", message.asChar(), adjustValue);
-#else
-        sprintf(info, "%s: %.2f", message.asChar(), adjustValue);
-#endif
-
-        // Calculate the position for the value display. Since the
-        // heads-up message starts at the center of the viewport an
-        // offset needs to get calculated based on the view size and the
-        // initial adjust position of the cursor.
-        short offsetX = startScreenX - viewCenterX;
-        short offsetY = startScreenY - viewCenterY - 50;
-
-        MString cmd = "headsUpMessage -horizontalOffset ";
-        cmd += offsetX;
-        cmd += " -verticalOffset ";
-        cmd += offsetY;
-        cmd += " -time 0.1 ";
-        cmd += "\"" + MString(info) + "\"";
-        MGlobal::executeCommand(cmd);
-
-        // Also, adjust the slider in the tool settings window if it's
-        // currently open.
-        MString tool("brTransferWeights");
-        MGlobal::executeCommand("if (`columnLayout -exists " + tool + "`) " +
-                                "floatSliderGrp -edit -value " + (MString() + adjustValue) + " " +
-                                tool + slider + ";");
     }
 
     return status;
@@ -1119,15 +1315,29 @@ void transferWeightsContext::doReleaseCommon(MEvent event)
     // stored.
     if (event.mouseButton() == MEvent::kMiddleMouse)
     {
+        MString slider = "Size";
         if (sizeAdjust)
             sizeVal = adjustValue;
         else
+        {
             strengthVal = adjustValue;
+            slider = "Strength";
+        }
+
+        // Adjust the slider in the tool settings window if it's
+        // currently open. This only needs to happen once with the final
+        // value rather than with every drag event.
+        MString tool("brTransferWeights");
+        MGlobal::executeCommand("if (`columnLayout -exists " + tool + "`) " +
+                                "floatSliderGrp -edit -value " + (MString() + adjustValue) + " " +
+                                tool + slider + ";");
     }
 
     // Refresh the view to erase the drawn circle. This might not
     // always be necessary but is just included to complete the process.
+    scopedTimer refreshTimer(stats, strokeStats::kRefresh);
     view.refresh(false, true);
+    refreshTimer.stop();
 
     // If the transfer has been performed send the current values to
     // the tool command along with the necessary data for undo and redo.
@@ -1137,21 +1347,26 @@ void transferWeightsContext::doReleaseCommon(MEvent event)
         cmd = (transferWeightsTool*)newToolCommand();
 
         cmd->setAffectSelected(affectSelectedVal);
+        cmd->setBindPose(bindPoseVal);
         cmd->setColor(colorVal);
         cmd->setCurve(curveVal);
         cmd->setDepth(depthVal);
         cmd->setDepthStart(depthStartVal);
         cmd->setDestinationInfluence(destinationInfluenceVal);
+        cmd->setDistance(distanceVal);
         cmd->setDrawBrush(drawBrushVal);
         cmd->setEnterToolCommand(enterToolCommandVal);
         cmd->setExitToolCommand(exitToolCommandVal);
         cmd->setKeepShellsTogether(keepShellsTogetherVal);
         cmd->setLineWidth(lineWidthVal);
         cmd->setMessage(messageVal);
+        cmd->setMirror(mirrorVal);
+        cmd->setMirrorTolerance(mirrorToleranceVal);
         cmd->setReplace(replaceVal);
         cmd->setReverse(reverseVal);
         cmd->setSize(sizeVal);
         cmd->setSourceInfluence(sourceInfluenceVal);
+        cmd->setSourceInfluenceList(sourceInfluenceListVal);
         cmd->setStrength(strengthVal);
         cmd->setTolerance(toleranceVal);
         cmd->setUndersampling(undersamplingVal);
@@ -1173,6 +1388,11 @@ void transferWeightsContext::doReleaseCommon(MEvent event)
 
         cmd->finalize();
     }
+
+    // Write the trace with all strokes since the tracing has been
+    // enabled.
+    if (trace.isEnabled() && traceFileVal.length())
+        writeTrace(traceFileVal);
 }
 
 
@@ -1188,6 +1408,9 @@ MStatus transferWeightsContext::getMesh()
     meshDag = MDagPath();
     skinObj = MObject();
 
+    // The callbacks belong to the previous mesh.
+    removeDirtyCallbacks();
+
     // Clear the weights arrays. Especially the prevWeights array since
     // this stores the weights for undo. Since the prevWeights are only
     // collected when transferring and not in select mode this would
@@ -1224,6 +1447,24 @@ MStatus transferWeightsContext::getMesh()
     indexMap = MIntArray(numVertices, -1);
     computeIndex = std::vector<bool>(numVertices, true);
 
+    // The topology for the geodesic distance and the heat method
+    // operators get built when they are needed for the first time.
+    topology.clear();
+    heat.clear();
+    heatFailed = false;
+
+    // The positions of the input geometry get captured with the
+    // next press if the distances are measured in bind pose.
+    bindPoints.clear();
+
+    // The mirror maps belong to the previous mesh.
+    mirror.clear();
+    influenceMirror.clear();
+
+    // Meshes with the same connectivity share the adjacency and the
+    // opposite border vertices through the topology cache.
+    readTopologyCache();
+
     // -----------------------------------------------------------------
     // skin cluster
     // -----------------------------------------------------------------
@@ -1259,12 +1500,165 @@ MStatus transferWeightsContext::getMesh()
     // transfer factor
     // -----------------------------------------------------------------
 
-    resetTransferValues();
+    transfer.reset(numVertices);
+
+
+    // -----------------------------------------------------------------
+    // dirty callbacks
+    // -----------------------------------------------------------------
+
+    // Track the changes of the mesh, the skin cluster, the influences
+    // and the selection so that a press only refreshes the data which
+    // has changed. The influences are already up to date.
+    addDirtyCallbacks();
+    dirtyLayers &= ~kDirtyInfluences;
 
     return status;
 }
 
 
+//
+// Description:
+//      Register the callbacks which mark the cached data as dirty when
+//      the mesh, the weights, the influences, the lock states or the
+//      selection change.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::addDirtyCallbacks()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    removeDirtyCallbacks();
+
+    MCallbackId id;
+
+    MObject meshObj = meshDag.node();
+    id = MNodeMessage::addNodeDirtyPlugCallback(meshObj, meshDirtyCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+
+    id = MNodeMessage::addAttributeChangedCallback(skinObj, skinAttributeCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+
+    for (i = 0; i < inflDagPaths.length(); i ++)
+    {
+        MObject influenceObj = inflDagPaths[i].node();
+        id = MNodeMessage::addAttributeChangedCallback(influenceObj, lockAttributeCallback, this, &status);
+        if (status)
+            dirtyCallbackIds.append(id);
+    }
+
+    // Adding or removing influences changes the connections of the
+    // skin cluster.
+    id = MDGMessage::addConnectionCallback(connectionCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+
+    id = MModelMessage::addCallback(MModelMessage::kActiveListModified, selectionCallback, this, &status);
+    if (status)
+        dirtyCallbackIds.append(id);
+}
+
+
+//
+// Description:
+//      Remove all dirty callbacks. Since the changes are not tracked
+//      anymore all cached data is considered dirty.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::removeDirtyCallbacks()
+{
+    if (dirtyCallbackIds.length())
+    {
+        MMessage::removeCallbacks(dirtyCallbackIds);
+        dirtyCallbackIds.clear();
+    }
+
+    dirtyLayers = kDirtyAll;
+}
+
+
+void transferWeightsContext::meshDirtyCallback(MObject &, MPlug &, void *data)
+{
+    transferWeightsContext *context = static_cast<transferWeightsContext*>(data);
+    if (!context->useBindPose())
+        context->dirtyLayers |= kDirtyPoints;
+}
+
+
+void transferWeightsContext::skinAttributeCallback(MNodeMessage::AttributeMessage message,
+                                                        MPlug &plug,
+                                                        MPlug &,
+                                                        void *data)
+{
+    transferWeightsContext *context = static_cast<transferWeightsContext*>(data);
+
+    if (!(message & MNodeMessage::kAttributeSet))
+        return;
+
+    MFnAttribute attrFn(plug.attribute());
+    MString name = attrFn.name();
+    if (name == "weightList" || name == "weights")
+        context->dirtyLayers |= kDirtyWeights;
+    else if (name == "maxInfluences" ||
+             name == "maintainMaxInfluences" ||
+             name == "normalizeWeights")
+        context->dirtyLayers |= kDirtyInfluences;
+}
+
+
+void transferWeightsContext::lockAttributeCallback(MNodeMessage::AttributeMessage message,
+                                                        MPlug &plug,
+                                                        MPlug &,
+                                                        void *data)
+{
+    transferWeightsContext *context = static_cast<transferWeightsContext*>(data);
+
+    if (!(message & MNodeMessage::kAttributeSet))
+        return;
+
+    MFnAttribute attrFn(plug.attribute());
+    if (attrFn.name() == "lockInfluenceWeights")
+        context->dirtyLayers |= kDirtyLocks;
+}
+
+
+void transferWeightsContext::connectionCallback(MPlug &,
+                                                     MPlug &destinationPlug,
+                                                     bool,
+                                                     void *data)
+{
+    transferWeightsContext *context = static_cast<transferWeightsContext*>(data);
+
+    if (context->skinObj.isNull() || destinationPlug.node() != context->skinObj)
+        return;
+
+    MFnAttribute attrFn(destinationPlug.attribute());
+    if (attrFn.name() == "matrix")
+        context->dirtyLayers |= kDirtyInfluences;
+}
+
+
+void transferWeightsContext::selectionCallback(void *data)
+{
+    transferWeightsContext *context = static_cast<transferWeightsContext*>(data);
+    context->dirtyLayers |= kDirtySelection;
+}
+
+
 //
 // Description:
 //      Get the dagPath of the currently selected object's shape node.
@@ -1468,10 +1862,16 @@ MStatus transferWeightsContext::getAllWeights()
 {
     MStatus status = MStatus::kSuccess;
 
-    MFnSkinCluster skinFn(skinObj, &status);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-    skinFn.getWeights(meshDag, allVtxCompObj, currentWeights, influenceCount);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
+    // Reading the weights from the skin cluster is the most expensive
+    // part of the first stroke on a large mesh. The cached weights are
+    // used instead while the scene is unchanged since it was saved.
+    if (!getCachedWeights())
+    {
+        MFnSkinCluster skinFn(skinObj, &status);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        skinFn.getWeights(meshDag, allVtxCompObj, currentWeights, influenceCount);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
     // Copy the current weights for undo.
     prevWeights.copy(currentWeights);
 
@@ -1481,68 +1881,387 @@ MStatus transferWeightsContext::getAllWeights()
 
 //
 // Description:
-//      Get the influence attributes from the given skin cluster object.
+//      Read the weights of all vertices from the weight cache. The
+//      cache is only used if it belongs to the current skin cluster
+//      and influences and if the scene is unchanged since it was saved
+//      together with the cache.
 //
 // Input Arguments:
-//      skinCluster             The MObject of the skin cluster node.
-//      normalize               True, if the weights are normalized.
+//      None
 //
 // Return Value:
-//      None
+//      bool                True, if the weights have been read from the
+//                          cache.
 //
-void transferWeightsContext::getSkinClusterAttributes(MObject skinCluster, unsigned int &normalize)
+bool transferWeightsContext::getCachedWeights()
 {
-    // Get the settings from the skin cluster node.
-    MFnDependencyNode skinMFn(skinCluster);
+    unsigned int i;
 
-    MPlug normalizePlug = skinMFn.findPlug("normalizeWeights", false);
-    normalize = (unsigned)normalizePlug.asInt();
+    if (!cacheDirectoryVal.length())
+        return false;
+
+    // Any change after opening or saving the scene, including the
+    // strokes of the tool, can affect the weights.
+    int modified = 1;
+    MGlobal::executeCommand("file -query -modified", modified);
+    if (modified)
+        return false;
+
+    unsigned long long key = getSceneKey();
+    if (key == 0)
+        return false;
+
+    weightCache cache;
+    if (!cache.open(getWeightCachePath().asChar()))
+        return false;
+
+    MFnDependencyNode skinMFn(skinObj);
+    if (cache.key() != key ||
+        cache.name() != skinMFn.name().asChar() ||
+        cache.vertexCount() != numVertices ||
+        cache.influenceCount() != inflDagPaths.length())
+        return false;
+
+    for (i = 0; i < inflDagPaths.length(); i ++)
+    {
+        if (cache.influenceName(i) != inflDagPaths[i].partialPathName().asChar())
+            return false;
+    }
+
+    std::vector<double> weights((size_t)numVertices * inflDagPaths.length());
+    if (!cache.expand(weights.data()))
+        return false;
+
+    currentWeights = MDoubleArray(weights.data(), (unsigned)weights.size());
+    influenceCount = inflDagPaths.length();
+
+    return true;
 }
 
 
 //
 // Description:
-//      Return the influence indices of all influences of the given
-//      skin cluster node.
+//      Write the weights of the current skin cluster to the weight
+//      cache. The weights are read from the skin cluster because the
+//      current weights of the tool are only updated when painting.
 //
 // Input Arguments:
-//      skinCluster         The MObject of the skin cluster node.
-//      dagPaths            The dagPath array of all influences.
+//      None
 //
 // Return Value:
-//      int array           The array of all influence indices.
+//      None
 //
-MIntArray transferWeightsContext::getInfluenceIndices(MObject skinCluster, MDagPathArray &dagPaths)
+void transferWeightsContext::writeWeightCache()
 {
     unsigned int i;
 
-    MFnSkinCluster skinFn(skinCluster);
+    MStatus status = MStatus::kSuccess;
 
-    MIntArray influenceIndices;
+    if (!cacheDirectoryVal.length() || !MObjectHandle(skinObj).isValid() || !meshDag.isValid())
+        return;
+
+    unsigned long long key = getSceneKey();
+    if (key == 0)
+        return;
+
+    MFnSkinCluster skinFn(skinObj, &status);
+    if (!status)
+        return;
+
+    MDoubleArray weights;
+    unsigned int count = 0;
+    status = skinFn.getWeights(meshDag, allVertexComponents(meshDag), weights, count);
+    if (!status || count == 0)
+        return;
+
+    MDagPathArray dagPaths;
     skinFn.influenceObjects(dagPaths);
-    for (i = 0; i < dagPaths.length(); i ++)
-        influenceIndices.append((int)i);
+    if (dagPaths.length() != count)
+        return;
 
-    return influenceIndices;
+    std::vector<std::string> names(count);
+    for (i = 0; i < count; i ++)
+        names[i] = dagPaths[i].partialPathName().asChar();
+
+    std::vector<double> values(weights.length());
+    weights.get(values.data());
+
+    MString path = getWeightCachePath();
+    if (!weightCache::write(path.asChar(),
+                            skinFn.name().asChar(),
+                            key,
+                            names,
+                            values.data(),
+                            weights.length() / count))
+        MGlobal::displayWarning("The weight cache could not be written to " + path + ".");
 }
 
 
 //
 // Description:
-//      Return the influence indices of all influences of the given
-//      skin cluster node.
+//      Return the file path of the weight cache for the current skin
+//      cluster. Namespaces are part of the file name.
 //
 // Input Arguments:
-//      dagPaths            The dagPath array of all influences.
+//      None
 //
 // Return Value:
-//      bool array          The array of all influence lock states.
+//      MString             The path of the cache file.
 //
-std::vector<bool> transferWeightsContext::getInfluenceLocks(MDagPathArray dagPaths)
+MString transferWeightsContext::getWeightCachePath()
 {
-    unsigned int i;
+    MFnDependencyNode skinMFn(skinObj);
+    std::string name = skinMFn.name().asChar();
+    std::replace(name.begin(), name.end(), ':', '_');
 
-    unsigned int numInfluences = dagPaths.length();
+    return cacheDirectoryVal + "/" + MString(name.c_str()) + ".brw";
+}
+
+
+//
+// Description:
+//      Return the key which identifies the saved state of the scene.
+//      The weights of a referenced skin cluster also depend on the
+//      state of the referenced file.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      unsigned long long  The key or 0, if the scene isn't saved.
+//
+unsigned long long transferWeightsContext::getSceneKey()
+{
+    unsigned long long key = weightCache::fileStamp(MFileIO::currentFile().asChar(), 0);
+    if (key == 0)
+        return 0;
+
+    MFnDependencyNode skinMFn(skinObj);
+    if (skinMFn.isFromReferencedFile())
+    {
+        MString referenceFile;
+        MGlobal::executeCommand("referenceQuery -filename -withoutCopyNumber " + skinMFn.name(),
+                                referenceFile);
+        key = weightCache::fileStamp(referenceFile.asChar(), key);
+    }
+
+    return key;
+}
+
+
+//
+// Description:
+//      Read the adjacency, the border flags and the opposite border
+//      vertices from the topology cache if the cache matches the
+//      connectivity of the mesh. The opposite vertices are only used
+//      if they have been found with the current tolerance.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::readTopologyCache()
+{
+    unsigned int i;
+
+    topologyHash = 0;
+    topologyCached = false;
+    topologyPairCount = 0;
+
+    if (!cacheDirectoryVal.length())
+        return;
+
+    std::vector<int> counts;
+    std::vector<int> vertices;
+    getPolygonValues(counts, vertices);
+    topologyHash = topologyCache::connectivityHash(numVertices, counts, vertices);
+
+    double tolerance;
+    std::vector<int> pairs;
+    if (!topologyCache::read(getTopologyCachePath().asChar(),
+                             topologyHash,
+                             numVertices,
+                             topology,
+                             tolerance,
+                             pairs))
+        return;
+
+    // The opposite vertices depend on the tolerance. They get replaced
+    // with the pairs of the current tolerance when writing the cache.
+    if (tolerance != toleranceVal)
+        return;
+
+    for (i = 0; i < pairs.size(); i += 2)
+    {
+        indexMap[(unsigned)pairs[i]] = pairs[i + 1];
+        indexMap[(unsigned)pairs[i + 1]] = pairs[i];
+        computeIndex[(unsigned)pairs[i + 1]] = false;
+        computeIndex[(unsigned)pairs[i]] = true;
+    }
+    topologyPairCount = (unsigned)pairs.size() / 2;
+    topologyCached = true;
+}
+
+
+//
+// Description:
+//      Write the adjacency, the border flags and the opposite border
+//      vertices to the topology cache. The adjacency gets built if it
+//      doesn't exist yet so that the next activation doesn't need to
+//      query the mesh for the border vertices. Nothing is written if
+//      the cache is up to date.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::writeTopologyCache()
+{
+    unsigned int i;
+
+    if (!cacheDirectoryVal.length() || !meshDag.isValid() || numVertices == 0)
+        return;
+
+    // Skip the mesh if its topology has changed while the tool was
+    // active.
+    if ((unsigned)meshFn.numVertices() != numVertices ||
+        indexMap.length() != numVertices)
+        return;
+
+    std::vector<int> pairs;
+    for (i = 0; i < numVertices; i ++)
+    {
+        if (indexMap[i] > -1 && computeIndex[i])
+        {
+            pairs.push_back((int)i);
+            pairs.push_back(indexMap[i]);
+        }
+    }
+
+    if (topologyHash == 0 || topology.isEmpty())
+    {
+        std::vector<int> counts;
+        std::vector<int> vertices;
+        getPolygonValues(counts, vertices);
+
+        topologyHash = topologyCache::connectivityHash(numVertices, counts, vertices);
+        if (topology.isEmpty())
+            topology.create(numVertices, counts, vertices);
+        topologyCached = false;
+    }
+
+    // The cache only needs to be written if new pairs have been found
+    // since reading it.
+    if (topologyCached && topologyPairCount == pairs.size() / 2)
+        return;
+
+    MString path = getTopologyCachePath();
+    if (topologyCache::write(path.asChar(), topologyHash, topology, toleranceVal, pairs))
+    {
+        topologyCached = true;
+        topologyPairCount = (unsigned)pairs.size() / 2;
+    }
+    else
+        MGlobal::displayWarning("The topology cache could not be written to " + path + ".");
+}
+
+
+//
+// Description:
+//      Return the file path of the topology cache for the current
+//      mesh, which is named after the connectivity hash.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MString             The path of the cache file.
+//
+MString transferWeightsContext::getTopologyCachePath()
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", topologyHash);
+
+    return cacheDirectoryVal + "/" + MString(name) + ".brt";
+}
+
+
+void transferWeightsContext::afterSaveCallback(void *data)
+{
+    transferWeightsContext *context = static_cast<transferWeightsContext*>(data);
+    context->writeWeightCache();
+    context->writeTopologyCache();
+}
+
+
+//
+// Description:
+//      Get the influence attributes from the given skin cluster object.
+//
+// Input Arguments:
+//      skinCluster             The MObject of the skin cluster node.
+//      normalize               True, if the weights are normalized.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getSkinClusterAttributes(MObject skinCluster, unsigned int &normalize)
+{
+    // Get the settings from the skin cluster node.
+    MFnDependencyNode skinMFn(skinCluster);
+
+    MPlug normalizePlug = skinMFn.findPlug("normalizeWeights", false);
+    normalize = (unsigned)normalizePlug.asInt();
+}
+
+
+//
+// Description:
+//      Return the influence indices of all influences of the given
+//      skin cluster node.
+//
+// Input Arguments:
+//      skinCluster         The MObject of the skin cluster node.
+//      dagPaths            The dagPath array of all influences.
+//
+// Return Value:
+//      int array           The array of all influence indices.
+//
+MIntArray transferWeightsContext::getInfluenceIndices(MObject skinCluster, MDagPathArray &dagPaths)
+{
+    unsigned int i;
+
+    MFnSkinCluster skinFn(skinCluster);
+
+    MIntArray influenceIndices;
+    skinFn.influenceObjects(dagPaths);
+    for (i = 0; i < dagPaths.length(); i ++)
+        influenceIndices.append((int)i);
+
+    return influenceIndices;
+}
+
+
+//
+// Description:
+//      Return the influence indices of all influences of the given
+//      skin cluster node.
+//
+// Input Arguments:
+//      dagPaths            The dagPath array of all influences.
+//
+// Return Value:
+//      bool array          The array of all influence lock states.
+//
+std::vector<bool> transferWeightsContext::getInfluenceLocks(MDagPathArray dagPaths)
+{
+    unsigned int i;
+
+    unsigned int numInfluences = dagPaths.length();
 
     std::vector<bool> locks(numInfluences, false);
 
@@ -1579,6 +2298,8 @@ std::vector<bool> transferWeightsContext::getInfluenceLocks(MDagPathArray dagPat
 //
 bool transferWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, MFloatArray &distances)
 {
+    scopedTimer timer(stats, strokeStats::kClosestIndex);
+
     unsigned int i, j;
 
     MPoint worldPoint;
@@ -1604,6 +2325,9 @@ bool transferWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, M
     MFloatPointArray hitPoints;
     MFloatArray hitRayParams;
     MIntArray hitFaces;
+    MIntArray hitTriangles;
+    MFloatArray hitBary1;
+    MFloatArray hitBary2;
 
     bool foundIntersect = meshFn.allIntersections(worldPoint,
                                                   worldVector,
@@ -1618,15 +2342,16 @@ bool transferWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, M
                                                   hitPoints,
                                                   &hitRayParams,
                                                   &hitFaces,
-                                                  NULL,
-                                                  NULL,
-                                                  NULL);
+                                                  &hitTriangles,
+                                                  &hitBary1,
+                                                  &hitBary2);
 
     if (!foundIntersect)
         return false;
 
     MItMeshPolygon polyIter(meshFn.object());
     surfacePoints.clear();
+    centerPoints.clear();
 
     // Make sure that the depth value does not go below 0.
     if (depthVal < 1)
@@ -1661,6 +2386,13 @@ bool transferWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, M
     {
         surfacePoints.append(hitPoints[i]);
 
+        // The distances are measured from the same surface position
+        // on the input geometry when using the bind pose.
+        MPoint centerPoint = hitPoints[i];
+        if (useBindPose())
+            centerPoint = getBindPoint(hitFaces[i], hitTriangles[i], hitBary1[i], hitBary2[i]);
+        centerPoints.append(centerPoint);
+
         // If an intersection has been found go through the vertices of
         // the intersected polygon and find the closest vertex.
 
@@ -1674,14 +2406,8 @@ bool transferWeightsContext::getClosestIndex(MEvent event, MIntArray &indices, M
 
         for (j = 0; j < vertices.length(); j ++)
         {
-            MPoint position;
-            meshFn.getPoint(vertices[j], position, MSpace::kWorld);
-
-            // Convert the vertex position point because the hit points
-            // are float points.
-            MFloatPoint posPoint;
-            posPoint.setCast(position);
-            float delta = (float)MVector(posPoint - hitPoints[i]).length();
+            MPoint position = getVertexPosition(vertices[j], MSpace::kWorld);
+            float delta = (float)position.distanceTo(centerPoint);
             // Find which index is closest and store it along with the
             // distance.
             if (j == 0 || closestDistance > delta)
@@ -1737,23 +2463,6 @@ MStatus transferWeightsContext::getCameraClip(double &nearClip,
 }
 
 
-//
-// Description:
-//      Reset the current transfer values when the influence pair
-//      changes.
-//
-// Input Arguments:
-//      None
-//
-// Return Value:
-//      None
-//
-void transferWeightsContext::resetTransferValues()
-{
-    transferValues = MDoubleArray(numVertices, 0.0);
-}
-
-
 //
 // Description:
 //      Go through the all vertices which are closest to the cursor,
@@ -1789,6 +2498,24 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
     MFnSingleIndexedComponent transferCompFn(transferCompObj);
 
     MItMeshVertex vtxIter(meshDag);
+    counters.add(strokeCounters::kIterators);
+
+    // Collect the influences of the transfer once so that the kernel
+    // doesn't need to check the indices and locks for each vertex.
+    std::vector<unsigned int> sources;
+    std::vector<unsigned int> destinations;
+    std::vector<unsigned int> mirrorSources;
+    std::vector<unsigned int> mirrorDestinations;
+    getTransferInfluences(false, sources, destinations);
+    if (useMirror())
+        getTransferInfluences(true, mirrorSources, mirrorDestinations);
+    transfer.create(influenceCount, sources, destinations, mirrorSources, mirrorDestinations);
+
+    // The influences which get written by the sparse transfer.
+    const std::vector<unsigned int> &columns = transfer.columns();
+    MIntArray transferColumns;
+    for (i = 0; i < columns.size(); i ++)
+        transferColumns.append((int)columns[i]);
 
     for (i = 0; i < indices.length(); i ++)
     {
@@ -1804,6 +2531,8 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
         // In paint mode, get the indices within the brush radius.
         if (!flood)
         {
+            scopedTimer rangeTimer(stats, strokeStats::kRange);
+
             if (!volumeVal)
             {
                 // Add the closest index and it's distance. If the brush
@@ -1830,6 +2559,11 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
             values = MFloatArray(vtxSelection.length(), 1.0f);
         }
 
+        // Add the vertices on the other side of the mirror plane so
+        // that they get transferred with the same weights commit.
+        if (useMirror())
+            appendMirrorIndices(rangeIndices, values);
+
         // -------------------------------------------------------------
         // Compare the brush vertices with the current selection and
         // order the falloff values.
@@ -1848,6 +2582,15 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
         MFloatArray orderedValues(numVertices, -1);
         MIntArray filteredIndices;
 
+        // True, if the dab contains a vertex of a shell boundary pair.
+        bool boundaryPairs = false;
+
+        // The range, value, ordered value and filtered index arrays of
+        // the dab.
+        counters.add(strokeCounters::kArrays, 4);
+
+        scopedTimer seamsTimer(stats, strokeStats::kSeams);
+
         // Set the value for each range index.
         for (j = 0; j < rangeIndices.length(); j ++)
         {
@@ -1904,10 +2647,12 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
                         MIntArray edges;
                         vtxIter.getConnectedEdges(edges);
 
+                        counters.add(strokeCounters::kArrays, 2);
+
                         int oppositeIndex;
                         // In case it's a boundary vertex get the
                         // opposite vertex.
-                        if (oppositeBoundaryIndex(vtxIter.position(), faces, edges, oppositeIndex))
+                        if (oppositeBoundaryIndex(getVertexPosition(vtxIter, MSpace::kObject), faces, edges, oppositeIndex))
                         {
                             // If the borders of the shells are out of
                             // the tolerance range the opposite index
@@ -1939,10 +2684,15 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
                         filteredIndices.append(indexMap[(unsigned)rangeIndex]);
                     }
                 }
+
+                if (indexMap[(unsigned)rangeIndex] != -1)
+                    boundaryPairs = true;
             }
         }
         rangeIndices.copy(filteredIndices);
 
+        seamsTimer.stop();
+
         // -------------------------------------------------------------
         // weights component object
         // -------------------------------------------------------------
@@ -1964,18 +2714,42 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
         // The weights of all vertices already have been stored during
         // the press event along with the weights for undo.
 
+        // The transfer only changes the weights of the source and
+        // destination influences. Therefore only these columns need to
+        // be written, unless the dab contains shell boundary pairs,
+        // which get the complete weights of their opposite vertex.
+        bool sparse = !boundaryPairs;
+        unsigned int columnCount = influenceCount;
+        if (sparse)
+            columnCount = transferColumns.length();
+
         // Create a new weights array to hold the transferred weights.
         // The length of the array is the number of vertices within the
-        // brush radius * the number of influences.
-        transferredWeights = MDoubleArray(rangeCount * influenceCount, 0.0);
+        // brush radius * the number of written influences.
+        transferredWeights = MDoubleArray(rangeCount * columnCount, 0.0);
+        counters.add(strokeCounters::kArrays);
 
         // -------------------------------------------------------------
         // transfer the weights in a multi-threaded loop
         // -------------------------------------------------------------
 
+        // Select the transfer kernel for the current settings.
+        transferKernel kernel = getTransferKernel(sparse);
+
+        scopedTimer computeTimer(stats, strokeStats::kCompute);
+
         tbb::parallel_for(tbb::blocked_range<unsigned int>(0, rangeCount),
                           [&](tbb::blocked_range<unsigned int> r)
         {
+            traceSpan span(trace, "transferRange", "worker");
+
+            // The steps of the search for the opposite elements.
+            unsigned long long scans = 0;
+
+            // The transferred weights of a vertex, which are reused for
+            // all vertices of the task.
+            std::vector<double> buffer;
+
             for (unsigned int k = r.begin(); k < r.end(); k ++)
             {
                 unsigned int rangeIndex = (unsigned)rangeIndices[k];
@@ -2000,6 +2774,7 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
                         // source boundary index.
                         for (unsigned l = 0; l < rangeCount; l ++)
                         {
+                            scans ++;
                             if ((int)rangeIndices[l] == oppositeIndex)
                             {
                                 oppositeElement = (int)l;
@@ -2008,21 +2783,41 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
                         }
                     }
 
-                    computeTransfer(rangeIndex,
+                    (this->*kernel)(rangeIndex,
                                     orderedValues[rangeIndex],
                                     oppositeIndex,
                                     k,
                                     oppositeElement,
-                                    rangeIndices,
-                                    flood);
+                                    buffer);
                 }
             }
+
+            counters.add(strokeCounters::kSeamScans, scans);
         });
 
-        // Set the new weights.
-        skinFn.setWeights(meshDag, vtxComponents, influenceIndices, transferredWeights, normalize);
+        computeTimer.stop();
+
+        // Set the new weights. The sparse columns keep the sum of each
+        // row and don't need to get normalized.
+        scopedTimer setWeightsTimer(stats, strokeStats::kSetWeights);
+        if (sparse)
+        {
+            if (columnCount)
+            {
+                counters.add(strokeCounters::kSetWeightsCalls);
+                counters.add(strokeCounters::kSetWeightsRows, rangeCount);
+                skinFn.setWeights(meshDag, vtxComponents, transferColumns, transferredWeights, false);
+            }
+        }
+        else
+        {
+            counters.add(strokeCounters::kSetWeightsCalls);
+            counters.add(strokeCounters::kSetWeightsRows, rangeCount);
+            skinFn.setWeights(meshDag, vtxComponents, influenceIndices, transferredWeights, normalize);
+        }
     }
 
+    scopedTimer refreshTimer(stats, strokeStats::kRefresh);
     view.refresh(true);
 
     return status;
@@ -2031,8 +2826,10 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
 
 //
 // Description:
-//      Calculate an interpolated weight value from the current weight
-//      of the given index and the weights of the connected vertices.
+//      Transfer the weights of the given index by the accumulated
+//      transfer multiplier of the vertex. The transfer is done by the
+//      shared kernel of the core library. The context only computes the
+//      brush falloff and writes the result to the transferred weights.
 //
 // Input Arguments:
 //      index               The vertex index.
@@ -2043,35 +2840,47 @@ MStatus transferWeightsContext::performTransfer(MEvent event,
 //                          This is needed for setting the related
 //                          weights.
 //      oppositeElement     The element index of the opposite index.
-//      volumeIndices       The complete list of indices within the
-//                          brush radius. These are needed for the
-//                          volume-based transfer.
-//      flood               True, if a flood transfer is performed.
+//      values              The buffer for the transferred weights of
+//                          the vertex.
+//
+// Template Arguments:
+//      VolumeMode          True, if the transfer is volume-based.
+//      Normalize           True, if the weights get normalized.
+//      Sparse              True, if only the columns of the transfer
+//                          influences get written.
 //
 // Return Value:
 //      None
 //
+template <bool VolumeMode, bool Normalize, bool Sparse>
 void transferWeightsContext::computeTransfer(unsigned int index,
                                              double scale,
                                              int oppositeIndex,
                                              unsigned int element,
                                              int oppositeElement,
-                                             MIntArray volumeIndices,
-                                             bool flood)
+                                             std::vector<double> &values)
 {
-    unsigned int i, j, m, n;
+    unsigned int i, j;
 
-    if (volumeVal)
+    if (VolumeMode)
     {
-        MItMeshVertex vtxIter(meshDag);
-        int prevIndex;
-
         // Create the scale value for the brush falloff based on the
         // distance of the current vertex to the surface point at the
         // cursor position.
-        vtxIter.setIndex((int)index, prevIndex);
-        MPoint pnt = vtxIter.position(MSpace::kWorld);
-        double delta = MVector(pnt - surfacePoints[0]).length();
+        //
+        // A mirrored vertex gets measured from its partner vertex on
+        // the brush side of the mirror plane. Both positions are from
+        // the same point set the mirror map has been built from, so
+        // that this also works with the bind pose or if the mesh isn't
+        // centered at the origin.
+        unsigned int measureIndex = index;
+        if (isMirrored(index) && mirror.mirrorIndex(index) > -1)
+            measureIndex = (unsigned)mirror.mirrorIndex(index);
+
+        const double *point = topology.point(measureIndex);
+        MPoint pnt(point[0], point[1], point[2]);
+
+        double delta = MVector(pnt - centerPoints[0]).length();
         scale = 1 - (delta / sizeVal);
     }
 
@@ -2079,97 +2888,20 @@ void transferWeightsContext::computeTransfer(unsigned int index,
     // The strength value is multiplied by itself to soften the value.
     // Otherwise even small strength values would have a fast transfer
     // effect.
-    scale = getFalloffValue(scale, strengthVal * strengthVal) + transferValues[index];
-
-    // Limit the scale value so that normalization doesn't break.
-    if (scale > 1.0)
-        scale = 1.0;
-
-    // Save the current transfer multiplier.
-    transferValues[index] = scale;
-
-    // Define which index is the source and which the destination index
-    // based on the state of the reverse switch.
-    int sourceIndex = sourceInfluenceVal;
-    int destinationIndex = destinationInfluenceVal;
-    if (reverseVal)
-    {
-        sourceIndex = destinationInfluenceVal;
-        destinationIndex = sourceInfluenceVal;
-    }
-
-    // Check if source and destination influences are unlocked.
-    // Also check if the indices are valid by having an index which is
-    // within the range of the number of influences.
-    bool unlocked = true;
-    if (sourceIndex == -1 ||
-        destinationIndex == -1 ||
-        sourceIndex >= (int)influenceCount ||
-        destinationIndex >= (int)influenceCount ||
-        influenceLocks[(unsigned)sourceIndex] || influenceLocks[(unsigned)destinationIndex])
-    {
-        unlocked = false;
-    }
+    // The transfer multiplier of the vertex is accumulated during the
+    // stroke.
+    scale = transfer.accumulate(index, getFalloffValue(scale, strengthVal * strengthVal));
 
     // -----------------------------------------------------------------
     // transfer the weights
     // -----------------------------------------------------------------
 
-    double weight = 0.0;
-
-    // Create the indices based on the influence count.
-    unsigned int k = influenceCount * element + (unsigned)sourceIndex;
-    unsigned int l = influenceCount * element + (unsigned)destinationIndex;
-    unsigned int v = influenceCount * index + (unsigned)sourceIndex;
-    unsigned int w = influenceCount * index + (unsigned)destinationIndex;
-
-    weight = currentWeights[w];
-
-    if (currentWeights[v] > 0.0 && unlocked)
-    {
-        double weightScale = scale;
-
-        weight += currentWeights[v] * weightScale;
-
-        // Set the destination influence weight.
-        transferredWeights.set(weight, l);
-        // Set the source influence weight.
-        transferredWeights.set(currentWeights[v] * (1 - weightScale), k);
-
-        // -------------------------------------------------------------
-        // normalize
-        // -------------------------------------------------------------
-
-        if (normalize)
-        {
-            double maxWeight = 0.0;
-            for (i = 0; i < influenceCount; i ++)
-            {
-                j = influenceCount * element + i;
-                maxWeight += transferredWeights[j];
-            }
+    // The mirrored vertices transfer between the mirrored influences.
+    transfer.transferVertex<Normalize, Sparse>(currentWeights, index, scale, isMirrored(index), values);
 
-            for (i = 0; i < influenceCount; i ++)
-            {
-                j = influenceCount * element + i;
-                double value = transferredWeights[j] / maxWeight;
-                transferredWeights.set(value, j);
-            }
-        }
-    }
-    // If there is no source influence weight copy all influence weights
-    // from the current weights array to the resulting
-    // transferredWeights array.
-    else
-    {
-        for (i = 0; i < influenceCount; i ++)
-        {
-            m = influenceCount * index + i;
-            double value = currentWeights[m];
-            n = influenceCount * element + i;
-            transferredWeights.set(value, n);
-        }
-    }
+    unsigned int columnCount = (unsigned)values.size();
+    for (i = 0; i < columnCount; i ++)
+        transferredWeights.set(values[i], columnCount * element + i);
 
     // -------------------------------------------------------------
     // matching the values of the opposite boundary vertex
@@ -2177,15 +2909,14 @@ void transferWeightsContext::computeTransfer(unsigned int index,
 
     // If an opposite vertex exists in case of a boundary vertex
     // apply the same final weights to the opposite vertex as well.
-    if (oppositeIndex > -1)
+    // The sparse transfer is only used for dabs without any boundary
+    // pairs.
+    if (!Sparse && oppositeIndex > -1)
     {
-        for (i = 0; i < influenceCount; i ++)
+        for (i = 0; i < columnCount; i ++)
         {
-            j = influenceCount * element + i;
-            double value = transferredWeights[j];
-
-            j = influenceCount * (unsigned)oppositeElement + i;
-            transferredWeights.set(value, j);
+            j = columnCount * (unsigned)oppositeElement + i;
+            transferredWeights.set(values[i], j);
         }
     }
 }
@@ -2193,30 +2924,132 @@ void transferWeightsContext::computeTransfer(unsigned int index,
 
 //
 // Description:
-//      Go through the all vertices which are closest to the cursor,
-//      and get all connected vertices which are in range of the brush
-//      radius. Perform the selection.
+//      Return the specialized transfer kernel for the current settings.
+//      The kernel is selected once per dab so that the loops over the
+//      influences don't need to check the settings for each weight.
 //
 // Input Arguments:
-//      event               The mouse event.
-//      indices             The list of vertex indices along the
-//                          intersection ray.
-//      distances           The list of distances of the vertices to the
-//                          intersection ray.
+//      sparse              True, if only the columns of the transfer
+//                          influences get written.
 //
 // Return Value:
-//      MStatus             The MStatus for selecting the components.
+//      transferKernel      The member function pointer of the kernel.
 //
-MStatus transferWeightsContext::performSelect(MEvent event,
-                                              MIntArray indices,
-                                              MFloatArray distances)
+transferWeightsContext::transferKernel transferWeightsContext::getTransferKernel(bool sparse)
 {
-    MStatus status = MStatus::kSuccess;
+    if (sparse)
+    {
+        if (volumeVal)
+            return &transferWeightsContext::computeTransfer<true, false, true>;
+        return &transferWeightsContext::computeTransfer<false, false, true>;
+    }
 
-    unsigned int i;
+    if (volumeVal)
+    {
+        if (normalize)
+            return &transferWeightsContext::computeTransfer<true, true, false>;
+        return &transferWeightsContext::computeTransfer<true, false, false>;
+    }
 
-    MFnSingleIndexedComponent comp;
-    MObject compObj = comp.create(MFn::kMeshVertComponent);
+    if (normalize)
+        return &transferWeightsContext::computeTransfer<false, true, false>;
+    return &transferWeightsContext::computeTransfer<false, false, false>;
+}
+
+
+//
+// Description:
+//      Get the source and destination influences of the transfer. The
+//      source influence list replaces the single source influence if
+//      it's not empty. When reversed, the weights move from the
+//      destination to the sources. Invalid, locked and duplicate
+//      influences are skipped, as well as sources which are also a
+//      destination.
+//
+// Input Arguments:
+//      mirrored            True, if the influences get mapped to the
+//                          mirrored influences.
+//      sources             The list of source influence indices.
+//      destinations        The list of destination influence indices.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getTransferInfluences(bool mirrored,
+                                                   std::vector<unsigned int> &sources,
+                                                   std::vector<unsigned int> &destinations)
+{
+    unsigned int i;
+
+    sources.clear();
+    destinations.clear();
+
+    std::vector<int> sourceList;
+    if (sourceIndices.length())
+    {
+        for (i = 0; i < sourceIndices.length(); i ++)
+            sourceList.push_back(sourceIndices[i]);
+    }
+    else
+        sourceList.push_back(sourceInfluenceVal);
+
+    std::vector<int> destinationList(1, destinationInfluenceVal);
+
+    if (reverseVal)
+        sourceList.swap(destinationList);
+
+    std::vector<bool> used(influenceCount, false);
+
+    auto addInfluence = [&](int index, std::vector<unsigned int> &list)
+    {
+        if (index < 0 || index >= (int)influenceCount)
+            return;
+
+        if (mirrored && index < (int)influenceMirror.size())
+            index = influenceMirror[(unsigned)index];
+
+        if (influenceLocks[(unsigned)index] || used[(unsigned)index])
+            return;
+
+        used[(unsigned)index] = true;
+        list.push_back((unsigned)index);
+    };
+
+    // Add the destinations first so that an influence which is also
+    // listed as a source only receives weight.
+    for (i = 0; i < destinationList.size(); i ++)
+        addInfluence(destinationList[i], destinations);
+    for (i = 0; i < sourceList.size(); i ++)
+        addInfluence(sourceList[i], sources);
+}
+
+
+//
+// Description:
+//      Go through the all vertices which are closest to the cursor,
+//      and get all connected vertices which are in range of the brush
+//      radius. Perform the selection.
+//
+// Input Arguments:
+//      event               The mouse event.
+//      indices             The list of vertex indices along the
+//                          intersection ray.
+//      distances           The list of distances of the vertices to the
+//                          intersection ray.
+//
+// Return Value:
+//      MStatus             The MStatus for selecting the components.
+//
+MStatus transferWeightsContext::performSelect(MEvent event,
+                                              MIntArray indices,
+                                              MFloatArray distances)
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    MFnSingleIndexedComponent comp;
+    MObject compObj = comp.create(MFn::kMeshVertComponent);
 
     if (!volumeVal)
     {
@@ -2294,6 +3127,9 @@ void transferWeightsContext::performFlood()
     // method to simply transfer with the current strength value.
     doPressCommon(event);
 
+    // The flood vertices replace the selected vertices.
+    dirtyLayers |= kDirtySelection;
+
     // If the current selection doesn't contain any components fill the
     // array with the indices of all vertices of the mesh.
     if (!vtxSelection.length())
@@ -2424,66 +3260,131 @@ void transferWeightsContext::getVerticesInRange(int index,
                                                 MIntArray &indices,
                                                 MFloatArray &values)
 {
-    unsigned int i, j;
+    unsigned int i;
 
-    MItMeshVertex vtxIter(meshDag);
+    if (distanceVal == 1 && topology.hasPoints())
+    {
+        getVerticesInGeodesicRange(index, hitIndex, indices, values);
+        return;
+    }
+    else if (distanceVal == 2 && !heat.isEmpty())
+    {
+        getVerticesInHeatRange(index, hitIndex, indices, values);
+        return;
+    }
 
-    // This array stored which indices have beeen visited by setting
-    // their index to false.
-    std::vector<bool> visited(numVertices, false);
-
-    // Set the center vertex as visited to prevent it from being listed
-    // twice due to the walking process.
-    visited[(unsigned)index] = true;
-
-    // This array holds the indices which should be processed for each
-    // iteration, walking from the center vertex outward.
-    // The first time it only includes the center vertex which is
-    // closest to the cursor. The next time it holds all the vertices
-    // which are connected to the center vertex, and so on.
-    MIntArray walkIndices;
-    walkIndices.append(index);
-
-    // Continue to go through connected vertices as long as these are
-    // within the brush radius. Once an iteration contains only vertices
-    // which are out of range walkIndices will be empty and the process
-    // can be finished.
-    while (walkIndices.length() > 0)
-    {
-        MIntArray nextIndices;
-        for (i = 0; i < walkIndices.length(); i ++)
-        {
-            // The connected vertices and their values which are in
-            // range.
-            MIntArray connectedIndices;
-            MFloatArray connectedValues;
-            int oppositeIndex = -1;
-            getConnectedInRange(surfacePoints[(unsigned)hitIndex],
-                                walkIndices[i],
-                                visited,
-                                connectedIndices,
-                                connectedValues,
-                                oppositeIndex);
-
-            for (j = 0; j < connectedIndices.length(); j ++)
-            {
-                // Add the found vertices and their values to the return
-                // arrays.
-                indices.append(connectedIndices[j]);
-                values.append(connectedValues[j]);
-
-                // Store the connected indices of each walk index to be
-                // used for the next walk iteration.
-                nextIndices.append(connectedIndices[j]);
-            }
-        }
-        walkIndices = nextIndices;
+    // Walk outward from the center vertex over the cached adjacency as
+    // long as the connected vertices are within the brush radius. The
+    // walk includes the opposite vertices of shell boundaries.
+    MPoint centerPoint = centerPoints[(unsigned)hitIndex];
+    double center[3] = {centerPoint.x, centerPoint.y, centerPoint.z};
+
+    std::vector<unsigned int> rangeIndices;
+    std::vector<double> rangeDistances;
+    topology.getEuclideanRange((unsigned)index,
+                               center,
+                               sizeVal,
+                               [this](unsigned int vertex)
+                               { return getOppositeIndex((int)vertex); },
+                               rangeIndices,
+                               rangeDistances);
+
+    counters.add(strokeCounters::kRangeVertices, rangeIndices.size());
+
+    for (i = 0; i < rangeIndices.size(); i ++)
+    {
+        indices.append((int)rangeIndices[i]);
+        values.append((float)(1 - (rangeDistances[i] / sizeVal)));
+    }
+}
+
+
+//
+// Description:
+//      Based on the given index find the connected indices within the
+//      brush radius by measuring the distance along the mesh edges
+//      instead of the straight distance to the surface point.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      hitIndex            The index of the item along the intersection
+//                          ray.
+//      indices             The array of indices within the range.
+//      values              The array of falloff values for the indices.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getVerticesInGeodesicRange(int index,
+                                                        int hitIndex,
+                                                        MIntArray &indices,
+                                                        MFloatArray &values)
+{
+    unsigned int i;
+
+    MPoint pos = getVertexPosition(index, MSpace::kWorld);
+    double startDistance = pos.distanceTo(centerPoints[(unsigned)hitIndex]);
+
+    std::vector<unsigned int> rangeIndices;
+    std::vector<double> rangeDistances;
+    topology.getGeodesicRange((unsigned)index,
+                              startDistance,
+                              sizeVal,
+                              [this](unsigned int vertex)
+                              { return getOppositeIndex((int)vertex); },
+                              rangeIndices,
+                              rangeDistances);
+
+    counters.add(strokeCounters::kRangeVertices, rangeIndices.size());
 
-        // Break from the loop in case the brush radius includes all
-        // vertices.
-        if (indices.length() == (unsigned)vtxIter.count())
+    for (i = 0; i < rangeIndices.size(); i ++)
+    {
+        indices.append((int)rangeIndices[i]);
+        values.append((float)(1 - (rangeDistances[i] / sizeVal)));
+    }
+}
+
+
+//
+// Description:
+//      Based on the given index find the indices within the brush
+//      radius by using the heat method distance field of the mesh. The
+//      distances of all vertices are the result of two solves with the
+//      prefactored operators.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      hitIndex            The index of the item along the intersection
+//                          ray.
+//      indices             The array of indices within the range.
+//      values              The array of falloff values for the indices.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getVerticesInHeatRange(int index,
+                                                    int hitIndex,
+                                                    MIntArray &indices,
+                                                    MFloatArray &values)
+{
+    unsigned int i;
+
+    MPoint pos = getVertexPosition(index, MSpace::kWorld);
+    double startDistance = pos.distanceTo(centerPoints[(unsigned)hitIndex]);
+
+    std::vector<unsigned int> sources(1, (unsigned)index);
+    std::vector<double> distances;
+    heat.getDistances(sources, distances);
+
+    counters.add(strokeCounters::kRangeVertices, distances.size());
+
+    for (i = 0; i < distances.size(); i ++)
+    {
+        double distance = startDistance + distances[i];
+        if (i != (unsigned)index && distance <= sizeVal)
         {
-            break;
+            indices.append((int)i);
+            values.append((float)(1 - (distance / sizeVal)));
         }
     }
 }
@@ -2491,107 +3392,482 @@ void transferWeightsContext::getVerticesInRange(int index,
 
 //
 // Description:
-//      Get the vertices which are connected to the given index and
-//      their falloff values.
+//      Return the vertex on the neighbouring shell which shares the
+//      position with the given border vertex. Previously mapped pairs
+//      are taken from the index map.
+//
+// Input Arguments:
+//      index               The index of the border vertex.
+//
+// Return Value:
+//      int                 The opposite vertex index or -1.
+//
+int transferWeightsContext::getOppositeIndex(int index)
+{
+    if (!keepShellsTogetherVal)
+        return -1;
+
+    if (indexMap[(unsigned)index] > -1)
+        return indexMap[(unsigned)index];
+
+    MItMeshVertex vtxIter(meshDag);
+    counters.add(strokeCounters::kIterators);
+
+    int prevIndex;
+    vtxIter.setIndex(index, prevIndex);
+
+    MIntArray faces;
+    vtxIter.getConnectedFaces(faces);
+
+    MIntArray edges;
+    vtxIter.getConnectedEdges(edges);
+
+    counters.add(strokeCounters::kArrays, 2);
+
+    int oppositeIndex;
+    if (oppositeBoundaryIndex(getVertexPosition(vtxIter, MSpace::kObject), faces, edges, oppositeIndex) &&
+        oppositeIndex != index)
+        return oppositeIndex;
+
+    return -1;
+}
+
+
+//
+// Description:
+//      Build the cached vertex adjacency of the mesh if it doesn't
+//      exist yet and update the edge lengths from the current world
+//      space positions.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::updateTopology()
+{
+    if (topology.isEmpty())
+    {
+        std::vector<int> counts;
+        std::vector<int> vertices;
+        getPolygonValues(counts, vertices);
+
+        topology.create(numVertices, counts, vertices);
+    }
+
+    // The edge lengths only change with the shape of the mesh or when
+    // switching between the bind pose and the current shape.
+    if (topology.hasPoints() && !(dirtyLayers & kDirtyPoints))
+        return;
+
+    std::vector<double> values;
+    getPointValues(values);
+    topology.setPoints(values);
+    dirtyLayers &= ~kDirtyPoints;
+}
+
+
+//
+// Description:
+//      Triangulate the mesh and factorize the heat method operators if
+//      this hasn't been done yet for the current mesh. The operators
+//      are based on the world space positions at the time of the first
+//      use and are kept until the mesh changes.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::updateHeatDistance()
+{
+    if (!heat.isEmpty() || heatFailed)
+        return;
+
+    std::vector<int> triangles;
+    getTriangleValues(triangles);
+
+    std::vector<double> values;
+    getPointValues(values);
+
+    // A failed factorization is remembered until the mesh or the bind
+    // pose setting changes, so that it doesn't get repeated with every
+    // press.
+    if (!heat.create(numVertices, triangles, values))
+    {
+        heatFailed = true;
+        MGlobal::displayWarning("The heat method could not be set up for the mesh. "
+                                "The distance is measured in euclidean space.");
+    }
+}
+
+
+// ---------------------------------------------------------------------
+// bind pose
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Capture the world space positions of the skin cluster input
+//      geometry, which is the mesh before the deformation. These are
+//      independent of the current pose and are kept for the mesh.
+//      Also create the intersector for the seam detection based on the
+//      input geometry.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStatus             kSuccess if the input geometry matches the
+//                          mesh.
+//
+MStatus transferWeightsContext::captureBindPose()
+{
+    MStatus status = MStatus::kSuccess;
+
+    unsigned int i;
+
+    bindPoints.clear();
+
+    MFnSkinCluster skinFn(skinObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    unsigned int index = skinFn.indexForOutputShape(meshDag.node(), &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    // Get the geometry from the input plug of the skin cluster so that
+    // any deformation before the skin cluster is included.
+    MPlug inputPlug = skinFn.findPlug("input", false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    inputPlug = inputPlug.elementByLogicalIndex(index, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    MPlug geometryPlug = inputPlug.child(0, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MObject inputObj = geometryPlug.asMObject();
+    MFnMesh inputFn(inputObj, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    // The input geometry is only usable if the vertices match.
+    if ((unsigned)inputFn.numVertices() != numVertices)
+        return MStatus::kFailure;
+
+    MMatrix matrix = meshDag.inclusiveMatrix();
+
+    status = bindIntersector.create(inputObj, matrix);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+    MPointArray points;
+    inputFn.getPoints(points, MSpace::kObject);
+    for (i = 0; i < points.length(); i ++)
+        points[i] *= matrix;
+
+    bindPoints = points;
+
+    return status;
+}
+
+
+//
+// Description:
+//      Return if the distances are measured on the input geometry of
+//      the skin cluster.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      bool                True, if the bind pose has been captured.
+//
+bool transferWeightsContext::useBindPose()
+{
+    return bindPoseVal && bindPoints.length() == numVertices;
+}
+
+
+//
+// Description:
+//      Return the position on the input geometry which corresponds to
+//      the given position on a triangle of the mesh.
+//
+// Input Arguments:
+//      faceIndex           The index of the polygon.
+//      triangleIndex       The index of the triangle of the polygon.
+//      bary1               The barycentric coordinate of the first
+//                          triangle vertex.
+//      bary2               The barycentric coordinate of the second
+//                          triangle vertex.
+//
+// Return Value:
+//      MPoint              The position in bind pose.
+//
+MPoint transferWeightsContext::getBindPoint(int faceIndex, int triangleIndex, float bary1, float bary2)
+{
+    int vertices[3];
+    meshFn.getPolygonTriangleVertices(faceIndex, triangleIndex, vertices);
+
+    MPoint p1 = bindPoints[(unsigned)vertices[0]];
+    MPoint p2 = bindPoints[(unsigned)vertices[1]];
+    MPoint p3 = bindPoints[(unsigned)vertices[2]];
+    double bary3 = 1.0 - bary1 - bary2;
+
+    return MPoint(p1.x * bary1 + p2.x * bary2 + p3.x * bary3,
+                  p1.y * bary1 + p2.y * bary2 + p3.y * bary3,
+                  p1.z * bary1 + p2.z * bary2 + p3.z * bary3);
+}
+
+
+//
+// Description:
+//      Return the position of the given vertex which is used for
+//      measuring distances. This is the world space position of the
+//      input geometry when using the bind pose.
+//
+// Input Arguments:
+//      index               The vertex index.
+//      space               The space of the mesh position.
+//
+// Return Value:
+//      MPoint              The vertex position.
+//
+MPoint transferWeightsContext::getVertexPosition(int index, MSpace::Space space)
+{
+    if (useBindPose())
+        return bindPoints[(unsigned)index];
+
+    MPoint position;
+    meshFn.getPoint(index, position, space);
+    return position;
+}
+
+
+//
+// Description:
+//      Return the position of the current vertex of the given iterator
+//      which is used for measuring distances.
+//
+// Input Arguments:
+//      vtxIter             The vertex iterator set to the vertex.
+//      space               The space of the mesh position.
+//
+// Return Value:
+//      MPoint              The vertex position.
+//
+MPoint transferWeightsContext::getVertexPosition(MItMeshVertex &vtxIter, MSpace::Space space)
+{
+    if (useBindPose())
+        return bindPoints[(unsigned)vtxIter.index()];
+
+    return vtxIter.position(space);
+}
+
+
+//
+// Description:
+//      Get the world space positions of all mesh vertices as a flat
+//      array of xyz values. These are the positions of the input
+//      geometry when using the bind pose.
+//
+// Input Arguments:
+//      values              The array of positions.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getPointValues(std::vector<double> &values)
+{
+    unsigned int i;
+
+    MPointArray points;
+    if (useBindPose())
+        points = bindPoints;
+    else
+        meshFn.getPoints(points, MSpace::kWorld);
+
+    values.resize(points.length() * 3);
+    for (i = 0; i < points.length(); i ++)
+    {
+        values[i * 3] = points[i].x;
+        values[i * 3 + 1] = points[i].y;
+        values[i * 3 + 2] = points[i].z;
+    }
+}
+
+
+//
+// Description:
+//      Get the vertex indices of all mesh triangles as a flat array.
+//
+// Input Arguments:
+//      values              The array of triangle vertex indices.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getTriangleValues(std::vector<int> &values)
+{
+    MIntArray triangleCounts;
+    MIntArray triangleVertices;
+    meshFn.getTriangles(triangleCounts, triangleVertices);
+
+    values.resize(triangleVertices.length());
+    triangleVertices.get(values.data());
+}
+
+
+//
+// Description:
+//      Get the vertex count and the vertex indices of all mesh
+//      polygons as flat arrays.
+//
+// Input Arguments:
+//      counts              The array of vertex counts per polygon.
+//      vertices            The array of polygon vertex indices.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::getPolygonValues(std::vector<int> &counts, std::vector<int> &vertices)
+{
+    MIntArray polyCounts;
+    MIntArray polyVertices;
+    meshFn.getVertices(polyCounts, polyVertices);
+
+    counts.resize(polyCounts.length());
+    vertices.resize(polyVertices.length());
+    polyCounts.get(counts.data());
+    polyVertices.get(vertices.data());
+}
+
+
+//
+// Description:
+//      Return the vertex indices within the brush volume.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      int array           The array of indices in the volume.
+//
+MIntArray transferWeightsContext::getVerticesInVolume()
+{
+    unsigned int i;
+
+    MIntArray indices;
+
+    double center[3] = {centerPoints[0].x, centerPoints[0].y, centerPoints[0].z};
+
+    std::vector<unsigned int> volumeIndices;
+    topology.getVerticesInSphere(center, sizeVal, volumeIndices);
+
+    for (i = 0; i < volumeIndices.size(); i ++)
+        indices.append((int)volumeIndices[i]);
+
+    counters.add(strokeCounters::kRangeVertices, numVertices);
+    counters.add(strokeCounters::kArrays);
+
+    return indices;
+}
+
+
+//
+// Description:
+//      Calculate the brush weight value based on the given linear
+//      falloff value.
+//
+// Input Arguments:
+//      value               The linear falloff value.
+//      strength            The brush strength value.
+//
+// Return Value:
+//      double              The brush curve-based falloff value.
+//
+double transferWeightsContext::getFalloffValue(double value, double strength)
+{
+    return falloffValue(curveVal, value, strength);
+}
+
+
+//
+// Description:
+//      Return if the given event is valid by querying the mouse button
+//      and testing the returned MStatus.
+//
+// Input Arguments:
+//      event               The MEvent to test.
+//
+// Return Value:
+//      bool                True, if the event is valid.
+//
+bool transferWeightsContext::eventIsValid(MEvent event)
+{
+    MStatus status;
+    event.mouseButton(&status);
+    if (!status)
+        return false;
+    return true;
+}
+
+
+// ---------------------------------------------------------------------
+// mirror
+// ---------------------------------------------------------------------
+
+//
+// Description:
+//      Build the mirror maps for the vertices and the influences. The
+//      maps are kept for the mesh and only get rebuilt when the mesh,
+//      the influences or the mirror settings change. The vertex map is
+//      based on the positions the distances are measured on.
 //
 // Input Arguments:
-//      centerPoint         The intersection surface point.
-//      index               The index of the current vertex.
-//      visited             The array of indices which already have been
-//                          visited and processed.
-//      indices             The array of connected indices if they are
-//                          within the range.
-//      values              The array of distances of the indices to the
-//                          surface point.
-//      oppositeIndex       The opposite index of the given index if
-//                          this is located on a shell boundary.
+//      None
 //
 // Return Value:
 //      None
 //
-void transferWeightsContext::getConnectedInRange(MPoint centerPoint,
-                                                 int index,
-                                                 std::vector<bool> &visited,
-                                                 MIntArray &indices,
-                                                 MFloatArray &values,
-                                                 int &oppositeIndex)
+void transferWeightsContext::updateMirror()
 {
     unsigned int i;
 
-    MItMeshVertex vtxIter(meshDag);
+    unsigned int axis = (unsigned)(mirrorVal - 1);
 
-    int prevIndex;
-    vtxIter.setIndex(index, prevIndex);
+    if (mirror.size() != numVertices)
+    {
+        std::vector<double> points;
+        getPointValues(points);
+        mirror.create(points, axis, mirrorToleranceVal);
 
-    // Get the connected vertices of the current index.
-    MIntArray connectedIndices;
-    vtxIter.getConnectedVertices(connectedIndices);
+        mirrorStamps = std::vector<unsigned int>(numVertices, 0);
+        mirrorGeneration = 0;
+    }
 
-    // If the selection should span across the shell boundary get the
-    // opposite vertex and it's connected vertices.
-    if (keepShellsTogetherVal)
+    // Map each influence to the influence at the mirrored position.
+    // Influences without a counterpart, such as the ones on the mirror
+    // plane, map to themselves.
+    unsigned int numInfluences = inflDagPaths.length();
+    if (influenceMirror.size() != numInfluences)
     {
-        // If the index has already been mapped simply get the opposite
-        // index from the mapping array and then get it's connected
-        // vertices.
-        if (indexMap[(unsigned)index] > -1)
+        std::vector<double> positions(numInfluences * 3);
+        for (i = 0; i < numInfluences; i ++)
         {
-            oppositeIndex = indexMap[(unsigned)index];
-
-            // Add the opposite vertex to the array of connected
-            // vertices.
-            connectedIndices.append(oppositeIndex);
-
-            // Get all vertices which are connected to the opposite
-            // boundary vertex and add them to the array of connected
-            // vertices.
-            appendConnectedIndices(oppositeIndex, connectedIndices);
+            MPoint position = MPoint() * inflDagPaths[i].inclusiveMatrix();
+            positions[i * 3] = position.x;
+            positions[i * 3 + 1] = position.y;
+            positions[i * 3 + 2] = position.z;
         }
-        // Otherwise, if the index has't been mapped yet check if the
-        // current vertex is located on the boundary.
-        else if (onBoundary(index))
-        {
-            MIntArray faces;
-            vtxIter.getConnectedFaces(faces);
-
-            MIntArray edges;
-            vtxIter.getConnectedEdges(edges);
 
-            // In case it's a boundary vertex get the opposite vertex.
-            if (oppositeBoundaryIndex(vtxIter.position(), faces, edges, oppositeIndex))
-            {
-                // Add the opposite vertex to the array of connected
-                // vertices.
-                connectedIndices.append(oppositeIndex);
-
-                // Get all vertices which are connected to the opposite
-                // boundary vertex and add them to the array of
-                // connected vertices.
-                appendConnectedIndices(oppositeIndex, connectedIndices);
-            }
-        }
-    }
+        mirrorMap influenceMap;
+        influenceMap.create(positions, axis, mirrorToleranceVal);
 
-    for (i = 0; i < connectedIndices.length(); i ++)
-    {
-        int nextIndex = connectedIndices[i];
-        // Continue if the current index hasn't been processed yet.
-        if (!visited[(unsigned)nextIndex])
+        influenceMirror.resize(numInfluences);
+        for (i = 0; i < numInfluences; i ++)
         {
-            MPoint pos;
-            meshFn.getPoint(nextIndex, pos, MSpace::kWorld);
-            MVector delta(pos - centerPoint);
-            double distance = delta.length();
-
-            // Check of the vertex position is within the brush radius.
-            if (distance <= sizeVal)
-            {
-                // Append the index and the distance to the arrays.
-                indices.append(nextIndex);
-                values.append((float)(1 - (distance / sizeVal)));
-                // Mark the index as visited.
-                visited[(unsigned)nextIndex] = true;
-            }
+            int index = influenceMap.mirrorIndex(i);
+            influenceMirror[i] = index != -1 ? index : (int)i;
         }
     }
 }
@@ -2599,120 +3875,82 @@ void transferWeightsContext::getConnectedInRange(MPoint centerPoint,
 
 //
 // Description:
-//      Get the connected vertices of the given index and append then to
-//      the given array of indices.
+//      Return if the brush gets mirrored.
 //
 // Input Arguments:
-//      index               The vertex index.
-//      indices             The array of connected indices to append to.
+//      None
 //
 // Return Value:
-//      None
+//      bool                True, if the mirror map matches the mesh.
 //
-void transferWeightsContext::appendConnectedIndices(int index, MIntArray &indices)
+bool transferWeightsContext::useMirror()
 {
-    unsigned int i;
-
-    MItMeshVertex vtxIter(meshDag);
-
-    int prevIndex;
-    vtxIter.setIndex(index, prevIndex);
-
-    MIntArray vertexList;
-    vtxIter.getConnectedVertices(vertexList);
-
-    for (i = 0; i < vertexList.length(); i ++)
-        indices.append(vertexList[i]);
+    return mirrorVal > 0 && mirror.size() == numVertices;
 }
 
 
 //
 // Description:
-//      Return the vertex indices within the brush volume.
+//      Append the mirrored vertices of the given brush vertices to the
+//      indices along with the falloff value of their source vertex, so
+//      that both sides get transferred in the same pass. Vertices which
+//      are already part of the brush aren't added twice.
+//      The vertices get stamped with the current generation, which
+//      avoids clearing an array for all vertices with each dab.
 //
 // Input Arguments:
-//      None
+//      indices             The vertex indices of the brush.
+//      values              The falloff values of the brush vertices.
 //
 // Return Value:
-//      int array           The array of indices in the volume.
+//      None
 //
-MIntArray transferWeightsContext::getVerticesInVolume()
+void transferWeightsContext::appendMirrorIndices(MIntArray &indices, MFloatArray &values)
 {
-    MIntArray indices;
-
-    double radius = sizeVal * sizeVal;
+    unsigned int i;
 
-    MItMeshVertex vtxIter(meshDag);
-    while (!vtxIter.isDone())
+    // Each dab uses two stamps, one for the brush vertices and one for
+    // the mirrored vertices.
+    mirrorGeneration += 2;
+    if (mirrorGeneration < 2)
     {
-        MPoint pnt = vtxIter.position(MSpace::kWorld);
-
-        double x = pnt.x - surfacePoints[0].x;
-        double y = pnt.y - surfacePoints[0].y;
-        double z = pnt.z - surfacePoints[0].z;
-
-        x *= x;
-        y *= y;
-        z *= z;
-
-        if (x + y + z <= radius)
-            indices.append(vtxIter.index());
-
-        vtxIter.next();
+        std::fill(mirrorStamps.begin(), mirrorStamps.end(), 0);
+        mirrorGeneration = 2;
     }
 
-    return indices;
-}
+    unsigned int count = indices.length();
+    for (i = 0; i < count; i ++)
+        mirrorStamps[(unsigned)indices[i]] = mirrorGeneration;
 
+    for (i = 0; i < count; i ++)
+    {
+        int index = mirror.mirrorIndex((unsigned)indices[i]);
+        if (index != -1 && mirrorStamps[(unsigned)index] < mirrorGeneration)
+        {
+            mirrorStamps[(unsigned)index] = mirrorGeneration + 1;
+            indices.append(index);
+            values.append(values[i]);
+        }
+    }
 
-//
-// Description:
-//      Calculate the brush weight value based on the given linear
-//      falloff value.
-//
-// Input Arguments:
-//      value               The linear falloff value.
-//      strength            The brush strength value.
-//
-// Return Value:
-//      double              The brush curve-based falloff value.
-//
-double transferWeightsContext::getFalloffValue(double value, double strength)
-{
-    if (curveVal == 0)
-        return 1.0 * strength;
-    // linear
-    else if (curveVal == 1)
-        return value * strength;
-    // smoothstep
-    else if (curveVal == 2)
-        return (value * value * (3 - 2 * value)) * strength;
-    // narrow - quadratic
-    else if (curveVal == 3)
-        return (1 - pow((1 - value) / 1, 0.4)) * strength;
-    else
-        return value;
+    counters.add(strokeCounters::kRangeVertices, indices.length() - count);
 }
 
 
 //
 // Description:
-//      Return if the given event is valid by querying the mouse button
-//      and testing the returned MStatus.
+//      Return if the given vertex has been added as the mirrored vertex
+//      of the current dab.
 //
 // Input Arguments:
-//      event               The MEvent to test.
+//      index               The vertex index.
 //
 // Return Value:
-//      bool                True, if the event is valid.
+//      bool                True, if the vertex is mirrored.
 //
-bool transferWeightsContext::eventIsValid(MEvent event)
+bool transferWeightsContext::isMirrored(unsigned int index)
 {
-    MStatus status;
-    event.mouseButton(&status);
-    if (!status)
-        return false;
-    return true;
+    return useMirror() && mirrorStamps[index] == mirrorGeneration + 1;
 }
 
 
@@ -2734,6 +3972,11 @@ bool transferWeightsContext::onBoundary(int index)
 {
     unsigned int i;
 
+    // The border flags are known without querying the mesh once the
+    // adjacency has been built or read from the topology cache.
+    if (!topology.isEmpty())
+        return topology.onBoundary((unsigned)index);
+
     int prevIndex;
 
     MItMeshVertex vtxIter(meshDag);
@@ -2744,6 +3987,9 @@ bool transferWeightsContext::onBoundary(int index)
 
     MItMeshEdge edgeIter(meshDag);
 
+    counters.add(strokeCounters::kIterators, 2);
+    counters.add(strokeCounters::kArrays);
+
     for (i = 0; i < edges.length(); i ++)
     {
         edgeIter.setIndex(edges[i], prevIndex);
@@ -2781,6 +4027,11 @@ bool transferWeightsContext::oppositeBoundaryIndex(MPoint point,
 
     bool result = false;
 
+    counters.add(strokeCounters::kSeamLookups);
+
+    // The faces and edges are passed by value.
+    counters.add(strokeCounters::kArrays, 2);
+
     int faceIndex;
 
     double edgeLength = averageEdgeLength(edges) * 0.25;
@@ -2828,14 +4079,16 @@ bool transferWeightsContext::oppositeBoundaryIndex(MPoint point,
     MIntArray vertices;
     polyIter.getVertices(vertices);
 
+    counters.add(strokeCounters::kIterators);
+    counters.add(strokeCounters::kArrays);
+
     // Go through the face vertices and check which one matches the
     // position of the initial boundary vertex.
     for (i = 0; i < vertices.length(); i ++)
     {
         int vtx = vertices[i];
 
-        MPoint vtxPoint;
-        meshFn.getPoint(vtx, vtxPoint);
+        MPoint vtxPoint = getVertexPosition(vtx, MSpace::kObject);
         if (vtxPoint.isEquivalent(point, toleranceVal))
         {
             index = vtx;
@@ -2867,9 +4120,15 @@ bool transferWeightsContext::getClosestFace(MPoint point, MIntArray faces, int &
 {
     unsigned int i;
 
+    // The faces are passed by value.
+    counters.add(strokeCounters::kArrays);
+
     // Get the closest point to the given boundary point.
     MPointOnMesh meshPoint;
-    intersector.getClosestPoint(point, meshPoint);
+    if (useBindPose())
+        bindIntersector.getClosestPoint(point, meshPoint);
+    else
+        intersector.getClosestPoint(point, meshPoint);
 
     // The face index of the closest point.
     index = meshPoint.faceIndex();
@@ -2904,6 +4163,10 @@ double transferWeightsContext::averageEdgeLength(MIntArray edges)
 
     MItMeshEdge edgeIter(meshDag);
 
+    // The edges are passed by value.
+    counters.add(strokeCounters::kArrays);
+    counters.add(strokeCounters::kIterators);
+
     int prevIndex;
     for (i = 0; i < numEdges; i ++)
     {
@@ -2938,6 +4201,43 @@ void transferWeightsContext::setAffectSelected(bool value)
 }
 
 
+void transferWeightsContext::setBindPose(bool value)
+{
+    // The edge lengths and the operators are based on the positions
+    // the distances are measured on.
+    if (value != bindPoseVal)
+    {
+        dirtyLayers |= kDirtyPoints;
+        mirror.clear();
+        heat.clear();
+        heatFailed = false;
+    }
+
+    bindPoseVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
+void transferWeightsContext::setCacheDirectory(MString value)
+{
+    cacheDirectoryVal = value;
+
+    // Saving the scene only writes the weight cache while a directory
+    // is set.
+    if (cacheDirectoryVal.length() && saveCallbackId == 0)
+    {
+        saveCallbackId = MSceneMessage::addCallback(MSceneMessage::kAfterSave,
+                                                    afterSaveCallback,
+                                                    this);
+    }
+    else if (!cacheDirectoryVal.length() && saveCallbackId != 0)
+    {
+        MMessage::removeCallback(saveCallbackId);
+        saveCallbackId = 0;
+    }
+}
+
+
 void transferWeightsContext::setColorR(float value)
 {
     colorVal.r = value;
@@ -2987,6 +4287,13 @@ void transferWeightsContext::setDestinationInfluence(int value)
 }
 
 
+void transferWeightsContext::setDistance(int value)
+{
+    distanceVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void transferWeightsContext::setDrawBrush(bool value)
 {
     drawBrushVal = value;
@@ -3040,6 +4347,33 @@ void transferWeightsContext::setMessage(int value)
 }
 
 
+void transferWeightsContext::setMirror(int value)
+{
+    // The mirror maps need to be rebuilt for a different plane.
+    if (value != mirrorVal)
+    {
+        mirror.clear();
+        influenceMirror.clear();
+    }
+
+    mirrorVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
+void transferWeightsContext::setMirrorTolerance(double value)
+{
+    if (value != mirrorToleranceVal)
+    {
+        mirror.clear();
+        influenceMirror.clear();
+    }
+
+    mirrorToleranceVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void transferWeightsContext::setReplace(bool value)
 {
     replaceVal = value;
@@ -3068,6 +4402,28 @@ void transferWeightsContext::setSourceInfluence(int value)
 }
 
 
+void transferWeightsContext::setSourceInfluenceList(MString value)
+{
+    unsigned int i;
+
+    // The list contains the space separated indices of the source
+    // influences. It replaces the single source influence when it's
+    // not empty.
+    sourceIndices.clear();
+
+    MStringArray items;
+    value.split(' ', items);
+    for (i = 0; i < items.length(); i ++)
+    {
+        if (items[i].isInt())
+            sourceIndices.append(items[i].asInt());
+    }
+
+    sourceInfluenceListVal = value;
+    MToolsInfo::setDirtyFlag(*this);
+}
+
+
 void transferWeightsContext::setStrength(double value)
 {
     strengthVal = value;
@@ -3082,6 +4438,18 @@ void transferWeightsContext::setTolerance(double value)
 }
 
 
+void transferWeightsContext::setTrace(bool value)
+{
+    trace.setEnabled(value);
+}
+
+
+void transferWeightsContext::setTraceFile(MString value)
+{
+    traceFileVal = value;
+}
+
+
 void transferWeightsContext::setUndersampling(int value)
 {
     undersamplingVal = value;
@@ -3096,6 +4464,23 @@ void transferWeightsContext::setVolume(bool value)
 }
 
 
+//
+// Description:
+//      Write the recorded trace as a Chrome trace_event JSON file.
+//
+// Input Arguments:
+//      path                The file path of the JSON file.
+//
+// Return Value:
+//      None
+//
+void transferWeightsContext::writeTrace(MString path)
+{
+    if (!trace.write(path.asChar()))
+        MGlobal::displayWarning("The trace could not be written to " + path + ".");
+}
+
+
 // ---------------------------------------------------------------------
 // getting values from the command flags
 // ---------------------------------------------------------------------
@@ -3106,6 +4491,18 @@ bool transferWeightsContext::getAffectSelected()
 }
 
 
+bool transferWeightsContext::getBindPose()
+{
+    return bindPoseVal;
+}
+
+
+MString transferWeightsContext::getCacheDirectory()
+{
+    return cacheDirectoryVal;
+}
+
+
 float transferWeightsContext::getColorR()
 {
     return colorVal.r;
@@ -3124,6 +4521,30 @@ float transferWeightsContext::getColorB()
 }
 
 
+//
+// Description:
+//      Return the number of vertices and influences of the mesh and the
+//      counters of the last stroke.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStringArray        One line per counter.
+//
+MStringArray transferWeightsContext::getCounters()
+{
+    MStringArray result;
+    result.append(("vertices " + std::to_string(numVertices)).c_str());
+    result.append(("influences " + std::to_string(influenceCount)).c_str());
+
+    std::vector<std::string> lines = counters.report();
+    for (unsigned int i = 0; i < lines.size(); i ++)
+        result.append(lines[i].c_str());
+    return result;
+}
+
+
 int transferWeightsContext::getCurve()
 {
     return curveVal;
@@ -3148,6 +4569,12 @@ int transferWeightsContext::getDestinationInfluence()
 }
 
 
+int transferWeightsContext::getDistance()
+{
+    return distanceVal;
+}
+
+
 bool transferWeightsContext::getDrawBrush()
 {
     return drawBrushVal;
@@ -3184,6 +4611,18 @@ int transferWeightsContext::getMessage()
 }
 
 
+int transferWeightsContext::getMirror()
+{
+    return mirrorVal;
+}
+
+
+double transferWeightsContext::getMirrorTolerance()
+{
+    return mirrorToleranceVal;
+}
+
+
 bool transferWeightsContext::getReplace()
 {
     return replaceVal;
@@ -3208,6 +4647,33 @@ int transferWeightsContext::getSourceInfluence()
 }
 
 
+MString transferWeightsContext::getSourceInfluenceList()
+{
+    return sourceInfluenceListVal;
+}
+
+
+//
+// Description:
+//      Return the timings of the brush stages for all strokes since
+//      the tool has been activated and for the last stroke.
+//
+// Input Arguments:
+//      None
+//
+// Return Value:
+//      MStringArray        One line per stage.
+//
+MStringArray transferWeightsContext::getStats()
+{
+    MStringArray result;
+    std::vector<std::string> lines = stats.report();
+    for (unsigned int i = 0; i < lines.size(); i ++)
+        result.append(lines[i].c_str());
+    return result;
+}
+
+
 double transferWeightsContext::getStrength()
 {
     return strengthVal;
@@ -3220,6 +4686,18 @@ double transferWeightsContext::getTolerance()
 }
 
 
+bool transferWeightsContext::getTrace()
+{
+    return trace.isEnabled();
+}
+
+
+MString transferWeightsContext::getTraceFile()
+{
+    return traceFileVal;
+}
+
+
 int transferWeightsContext::getUndersampling()
 {
     return undersamplingVal;
@@ -3262,13 +4740,17 @@ MStatus transferWeightsContextCmd::appendSyntax()
     MSyntax syn = syntax();
 
     syn.addFlag(kAffectSelectedFlag, kAffectSelectedFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kBindPoseFlag, kBindPoseFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kCacheDirectoryFlag, kCacheDirectoryFlagLong, MSyntax::kString);
     syn.addFlag(kColorRFlag, kColorRFlagLong, MSyntax::kDouble);
     syn.addFlag(kColorGFlag, kColorGFlagLong, MSyntax::kDouble);
     syn.addFlag(kColorBFlag, kColorBFlagLong, MSyntax::kDouble);
+    syn.addFlag(kCountersFlag, kCountersFlagLong);
     syn.addFlag(kCurveFlag, kCurveFlagLong, MSyntax::kLong);
     syn.addFlag(kDepthFlag, kDepthFlagLong, MSyntax::kLong);
     syn.addFlag(kDepthStartFlag, kDepthStartFlagLong, MSyntax::kLong);
     syn.addFlag(kDestinationInfluenceFlag, kDestinationInfluenceFlagLong, MSyntax::kLong);
+    syn.addFlag(kDistanceFlag, kDistanceFlagLong, MSyntax::kLong);
     syn.addFlag(kDrawBrushFlag, kDrawBrushFlagLong, MSyntax::kBoolean);
     syn.addFlag(kEnterToolCommandFlag, kEnterToolCommandFlagLong, MSyntax::kString);
     syn.addFlag(kExitToolCommandFlag, kExitToolCommandFlagLong, MSyntax::kString);
@@ -3276,14 +4758,21 @@ MStatus transferWeightsContextCmd::appendSyntax()
     syn.addFlag(kKeepShellsTogetherFlag, kKeepShellsTogetherFlagLong, MSyntax::kBoolean);
     syn.addFlag(kLineWidthFlag, kLineWidthFlagLong, MSyntax::kLong);
     syn.addFlag(kMessageFlag, kMessageFlagLong, MSyntax::kLong);
+    syn.addFlag(kMirrorFlag, kMirrorFlagLong, MSyntax::kLong);
+    syn.addFlag(kMirrorToleranceFlag, kMirrorToleranceFlagLong, MSyntax::kDouble);
     syn.addFlag(kReplaceFlag, kReplaceFlagLong, MSyntax::kBoolean);
     syn.addFlag(kReverseFlag, kReverseFlagLong, MSyntax::kBoolean);
     syn.addFlag(kSizeFlag, kSizeFlagLong, MSyntax::kDouble);
     syn.addFlag(kSourceInfluenceFlag, kSourceInfluenceFlagLong, MSyntax::kLong);
+    syn.addFlag(kSourceInfluenceListFlag, kSourceInfluenceListFlagLong, MSyntax::kString);
+    syn.addFlag(kStatsFlag, kStatsFlagLong);
     syn.addFlag(kStrengthFlag, kStrengthFlagLong, MSyntax::kDouble);
     syn.addFlag(kToleranceFlag, kToleranceFlagLong, MSyntax::kDouble);
+    syn.addFlag(kTraceFlag, kTraceFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kTraceFileFlag, kTraceFileFlagLong, MSyntax::kString);
     syn.addFlag(kUndersamplingFlag, kUndersamplingFlagLong, MSyntax::kLong);
     syn.addFlag(kVolumeFlag, kVolumeFlagLong, MSyntax::kBoolean);
+    syn.addFlag(kWriteTraceFlag, kWriteTraceFlagLong, MSyntax::kString);
 
     return MStatus::kSuccess;
 }
@@ -3302,6 +4791,20 @@ MStatus transferWeightsContextCmd::doEditFlags()
         transferContext->setAffectSelected(value);
     }
 
+    if (argData.isFlagSet(kBindPoseFlag))
+    {
+        bool value;
+        status = argData.getFlagArgument(kBindPoseFlag, 0, value);
+        transferContext->setBindPose(value);
+    }
+
+    if (argData.isFlagSet(kCacheDirectoryFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kCacheDirectoryFlag, 0, value);
+        transferContext->setCacheDirectory(value);
+    }
+
     if (argData.isFlagSet(kColorRFlag))
     {
         double value;
@@ -3351,6 +4854,13 @@ MStatus transferWeightsContextCmd::doEditFlags()
         transferContext->setDestinationInfluence(value);
     }
 
+    if (argData.isFlagSet(kDistanceFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kDistanceFlag, 0, value);
+        transferContext->setDistance(value);
+    }
+
     if (argData.isFlagSet(kDrawBrushFlag))
     {
         bool value;
@@ -3400,6 +4910,20 @@ MStatus transferWeightsContextCmd::doEditFlags()
         transferContext->setMessage(value);
     }
 
+    if (argData.isFlagSet(kMirrorFlag))
+    {
+        int value;
+        status = argData.getFlagArgument(kMirrorFlag, 0, value);
+        transferContext->setMirror(value);
+    }
+
+    if (argData.isFlagSet(kMirrorToleranceFlag))
+    {
+        double value;
+        status = argData.getFlagArgument(kMirrorToleranceFlag, 0, value);
+        transferContext->setMirrorTolerance(value);
+    }
+
     if (argData.isFlagSet(kReplaceFlag))
     {
         bool value;
@@ -3428,6 +4952,13 @@ MStatus transferWeightsContextCmd::doEditFlags()
         transferContext->setSourceInfluence(value);
     }
 
+    if (argData.isFlagSet(kSourceInfluenceListFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kSourceInfluenceListFlag, 0, value);
+        transferContext->setSourceInfluenceList(value);
+    }
+
     if (argData.isFlagSet(kStrengthFlag))
     {
         double value;
@@ -3442,6 +4973,20 @@ MStatus transferWeightsContextCmd::doEditFlags()
         transferContext->setTolerance(value);
     }
 
+    if (argData.isFlagSet(kTraceFlag))
+    {
+        bool value;
+        status = argData.getFlagArgument(kTraceFlag, 0, value);
+        transferContext->setTrace(value);
+    }
+
+    if (argData.isFlagSet(kTraceFileFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kTraceFileFlag, 0, value);
+        transferContext->setTraceFile(value);
+    }
+
     if (argData.isFlagSet(kUndersamplingFlag))
     {
         int value;
@@ -3456,6 +5001,13 @@ MStatus transferWeightsContextCmd::doEditFlags()
         transferContext->setVolume(value);
     }
 
+    if (argData.isFlagSet(kWriteTraceFlag))
+    {
+        MString value;
+        status = argData.getFlagArgument(kWriteTraceFlag, 0, value);
+        transferContext->writeTrace(value);
+    }
+
     return status;
 }
 
@@ -3466,6 +5018,11 @@ MStatus transferWeightsContextCmd::doQueryFlags()
 
     if (argData.isFlagSet(kAffectSelectedFlag))
         setResult(transferContext->getAffectSelected());
+    if (argData.isFlagSet(kBindPoseFlag))
+        setResult(transferContext->getBindPose());
+
+    if (argData.isFlagSet(kCacheDirectoryFlag))
+        setResult(transferContext->getCacheDirectory());
 
     if (argData.isFlagSet(kColorRFlag))
         setResult(transferContext->getColorR());
@@ -3476,6 +5033,9 @@ MStatus transferWeightsContextCmd::doQueryFlags()
     if (argData.isFlagSet(kColorBFlag))
         setResult(transferContext->getColorB());
 
+    if (argData.isFlagSet(kCountersFlag))
+        setResult(transferContext->getCounters());
+
     if (argData.isFlagSet(kCurveFlag))
         setResult(transferContext->getCurve());
 
@@ -3488,6 +5048,9 @@ MStatus transferWeightsContextCmd::doQueryFlags()
     if (argData.isFlagSet(kDestinationInfluenceFlag))
         setResult(transferContext->getDestinationInfluence());
 
+    if (argData.isFlagSet(kDistanceFlag))
+        setResult(transferContext->getDistance());
+
     if (argData.isFlagSet(kDrawBrushFlag))
         setResult(transferContext->getDrawBrush());
 
@@ -3505,6 +5068,10 @@ MStatus transferWeightsContextCmd::doQueryFlags()
 
     if (argData.isFlagSet(kMessageFlag))
         setResult(transferContext->getMessage());
+    if (argData.isFlagSet(kMirrorFlag))
+        setResult(transferContext->getMirror());
+    if (argData.isFlagSet(kMirrorToleranceFlag))
+        setResult(transferContext->getMirrorTolerance());
 
     if (argData.isFlagSet(kReplaceFlag))
         setResult(transferContext->getReplace());
@@ -3517,6 +5084,11 @@ MStatus transferWeightsContextCmd::doQueryFlags()
 
     if (argData.isFlagSet(kSourceInfluenceFlag))
         setResult(transferContext->getSourceInfluence());
+    if (argData.isFlagSet(kSourceInfluenceListFlag))
+        setResult(transferContext->getSourceInfluenceList());
+
+    if (argData.isFlagSet(kStatsFlag))
+        setResult(transferContext->getStats());
 
     if (argData.isFlagSet(kStrengthFlag))
         setResult(transferContext->getStrength());
@@ -3524,6 +5096,12 @@ MStatus transferWeightsContextCmd::doQueryFlags()
     if (argData.isFlagSet(kToleranceFlag))
         setResult(transferContext->getTolerance());
 
+    if (argData.isFlagSet(kTraceFlag))
+        setResult(transferContext->getTrace());
+
+    if (argData.isFlagSet(kTraceFileFlag))
+        setResult(transferContext->getTraceFile());
+
     if (argData.isFlagSet(kUndersamplingFlag))
         setResult(transferContext->getUndersampling());
 
@@ -11,6 +11,8 @@
 #ifndef __transferWeightsTool__transferWeightsTool__
 #define __transferWeightsTool__transferWeightsTool__
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <tbb/parallel_for.h>
@@ -25,11 +27,15 @@
 #include <maya/MSyntax.h>
 
 #include <maya/M3dView.h>
+#include <maya/MCallbackIdArray.h>
 #include <maya/MCursor.h>
 #include <maya/MDagPath.h>
 #include <maya/MDagPathArray.h>
+#include <maya/MDGMessage.h>
 #include <maya/MEvent.h>
+#include <maya/MFileIO.h>
 #include <maya/MFloatPointArray.h>
+#include <maya/MFnAttribute.h>
 #include <maya/MFnCamera.h>
 #include <maya/MFnMesh.h>
 #include <maya/MFnSingleIndexedComponent.h>
@@ -42,12 +48,27 @@
 #include <maya/MItSelectionList.h>
 #include <maya/MMatrix.h>
 #include <maya/MMeshIntersector.h>
+#include <maya/MModelMessage.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPointArray.h>
+#include <maya/MSceneMessage.h>
 #include <maya/MSelectionList.h>
 #include <maya/MString.h>
+#include <maya/MStringArray.h>
 #include <maya/MToolsInfo.h>
 #include <maya/MUIDrawManager.h>
 
+#include "core/heatDistance.h"
+#include "core/meshTopology.h"
+#include "core/mirrorMap.h"
+#include "core/strokeCounters.h"
+#include "core/strokeStats.h"
+#include "core/topologyCache.h"
+#include "core/weightCache.h"
+#include "core/weightFunctions.h"
+#include "core/weightTransfer.h"
+
 // ---------------------------------------------------------------------
 // the tool
 // ---------------------------------------------------------------------
@@ -73,21 +94,26 @@ public:
 
     // setting the attributes
     void setAffectSelected(bool value);
+    void setBindPose(bool value);
     void setColor(MColor color);
     void setCurve(int value);
     void setDepth(int value);
     void setDepthStart(int value);
     void setDestinationInfluence(int value);
+    void setDistance(int value);
     void setDrawBrush(bool value);
     void setEnterToolCommand(MString value);
     void setExitToolCommand(MString value);
     void setKeepShellsTogether(bool value);
     void setLineWidth(int value);
     void setMessage(int value);
+    void setMirror(int value);
+    void setMirrorTolerance(double value);
     void setReplace(bool value);
     void setReverse(bool value);
     void setSize(double value);
     void setSourceInfluence(int value);
+    void setSourceInfluenceList(MString value);
     void setStrength(double value);
     void setTolerance(double value);
     void setUndersampling(int value);
@@ -106,21 +132,26 @@ public:
 private:
 
     bool affectSelectedVal;
+    bool bindPoseVal;
     MColor colorVal;
     int curveVal;
     int depthVal;
     int depthStartVal;
     int destinationInfluenceVal;
+    int distanceVal;
     bool drawBrushVal;
     MString enterToolCommandVal;
     MString exitToolCommandVal;
     bool keepShellsTogetherVal;
     int lineWidthVal;
     int messageVal;
+    int mirrorVal;
+    double mirrorToleranceVal;
     bool replaceVal;
     bool reverseVal;
     double sizeVal;
     int sourceInfluenceVal;
+    MString sourceInfluenceListVal;
     double strengthVal;
     double toleranceVal;
     int undersamplingVal;
@@ -149,6 +180,7 @@ class transferWeightsContext : public MPxContext
 public:
 
     transferWeightsContext();
+    ~transferWeightsContext();
     void toolOnSetup(MEvent &event);
     void toolOffCleanup();
 
@@ -175,10 +207,34 @@ public:
     void doReleaseCommon(MEvent event);
 
     MStatus getMesh();
+    void addDirtyCallbacks();
+    void removeDirtyCallbacks();
     MStatus getSelection(MDagPath &dagPath);
     MIntArray getSelectionVertices();
     MStatus getSkinCluster(MDagPath meshDag, MObject &skinClusterObj);
     MStatus getAllWeights();
+    bool getCachedWeights();
+    void writeWeightCache();
+    MString getWeightCachePath();
+    unsigned long long getSceneKey();
+    void readTopologyCache();
+    void writeTopologyCache();
+    MString getTopologyCachePath();
+    static void afterSaveCallback(void *data);
+    static void meshDirtyCallback(MObject &node, MPlug &plug, void *data);
+    static void skinAttributeCallback(MNodeMessage::AttributeMessage message,
+                                      MPlug &plug,
+                                      MPlug &otherPlug,
+                                      void *data);
+    static void lockAttributeCallback(MNodeMessage::AttributeMessage message,
+                                      MPlug &plug,
+                                      MPlug &otherPlug,
+                                      void *data);
+    static void connectionCallback(MPlug &sourcePlug,
+                                   MPlug &destinationPlug,
+                                   bool made,
+                                   void *data);
+    static void selectionCallback(void *data);
     void getSkinClusterAttributes(MObject skinCluster,
                                   unsigned int &normalize);
     MIntArray getInfluenceIndices(MObject skinCluster, MDagPathArray &dagPaths);
@@ -187,15 +243,25 @@ public:
     MStatus getCameraClip(double &nearClip, double &farClip, MMatrix &camMat);
 
     // transfer computation
-    void resetTransferValues();
+    typedef void (transferWeightsContext::*transferKernel)(unsigned int,
+                                                           double,
+                                                           int,
+                                                           unsigned int,
+                                                           int,
+                                                           std::vector<double> &);
+
     MStatus performTransfer(MEvent event, MIntArray indices, MFloatArray distances);
+    transferKernel getTransferKernel(bool sparse);
+    void getTransferInfluences(bool mirrored,
+                               std::vector<unsigned int> &sources,
+                               std::vector<unsigned int> &destinations);
+    template <bool VolumeMode, bool Normalize, bool Sparse>
     void computeTransfer(unsigned int index,
                          double falloff,
                          int oppositeIndex,
                          unsigned int element,
                          int oppositeElement,
-                         MIntArray volumeIndices,
-                         bool flood);
+                         std::vector<double> &values);
     // selection
     MStatus performSelect(MEvent event, MIntArray indices, MFloatArray distances);
     // flood
@@ -207,13 +273,29 @@ public:
                             int hitIndex,
                             MIntArray &indices,
                             MFloatArray &values);
-    void getConnectedInRange(MPoint centerPoint,
-                             int index,
-                             std::vector<bool> &visited,
-                             MIntArray &indices,
-                             MFloatArray &values,
-                             int &oppositeIndex);
-    void appendConnectedIndices(int index, MIntArray &indices);
+    void getVerticesInGeodesicRange(int index,
+                                    int hitIndex,
+                                    MIntArray &indices,
+                                    MFloatArray &values);
+    void getVerticesInHeatRange(int index,
+                                int hitIndex,
+                                MIntArray &indices,
+                                MFloatArray &values);
+    int getOppositeIndex(int index);
+    MStatus captureBindPose();
+    bool useBindPose();
+    MPoint getBindPoint(int faceIndex, int triangleIndex, float bary1, float bary2);
+    MPoint getVertexPosition(int index, MSpace::Space space);
+    MPoint getVertexPosition(MItMeshVertex &vtxIter, MSpace::Space space);
+    void updateMirror();
+    bool useMirror();
+    void appendMirrorIndices(MIntArray &indices, MFloatArray &values);
+    bool isMirrored(unsigned int index);
+    void getPointValues(std::vector<double> &values);
+    void getTriangleValues(std::vector<int> &values);
+    void getPolygonValues(std::vector<int> &counts, std::vector<int> &vertices);
+    void updateTopology();
+    void updateHeatDistance();
     MIntArray getVerticesInVolume();
 
     double getFalloffValue(double value, double strength);
@@ -228,6 +310,8 @@ public:
 
     // setting the attributes
     void setAffectSelected(bool value);
+    void setBindPose(bool value);
+    void setCacheDirectory(MString value);
     void setColorR(float value);
     void setColorG(float value);
     void setColorB(float value);
@@ -235,6 +319,7 @@ public:
     void setDepth(int value);
     void setDepthStart(int value);
     void setDestinationInfluence(int value);
+    void setDistance(int value);
     void setDrawBrush(bool value);
     void setEnterToolCommand(MString value);
     void setExitToolCommand(MString value);
@@ -242,36 +327,53 @@ public:
     void setKeepShellsTogether(bool value);
     void setLineWidth(int value);
     void setMessage(int value);
+    void setMirror(int value);
+    void setMirrorTolerance(double value);
     void setReplace(bool value);
     void setReverse(bool value);
     void setSize(double value);
     void setSourceInfluence(int value);
+    void setSourceInfluenceList(MString value);
     void setStrength(double value);
     void setTolerance(double value);
+    void setTrace(bool value);
+    void setTraceFile(MString value);
     void setUndersampling(int value);
     void setVolume(bool value);
 
+    void writeTrace(MString path);
+
     // getting the attributes
     bool getAffectSelected();
+    bool getBindPose();
+    MString getCacheDirectory();
     float getColorR();
     float getColorG();
     float getColorB();
+    MStringArray getCounters();
     int getCurve();
     int getDepth();
     int getDepthStart();
     int getDestinationInfluence();
+    int getDistance();
     bool getDrawBrush();
     MString getEnterToolCommand();
     MString getExitToolCommand();
     bool getKeepShellsTogether();
     int getLineWidth();
     int getMessage();
+    int getMirror();
+    double getMirrorTolerance();
     bool getReplace();
     bool getReverse();
     double getSize();
     int getSourceInfluence();
+    MString getSourceInfluenceList();
+    MStringArray getStats();
     double getStrength();
     double getTolerance();
+    bool getTrace();
+    MString getTraceFile();
     int getUndersampling();
     bool getVolume();
 
@@ -284,23 +386,30 @@ private:
 
     // the tool settings
     bool affectSelectedVal;
+    bool bindPoseVal;
+    MString cacheDirectoryVal;
     MColor colorVal;
     int curveVal;
     int depthVal;
     int depthStartVal;
     int destinationInfluenceVal;
+    int distanceVal;
     bool drawBrushVal;
     MString enterToolCommandVal;
     MString exitToolCommandVal;
     bool keepShellsTogetherVal;
     int lineWidthVal;
     int messageVal;
+    int mirrorVal;
+    double mirrorToleranceVal;
     bool replaceVal;
     bool reverseVal;
     double sizeVal;
     int sourceInfluenceVal;
+    MString sourceInfluenceListVal;
     double strengthVal;
     double toleranceVal;
+    MString traceFileVal;
     int undersamplingVal;
     bool volumeVal;
 
@@ -317,10 +426,6 @@ private:
                                 // strength.
 
     M3dView view;
-    unsigned int width;
-    unsigned int height;
-    short viewCenterX;
-    short viewCenterY;
 
     // the cursor position
     short screenX;
@@ -332,6 +437,8 @@ private:
                                 // camera.
     MPointArray surfacePoints;  // The cursor positions on the mesh in
                                 // world space.
+    MPointArray centerPoints;   // The cursor positions on the geometry
+                                // the distances are measured on.
     MVector worldVector;        // The view vector from the camera to
                                 // the surface point.
     double pressDistance;       // The closest distance to the mesh on
@@ -346,6 +453,26 @@ private:
                                 // is used for flooding.
 
     MMeshIntersector intersector;
+    MMeshIntersector bindIntersector;   // The intersector for the
+                                        // input geometry.
+    MPointArray bindPoints;     // The world space positions of the
+                                // skin cluster input geometry.
+
+    mirrorMap mirror;           // The mirrored vertex of each vertex.
+    std::vector<unsigned int> mirrorStamps; // The generation with
+                                            // which a vertex has
+                                            // been added to the
+                                            // current dab.
+    unsigned int mirrorGeneration;
+    std::vector<int> influenceMirror;   // The mirrored influence
+                                        // of each influence.
+
+    meshTopology topology;      // The cached vertex adjacency and edge
+                                // lengths for the geodesic distance.
+    heatDistance heat;          // The factorized operators for the heat
+                                // method distance.
+    bool heatFailed;            // True, if the operators for the heat
+                                // method couldn't be factorized.
 
     std::vector<bool> selectedIndices;  // The current vertex selection
                                         // in a non-sparse array
@@ -366,13 +493,18 @@ private:
     std::vector<bool> influenceLocks;
     bool normalize;
 
+    MIntArray sourceIndices;    // The source influences of the source
+                                // influence list.
+    weightTransfer transfer;    // The shared transfer kernel with the
+                                // influences of the current dab and
+                                // the accumulated transfer multipliers.
+
     MDoubleArray currentWeights;        // The array holding all weights.
                                         // Original and transferred
                                         // weights are included.
     MDoubleArray prevWeights;           // The previous weights for undo.
     MDoubleArray transferredWeights;    // The array with only the
                                         // transferred weights.
-    MDoubleArray transferValues;
 
     MSelectionList prevSelection;
     MSelectionList prevHilite;
@@ -382,6 +514,36 @@ private:
     std::vector<bool> computeIndex; // The array storing which index
                                     // should get processed in case of
                                     // boundary indices.
+    unsigned long long topologyHash;    // The connectivity hash of the
+                                        // mesh for the topology cache.
+    bool topologyCached;            // True, if the topology cache
+                                    // matches the adjacency and the
+                                    // index map.
+    unsigned int topologyPairCount; // The number of opposite vertex
+                                    // pairs in the topology cache.
+
+    strokeCounters counters;        // The work counts of the last
+                                    // stroke.
+    strokeStats stats;              // The timings of the brush stages.
+    strokeTrace trace;              // The optional timeline of the
+                                    // strokes.
+
+    MCallbackId saveCallbackId;     // The callback for writing the
+                                    // weight cache after saving.
+
+    // The cached data which needs to be refreshed on the next press.
+    // The dirty callbacks mark the data which has changed.
+    enum dirtyLayer
+    {
+        kDirtyInfluences = 1,
+        kDirtyLocks = 2,
+        kDirtyPoints = 4,
+        kDirtySelection = 8,
+        kDirtyWeights = 16,
+        kDirtyAll = 31
+    };
+    unsigned int dirtyLayers;
+    MCallbackIdArray dirtyCallbackIds;
 };
 
 // ---------------------------------------------------------------------